@@ -4,6 +4,7 @@
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <QAbstractItemView>
@@ -14,18 +15,22 @@
 #include <QDoubleSpinBox>
 #include <QFileDialog>
 #include <QFormLayout>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
+#include <QHeaderView>
 #include <QLabel>
+#include <QList>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QPlainTextEdit>
+#include <QProgressBar>
 #include <QPushButton>
 #include <QSpinBox>
 #include <QStatusBar>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
 #include <QTabWidget>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -40,32 +45,15 @@
 #include "backtest/csv_importer.hpp"
 #include "backtest/downsampling.hpp"
 #include "backtest/exporter.hpp"
+#include "backtest/progress.hpp"
+#include "backtest/stats.hpp"
 #include "backtest/time_utils.hpp"
+#include "trades_model.hpp"
 
 namespace {
 
 constexpr std::size_t kDisplayCap = 50000;
 
-class SortableNumericItem final : public QTableWidgetItem {
-public:
-    explicit SortableNumericItem(const QString& text) : QTableWidgetItem(text) {}
-
-    bool operator<(const QTableWidgetItem& other) const override {
-        const QVariant lhs = data(Qt::UserRole);
-        const QVariant rhs = other.data(Qt::UserRole);
-        if (lhs.isValid() && rhs.isValid()) {
-            bool lhs_ok = false;
-            bool rhs_ok = false;
-            const double lhs_val = lhs.toDouble(&lhs_ok);
-            const double rhs_val = rhs.toDouble(&rhs_ok);
-            if (lhs_ok && rhs_ok) {
-                return lhs_val < rhs_val;
-            }
-        }
-        return QTableWidgetItem::operator<(other);
-    }
-};
-
 QString issue_to_qstring(const stockbt::ImportIssue& issue) {
     if (issue.line == 0) {
         return QString::fromStdString(issue.message);
@@ -73,25 +61,30 @@ QString issue_to_qstring(const stockbt::ImportIssue& issue) {
     return QString("line %1: %2").arg(issue.line).arg(QString::fromStdString(issue.message));
 }
 
-std::vector<QPointF> display_points(const std::vector<stockbt::SeriesPoint>& src, int pixel_width) {
-    std::vector<QPointF> out;
-    if (src.empty()) {
+// Buckets of the visible range (the whole series when nothing is visible), two
+// points per bucket in time order.
+QList<QPointF> display_points(const stockbt::MinMaxPyramid& source, qreal min_x, qreal max_x, int pixel_width) {
+    QList<QPointF> out;
+    if (source.size() == 0) {
         return out;
     }
+    if (min_x > max_x) {
+        std::swap(min_x, max_x);
+    }
 
-    if (src.size() <= kDisplayCap) {
-        out.reserve(src.size());
-        for (const auto& p : src) {
-            out.emplace_back(static_cast<qreal>(p.ts) * 1000.0, p.value);
-        }
-        return out;
+    const int64_t min_ts = static_cast<int64_t>(std::floor(min_x / 1000.0));
+    const int64_t max_ts = static_cast<int64_t>(std::ceil(max_x / 1000.0));
+    const std::size_t width = static_cast<std::size_t>(std::max(1, pixel_width));
+    auto buckets = source.query(min_ts, max_ts, width, kDisplayCap);
+    if (buckets.empty()) {
+        buckets = source.query(source.ts(0), source.ts(source.size() - 1), width, kDisplayCap);
     }
 
-    const auto buckets =
-        stockbt::downsample_bucket_min_max(src, static_cast<std::size_t>(std::max(1, pixel_width)), kDisplayCap);
     out.reserve(buckets.size() * 2);
     for (const auto& bucket : buckets) {
-        if (bucket.min_ts <= bucket.max_ts) {
+        if (bucket.min_ts == bucket.max_ts) {
+            out.emplace_back(static_cast<qreal>(bucket.min_ts) * 1000.0, bucket.min_value);
+        } else if (bucket.min_ts < bucket.max_ts) {
             out.emplace_back(static_cast<qreal>(bucket.min_ts) * 1000.0, bucket.min_value);
             out.emplace_back(static_cast<qreal>(bucket.max_ts) * 1000.0, bucket.max_value);
         } else {
@@ -102,36 +95,14 @@ std::vector<QPointF> display_points(const std::vector<stockbt::SeriesPoint>& src
     return out;
 }
 
-std::vector<stockbt::SeriesPoint> points_in_visible_range(const std::vector<stockbt::SeriesPoint>& src,
-                                                          qreal min_x,
-                                                          qreal max_x) {
-    if (src.empty()) {
-        return {};
-    }
-    if (min_x > max_x) {
-        std::swap(min_x, max_x);
-    }
-
-    const int64_t min_ts = static_cast<int64_t>(std::floor(min_x / 1000.0));
-    const int64_t max_ts = static_cast<int64_t>(std::ceil(max_x / 1000.0));
-
-    const auto begin = std::lower_bound(src.begin(), src.end(), min_ts, [](const stockbt::SeriesPoint& point, int64_t ts) {
-        return point.ts < ts;
-    });
-    const auto end = std::upper_bound(src.begin(), src.end(), max_ts, [](int64_t ts, const stockbt::SeriesPoint& point) {
-        return ts < point.ts;
-    });
-    return std::vector<stockbt::SeriesPoint>(begin, end);
-}
-
-void set_x_axis_full_range(QDateTimeAxis* axis_x, const std::vector<stockbt::SeriesPoint>& src) {
-    if (src.empty()) {
+void set_x_axis_full_range(QDateTimeAxis* axis_x, const stockbt::MinMaxPyramid& src) {
+    if (src.size() == 0) {
         const QDateTime now = QDateTime::currentDateTimeUtc();
         axis_x->setRange(now, now.addSecs(1));
         return;
     }
-    const QDateTime min_dt = QDateTime::fromSecsSinceEpoch(src.front().ts, Qt::UTC);
-    const QDateTime max_dt = QDateTime::fromSecsSinceEpoch(src.back().ts, Qt::UTC);
+    const QDateTime min_dt = QDateTime::fromSecsSinceEpoch(src.ts(0), Qt::UTC);
+    const QDateTime max_dt = QDateTime::fromSecsSinceEpoch(src.ts(src.size() - 1), Qt::UTC);
     if (min_dt == max_dt) {
         axis_x->setRange(min_dt.addSecs(-1), max_dt.addSecs(1));
     } else {
@@ -139,7 +110,7 @@ void set_x_axis_full_range(QDateTimeAxis* axis_x, const std::vector<stockbt::Ser
     }
 }
 
-void update_y_axis(QValueAxis* axis_y, const std::vector<QPointF>& points) {
+void update_y_axis(QValueAxis* axis_y, const QList<QPointF>& points) {
     if (points.empty()) {
         axis_y->setRange(0.0, 1.0);
         return;
@@ -162,21 +133,53 @@ void update_y_axis(QValueAxis* axis_y, const std::vector<QPointF>& points) {
     axis_y->setRange(min_v - pad, max_v + pad);
 }
 
-void refresh_line_series(QLineSeries* line,
+// Keeps line in sync with the visible x range of its chart. Range and plot-area
+// changes within one event-loop pass coalesce into a single rebuild; downsampling
+// runs on the thread pool and the result replaces the series in one call. At most
+// one rebuild is in flight, and a change during it schedules one more.
+void attach_line_refresh(QChart* chart,
+                         QLineSeries* line,
+                         QDateTimeAxis* axis_x,
                          QValueAxis* axis_y,
-                         const std::vector<stockbt::SeriesPoint>& source,
-                         qreal min_x,
-                         qreal max_x,
-                         int pixel_width) {
-    const auto visible = points_in_visible_range(source, min_x, max_x);
-    const auto& to_plot = visible.empty() ? source : visible;
-    const auto points = display_points(to_plot, pixel_width);
-
-    line->clear();
-    for (const QPointF& point : points) {
-        line->append(point);
-    }
-    update_y_axis(axis_y, points);
+                         std::shared_ptr<const stockbt::MinMaxPyramid> source) {
+    struct State {
+        bool running{false};
+        bool dirty{false};
+    };
+    const auto state = std::make_shared<State>();
+    auto* timer = new QTimer(chart);
+    timer->setSingleShot(true);
+    timer->setInterval(0);
+    auto* watcher = new QFutureWatcher<QList<QPointF>>(chart);
+
+    QObject::connect(timer, &QTimer::timeout, chart, [chart, axis_x, source, state, watcher]() {
+        if (state->running) {
+            state->dirty = true;
+            return;
+        }
+        state->running = true;
+        const qreal min_x = static_cast<qreal>(axis_x->min().toMSecsSinceEpoch());
+        const qreal max_x = static_cast<qreal>(axis_x->max().toMSecsSinceEpoch());
+        const int width = std::max(1, static_cast<int>(chart->plotArea().width()));
+        watcher->setFuture(QtConcurrent::run(
+            [source, min_x, max_x, width]() { return display_points(*source, min_x, max_x, width); }));
+    });
+    QObject::connect(watcher, &QFutureWatcherBase::finished, chart, [line, axis_y, state, timer, watcher]() {
+        state->running = false;
+        const QList<QPointF> points = watcher->future().takeResult();
+        line->replace(points);
+        update_y_axis(axis_y, points);
+        if (state->dirty) {
+            state->dirty = false;
+            timer->start();
+        }
+    });
+
+    QObject::connect(axis_x, &QDateTimeAxis::rangeChanged, timer, [timer](const QDateTime&, const QDateTime&) {
+        timer->start();
+    });
+    QObject::connect(chart, &QChart::plotAreaChanged, timer, [timer](const QRectF&) { timer->start(); });
+    timer->start();
 }
 
 QString format_ts(int64_t ts) {
@@ -190,14 +193,34 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     setup_actions();
 
     connect(&import_watcher_, &QFutureWatcher<stockbt::ImportResult>::finished, this, [this]() {
-        const stockbt::ImportResult result = import_watcher_.result();
-        render_import_result(result);
+        stockbt::ImportResult result = import_watcher_.future().takeResult();
+        untrack_progress(import_token_.get());
+        if (import_token_ && import_token_->cancelled()) {
+            dataset_summary_label_->setText("No dataset loaded");
+            statusBar()->showMessage("Import cancelled", 5000);
+            return;
+        }
+        render_import_result(std::move(result));
     });
 
-    connect(&backtest_watcher_, &QFutureWatcher<stockbt::BacktestResult>::finished, this, [this]() {
-        last_backtest_ = backtest_watcher_.result();
-        render_backtest_result();
+    connect(&backtest_watcher_, &QFutureWatcher<std::shared_ptr<stockbt::BacktestWorkspace>>::finished, this, [this]() {
+        std::shared_ptr<stockbt::BacktestWorkspace> workspace = backtest_watcher_.future().takeResult();
+        untrack_progress(backtest_token_.get());
         run_action_->setEnabled(!candles_.empty());
+        // Also covers a run that finished just before an import replaced its dataset.
+        if (backtest_token_ && backtest_token_->cancelled()) {
+            idle_workspace_ = std::move(workspace);
+            export_action_->setEnabled(!last_backtest_.equity.empty() && !candles_.empty());
+            statusBar()->showMessage("Backtest cancelled", 5000);
+            return;
+        }
+        std::swap(last_backtest_, workspace->result);
+        idle_workspace_ = std::move(workspace);
+        const std::string stats = stockbt::format_backtest_stats(last_backtest_.stats);
+        if (!stats.empty()) {
+            append_log_line(QString::fromStdString(stats));
+        }
+        render_backtest_result();
         export_action_->setEnabled(!last_backtest_.equity.empty());
         statusBar()->showMessage("Done", 3000);
     });
@@ -271,41 +294,45 @@ void MainWindow::setup_ui() {
     controls_dock->setWidget(controls);
     addDockWidget(Qt::LeftDockWidgetArea, controls_dock);
 
-    auto* central_tabs = new QTabWidget(this);
+    central_tabs_ = new QTabWidget(this);
 
-    auto* chart_tabs = new QTabWidget(central_tabs);
-    price_chart_view_ = new QChartView(chart_tabs);
-    equity_chart_view_ = new QChartView(chart_tabs);
-    drawdown_chart_view_ = new QChartView(chart_tabs);
+    chart_tabs_ = new QTabWidget(central_tabs_);
+    price_chart_view_ = new QChartView(chart_tabs_);
+    equity_chart_view_ = new QChartView(chart_tabs_);
+    drawdown_chart_view_ = new QChartView(chart_tabs_);
 
-    chart_tabs->addTab(price_chart_view_, "Price");
-    chart_tabs->addTab(equity_chart_view_, "Equity");
-    chart_tabs->addTab(drawdown_chart_view_, "Drawdown");
+    chart_tabs_->addTab(price_chart_view_, "Price");
+    chart_tabs_->addTab(equity_chart_view_, "Equity");
+    chart_tabs_->addTab(drawdown_chart_view_, "Drawdown");
 
-    trades_table_ = new QTableWidget(central_tabs);
-    trades_table_->setColumnCount(7);
-    trades_table_->setHorizontalHeaderLabels(
-        {"Entry Time", "Entry Price", "Exit Time", "Exit Price", "Qty", "PnL", "Return %"});
+    // The model formats only the rows the view paints, so large trade lists stay cheap.
+    trades_model_ = new TradesModel(this);
+    trades_table_ = new QTableView(central_tabs_);
+    trades_table_->setModel(trades_model_);
     trades_table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
     trades_table_->setSelectionBehavior(QAbstractItemView::SelectRows);
     trades_table_->setAlternatingRowColors(true);
     trades_table_->setSortingEnabled(true);
+    trades_table_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    trades_table_->horizontalHeader()->setResizeContentsPrecision(200);
 
     price_chart_view_->setRubberBand(QChartView::RectangleRubberBand);
     equity_chart_view_->setRubberBand(QChartView::RectangleRubberBand);
     drawdown_chart_view_->setRubberBand(QChartView::RectangleRubberBand);
 
-    auto* export_tab = new QWidget(central_tabs);
+    auto* export_tab = new QWidget(central_tabs_);
     auto* export_layout = new QVBoxLayout(export_tab);
     auto* export_text = new QLabel("Use File > Export to write equity.csv, trades.csv, and metrics.json.", export_tab);
     export_text->setWordWrap(true);
     export_layout->addWidget(export_text);
     export_layout->addStretch(1);
 
-    central_tabs->addTab(chart_tabs, "Charts");
-    central_tabs->addTab(trades_table_, "Trades");
-    central_tabs->addTab(export_tab, "Export");
-    setCentralWidget(central_tabs);
+    central_tabs_->addTab(chart_tabs_, "Charts");
+    central_tabs_->addTab(trades_table_, "Trades");
+    central_tabs_->addTab(export_tab, "Export");
+    setCentralWidget(central_tabs_);
+    connect(central_tabs_, &QTabWidget::currentChanged, this, [this](int) { render_visible_chart(); });
+    connect(chart_tabs_, &QTabWidget::currentChanged, this, [this](int) { render_visible_chart(); });
 
     import_log_ = new QPlainTextEdit(this);
     import_log_->setReadOnly(true);
@@ -313,6 +340,21 @@ void MainWindow::setup_ui() {
     log_dock->setWidget(import_log_);
     addDockWidget(Qt::BottomDockWidgetArea, log_dock);
 
+    progress_bar_ = new QProgressBar(this);
+    progress_bar_->setRange(0, 1000);
+    progress_bar_->setMaximumWidth(200);
+    progress_bar_->setVisible(false);
+    statusBar()->addPermanentWidget(progress_bar_);
+
+    // Workers only publish a fraction; polling it keeps them free of Qt calls.
+    progress_timer_ = new QTimer(this);
+    progress_timer_->setInterval(100);
+    connect(progress_timer_, &QTimer::timeout, this, [this]() {
+        if (shown_token_) {
+            progress_bar_->setValue(static_cast<int>(shown_token_->progress() * 1000.0));
+        }
+    });
+
     statusBar()->showMessage("Ready");
 }
 
@@ -324,6 +366,7 @@ void MainWindow::setup_actions() {
     open_action_ = file_menu->addAction("Open CSV");
     export_action_ = file_menu->addAction("Export");
     run_action_ = run_menu->addAction("Run Backtest");
+    cancel_action_ = run_menu->addAction("Cancel");
     help_menu->addAction("About", this, [this]() {
         QMessageBox::information(this,
                                  "About",
@@ -332,10 +375,12 @@ void MainWindow::setup_actions() {
 
     run_action_->setEnabled(false);
     export_action_->setEnabled(false);
+    cancel_action_->setEnabled(false);
 
     connect(open_action_, &QAction::triggered, this, &MainWindow::on_open_csv);
     connect(run_action_, &QAction::triggered, this, &MainWindow::on_run_backtest);
     connect(export_action_, &QAction::triggered, this, &MainWindow::on_export_results);
+    connect(cancel_action_, &QAction::triggered, this, &MainWindow::on_cancel);
 }
 
 stockbt::DateFormat MainWindow::selected_date_format() const {
@@ -370,15 +415,59 @@ void MainWindow::append_log_line(const QString& line) {
     import_log_->appendPlainText(line);
 }
 
+void MainWindow::track_progress(std::shared_ptr<stockbt::ProgressToken> token) {
+    shown_token_ = std::move(token);
+    progress_bar_->setValue(0);
+    progress_bar_->setVisible(true);
+    progress_timer_->start();
+    cancel_action_->setEnabled(true);
+}
+
+void MainWindow::untrack_progress(const stockbt::ProgressToken* token) {
+    if (shown_token_.get() != token) {
+        return;
+    }
+    shown_token_.reset();
+    progress_timer_->stop();
+    progress_bar_->setVisible(false);
+    cancel_action_->setEnabled(false);
+}
+
+void MainWindow::on_cancel() {
+    for (const auto& token : {import_token_, backtest_token_}) {
+        if (token) {
+            token->cancel();
+        }
+    }
+    statusBar()->showMessage("Cancelling...");
+}
+
 void MainWindow::on_open_csv() {
-    const QString file = QFileDialog::getOpenFileName(this, "Open OHLCV CSV", QString(), "CSV Files (*.csv)");
+    const QString file = QFileDialog::getOpenFileName(
+        this, "Open OHLCV CSV", QString(), "CSV Files (*.csv);;Binary datasets (*.sbt)");
     if (file.isEmpty()) {
         return;
     }
 
+    // The running import is superseded, and a running backtest would render against
+    // the dataset being replaced.
+    if (import_token_) {
+        import_token_->cancel();
+    }
+    if (backtest_token_) {
+        backtest_token_->cancel();
+    }
+    untrack_progress(shown_token_.get());
+
     loaded_csv_path_ = file;
-    candles_.clear();
+    dataset_.reset();
+    candles_ = stockbt::CandleView();
     last_backtest_ = stockbt::BacktestResult{};
+    trades_model_->set_trades(nullptr);
+    bar_timestamps_.reset();
+    price_chart_stale_ = false;
+    equity_chart_stale_ = false;
+    drawdown_chart_stale_ = false;
     run_action_->setEnabled(false);
     export_action_->setEnabled(false);
     dataset_summary_label_->setText("Importing...");
@@ -388,16 +477,28 @@ void MainWindow::on_open_csv() {
 
     const std::string path = file.toStdString();
     const stockbt::DateFormat fmt = selected_date_format();
-    import_watcher_.setFuture(QtConcurrent::run([path, fmt]() { return stockbt::import_ohlcv_csv(path, fmt); }));
+    stockbt::ImportOptions options;
+    options.threads = 0;
+    options.binary_cache = true;
+    import_token_ = std::make_shared<stockbt::ProgressToken>();
+    options.progress = import_token_.get();
+    track_progress(import_token_);
+    const std::shared_ptr<stockbt::ProgressToken> token = import_token_;
+    import_watcher_.setFuture(QtConcurrent::run(
+        [path, fmt, options, token]() { return stockbt::import_ohlcv_csv(path, fmt, options); }));
 }
 
-void MainWindow::render_import_result(const stockbt::ImportResult& result) {
+void MainWindow::render_import_result(stockbt::ImportResult result) {
     for (const auto& warning : result.warnings) {
         append_log_line(issue_to_qstring(warning));
     }
     for (const auto& error : result.errors) {
         append_log_line(issue_to_qstring(error));
     }
+    const std::string stats = stockbt::format_import_stats(result.stats);
+    if (!stats.empty()) {
+        append_log_line(QString::fromStdString(stats));
+    }
 
     if (!result.success) {
         QStringList lines;
@@ -413,7 +514,8 @@ void MainWindow::render_import_result(const stockbt::ImportResult& result) {
         return;
     }
 
-    candles_ = result.candles;
+    dataset_ = std::make_shared<const stockbt::Series>(std::move(result.candles));
+    candles_ = stockbt::CandleView(*dataset_);
     QString summary = QString("Rows: %1\nStart: %2\nEnd: %3")
                           .arg(candles_.size())
                           .arg(format_ts(candles_.front().ts))
@@ -441,26 +543,73 @@ void MainWindow::on_run_backtest() {
         return;
     }
 
-    run_action_->setEnabled(false);
+    // Run stays enabled: a new run cancels the current one instead of queueing behind it.
+    if (backtest_token_) {
+        backtest_token_->cancel();
+    }
     export_action_->setEnabled(false);
     statusBar()->showMessage("Running backtest...");
 
-    const stockbt::Series local_series = candles_;
+    const std::shared_ptr<const stockbt::Series> dataset = dataset_;
     const stockbt::BacktestSettings settings = current_settings();
+    backtest_token_ = std::make_shared<stockbt::ProgressToken>();
+    track_progress(backtest_token_);
+    const std::shared_ptr<stockbt::ProgressToken> token = backtest_token_;
+
+    // A cancelled run still in flight keeps its own workspace; this one then gets a new one.
+    std::shared_ptr<stockbt::BacktestWorkspace> workspace = std::move(idle_workspace_);
+    if (!workspace) {
+        workspace = std::make_shared<stockbt::BacktestWorkspace>();
+    }
+    backtest_watcher_.setFuture(QtConcurrent::run([dataset, params, settings, token, workspace]() {
+        stockbt::BacktestContext context;
+        context.progress = token.get();
+        stockbt::run_sma_backtest(*dataset, params, settings, context, workspace.get());
+        return workspace;
+    }));
+}
 
-    backtest_watcher_.setFuture(
-        QtConcurrent::run([local_series, params, settings]() { return stockbt::run_sma_backtest(local_series, params, settings); }));
+const std::shared_ptr<const std::vector<int64_t>>& MainWindow::bar_timestamps() {
+    if (!bar_timestamps_) {
+        auto ts = std::make_shared<std::vector<int64_t>>();
+        ts->reserve(candles_.size());
+        for (const auto& c : candles_) {
+            ts->push_back(c.ts);
+        }
+        bar_timestamps_ = std::move(ts);
+    }
+    return bar_timestamps_;
+}
+
+// Builds the chart of the visible tab if the last result has not been drawn into it yet;
+// tabs that are never opened never derive their series.
+void MainWindow::render_visible_chart() {
+    if (central_tabs_->currentWidget() != chart_tabs_) {
+        return;
+    }
+    QWidget* current = chart_tabs_->currentWidget();
+    if (current == price_chart_view_ && price_chart_stale_) {
+        price_chart_stale_ = false;
+        render_price_chart();
+    } else if (current == equity_chart_view_ && equity_chart_stale_) {
+        equity_chart_stale_ = false;
+        render_equity_chart();
+    } else if (current == drawdown_chart_view_ && drawdown_chart_stale_) {
+        drawdown_chart_stale_ = false;
+        render_drawdown_chart();
+    }
 }
 
 void MainWindow::render_price_chart() {
     auto* chart = new QChart();
     chart->setTitle("Price (Close) + Buy/Sell markers");
 
-    std::vector<stockbt::SeriesPoint> src;
-    src.reserve(candles_.size());
+    std::vector<double> closes;
+    closes.reserve(candles_.size());
     for (const auto& c : candles_) {
-        src.push_back({c.ts, c.c});
+        closes.push_back(c.c);
     }
+    const auto src = std::make_shared<const stockbt::MinMaxPyramid>(bar_timestamps(), std::move(closes));
 
     auto* line = new QLineSeries(chart);
     line->setName("Close");
@@ -495,16 +644,8 @@ void MainWindow::render_price_chart() {
     sells->attachAxis(axis_x);
     sells->attachAxis(axis_y);
 
-    set_x_axis_full_range(axis_x, src);
-    const auto source = std::make_shared<std::vector<stockbt::SeriesPoint>>(std::move(src));
-    auto refresh = [this, line, axis_x, axis_y, source]() {
-        const int width = std::max(1, static_cast<int>(price_chart_view_->chart()->plotArea().width()));
-        refresh_line_series(
-            line, axis_y, *source, axis_x->min().toMSecsSinceEpoch(), axis_x->max().toMSecsSinceEpoch(), width);
-    };
-    connect(axis_x, &QDateTimeAxis::rangeChanged, this, [refresh](const QDateTime&, const QDateTime&) { refresh(); });
-    connect(chart, &QChart::plotAreaChanged, this, [refresh](const QRectF&) { refresh(); });
-    refresh();
+    set_x_axis_full_range(axis_x, *src);
+    attach_line_refresh(chart, line, axis_x, axis_y, src);
 
     price_chart_view_->setChart(chart);
 }
@@ -513,12 +654,10 @@ void MainWindow::render_equity_chart() {
     auto* chart = new QChart();
     chart->setTitle("Equity Curve");
 
-    std::vector<stockbt::SeriesPoint> src;
     const std::size_t count = std::min(candles_.size(), last_backtest_.equity.size());
-    src.reserve(count);
-    for (std::size_t i = 0; i < count; ++i) {
-        src.push_back({candles_[i].ts, last_backtest_.equity[i]});
-    }
+    const auto src = std::make_shared<const stockbt::MinMaxPyramid>(
+        bar_timestamps(),
+        std::vector<double>(last_backtest_.equity.begin(), last_backtest_.equity.begin() + count));
 
     auto* line = new QLineSeries(chart);
     chart->addSeries(line);
@@ -531,16 +670,8 @@ void MainWindow::render_equity_chart() {
     line->attachAxis(axis_x);
     line->attachAxis(axis_y);
 
-    set_x_axis_full_range(axis_x, src);
-    const auto source = std::make_shared<std::vector<stockbt::SeriesPoint>>(std::move(src));
-    auto refresh = [this, line, axis_x, axis_y, source]() {
-        const int width = std::max(1, static_cast<int>(equity_chart_view_->chart()->plotArea().width()));
-        refresh_line_series(
-            line, axis_y, *source, axis_x->min().toMSecsSinceEpoch(), axis_x->max().toMSecsSinceEpoch(), width);
-    };
-    connect(axis_x, &QDateTimeAxis::rangeChanged, this, [refresh](const QDateTime&, const QDateTime&) { refresh(); });
-    connect(chart, &QChart::plotAreaChanged, this, [refresh](const QRectF&) { refresh(); });
-    refresh();
+    set_x_axis_full_range(axis_x, *src);
+    attach_line_refresh(chart, line, axis_x, axis_y, src);
 
     equity_chart_view_->setChart(chart);
 }
@@ -549,12 +680,13 @@ void MainWindow::render_drawdown_chart() {
     auto* chart = new QChart();
     chart->setTitle("Drawdown (%)");
 
-    std::vector<stockbt::SeriesPoint> src;
     const std::size_t count = std::min(candles_.size(), last_backtest_.drawdown.size());
-    src.reserve(count);
+    std::vector<double> drawdown_pct;
+    drawdown_pct.reserve(count);
     for (std::size_t i = 0; i < count; ++i) {
-        src.push_back({candles_[i].ts, last_backtest_.drawdown[i] * 100.0});
+        drawdown_pct.push_back(last_backtest_.drawdown[i] * 100.0);
     }
+    const auto src = std::make_shared<const stockbt::MinMaxPyramid>(bar_timestamps(), std::move(drawdown_pct));
 
     auto* line = new QLineSeries(chart);
     chart->addSeries(line);
@@ -567,71 +699,12 @@ void MainWindow::render_drawdown_chart() {
     line->attachAxis(axis_x);
     line->attachAxis(axis_y);
 
-    set_x_axis_full_range(axis_x, src);
-    const auto source = std::make_shared<std::vector<stockbt::SeriesPoint>>(std::move(src));
-    auto refresh = [this, line, axis_x, axis_y, source]() {
-        const int width = std::max(1, static_cast<int>(drawdown_chart_view_->chart()->plotArea().width()));
-        refresh_line_series(
-            line, axis_y, *source, axis_x->min().toMSecsSinceEpoch(), axis_x->max().toMSecsSinceEpoch(), width);
-    };
-    connect(axis_x, &QDateTimeAxis::rangeChanged, this, [refresh](const QDateTime&, const QDateTime&) { refresh(); });
-    connect(chart, &QChart::plotAreaChanged, this, [refresh](const QRectF&) { refresh(); });
-    refresh();
+    set_x_axis_full_range(axis_x, *src);
+    attach_line_refresh(chart, line, axis_x, axis_y, src);
 
     drawdown_chart_view_->setChart(chart);
 }
 
-void MainWindow::render_trades_table() {
-    trades_table_->setSortingEnabled(false);
-    if (last_backtest_.trades.empty()) {
-        trades_table_->setRowCount(1);
-        auto* msg = new QTableWidgetItem("No trades generated for current data/parameters.");
-        trades_table_->setItem(0, 0, msg);
-        for (int c = 1; c < trades_table_->columnCount(); ++c) {
-            trades_table_->setItem(0, c, new QTableWidgetItem(""));
-        }
-        trades_table_->resizeColumnsToContents();
-        trades_table_->setSortingEnabled(true);
-        return;
-    }
-
-    trades_table_->setRowCount(static_cast<int>(last_backtest_.trades.size()));
-    int row = 0;
-    for (const auto& t : last_backtest_.trades) {
-        auto* entry_time = new SortableNumericItem(format_ts(t.entry_time));
-        entry_time->setData(Qt::UserRole, static_cast<qlonglong>(t.entry_time));
-        trades_table_->setItem(row, 0, entry_time);
-
-        auto* entry_price = new SortableNumericItem(QString::number(t.entry_price, 'f', 6));
-        entry_price->setData(Qt::UserRole, t.entry_price);
-        trades_table_->setItem(row, 1, entry_price);
-
-        auto* exit_time = new SortableNumericItem(format_ts(t.exit_time));
-        exit_time->setData(Qt::UserRole, static_cast<qlonglong>(t.exit_time));
-        trades_table_->setItem(row, 2, exit_time);
-
-        auto* exit_price = new SortableNumericItem(QString::number(t.exit_price, 'f', 6));
-        exit_price->setData(Qt::UserRole, t.exit_price);
-        trades_table_->setItem(row, 3, exit_price);
-
-        auto* qty = new SortableNumericItem(QString::number(t.qty));
-        qty->setData(Qt::UserRole, t.qty);
-        trades_table_->setItem(row, 4, qty);
-
-        auto* pnl = new SortableNumericItem(QString::number(t.pnl, 'f', 6));
-        pnl->setData(Qt::UserRole, t.pnl);
-        trades_table_->setItem(row, 5, pnl);
-
-        auto* ret = new SortableNumericItem(QString::number(t.return_pct * 100.0, 'f', 4));
-        ret->setData(Qt::UserRole, t.return_pct * 100.0);
-        trades_table_->setItem(row, 6, ret);
-
-        ++row;
-    }
-    trades_table_->resizeColumnsToContents();
-    trades_table_->setSortingEnabled(true);
-}
-
 void MainWindow::render_backtest_result() {
     for (const auto& warning : last_backtest_.warnings) {
         append_log_line(QString::fromStdString(warning));
@@ -654,10 +727,12 @@ void MainWindow::render_backtest_result() {
         }
     }
 
-    render_price_chart();
-    render_equity_chart();
-    render_drawdown_chart();
-    render_trades_table();
+    price_chart_stale_ = true;
+    equity_chart_stale_ = true;
+    drawdown_chart_stale_ = true;
+    render_visible_chart();
+    trades_model_->set_trades(&last_backtest_.trades);
+    trades_table_->resizeColumnsToContents();
 
     QString summary = dataset_summary_label_->text();
     summary += QString("\nTrades: %1 | Return: %2% | MaxDD: %3%")
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include <QFutureWatcher>
 #include <QMainWindow>
 
@@ -13,12 +17,21 @@ class QComboBox;
 class QDoubleSpinBox;
 class QLabel;
 class QPlainTextEdit;
+class QProgressBar;
 class QPushButton;
 class QSpinBox;
-class QTableWidget;
+class QTableView;
 class QTabWidget;
+class QTimer;
 QT_END_NAMESPACE
 
+namespace stockbt {
+class ProgressToken;
+struct BacktestWorkspace;
+}
+
+class TradesModel;
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -29,6 +42,7 @@ private slots:
     void on_open_csv();
     void on_run_backtest();
     void on_export_results();
+    void on_cancel();
 
 private:
     void setup_ui();
@@ -39,16 +53,20 @@ private:
     stockbt::BacktestSettings current_settings() const;
 
     void append_log_line(const QString& line);
-    void render_import_result(const stockbt::ImportResult& result);
+    void track_progress(std::shared_ptr<stockbt::ProgressToken> token);
+    void untrack_progress(const stockbt::ProgressToken* token);
+    void render_import_result(stockbt::ImportResult result);
     void render_backtest_result();
+    void render_visible_chart();
     void render_price_chart();
     void render_equity_chart();
     void render_drawdown_chart();
-    void render_trades_table();
+    const std::shared_ptr<const std::vector<int64_t>>& bar_timestamps();
 
     QAction* open_action_{nullptr};
     QAction* run_action_{nullptr};
     QAction* export_action_{nullptr};
+    QAction* cancel_action_{nullptr};
 
     QComboBox* date_format_combo_{nullptr};
     QSpinBox* fast_window_spin_{nullptr};
@@ -64,12 +82,33 @@ private:
     QChartView* price_chart_view_{nullptr};
     QChartView* equity_chart_view_{nullptr};
     QChartView* drawdown_chart_view_{nullptr};
-    QTableWidget* trades_table_{nullptr};
+    QTabWidget* central_tabs_{nullptr};
+    QTabWidget* chart_tabs_{nullptr};
+    QTableView* trades_table_{nullptr};
+    TradesModel* trades_model_{nullptr};
+    QProgressBar* progress_bar_{nullptr};
+    QTimer* progress_timer_{nullptr};
 
     QString loaded_csv_path_;
-    stockbt::Series candles_;
+    // candles_ views dataset_; background jobs hold their own reference to dataset_
+    // so a new import cannot free candles a running backtest is still reading.
+    std::shared_ptr<const stockbt::Series> dataset_;
+    stockbt::CandleView candles_;
     stockbt::BacktestResult last_backtest_;
+    // Charts are derived from last_backtest_ when their tab is first shown; the price,
+    // equity and drawdown indexes share the timestamps of candles_.
+    std::shared_ptr<const std::vector<int64_t>> bar_timestamps_;
+    bool price_chart_stale_{false};
+    bool equity_chart_stale_{false};
+    bool drawdown_chart_stale_{false};
 
     QFutureWatcher<stockbt::ImportResult> import_watcher_;
-    QFutureWatcher<stockbt::BacktestResult> backtest_watcher_;
+    // A run fills its workspace and the finished handler swaps the result into
+    // last_backtest_, so the next run recycles the buffers of the result it replaces.
+    QFutureWatcher<std::shared_ptr<stockbt::BacktestWorkspace>> backtest_watcher_;
+    std::shared_ptr<stockbt::BacktestWorkspace> idle_workspace_; // null while a run holds it
+    // A new job cancels the one it replaces; the watcher then only reports the new one.
+    std::shared_ptr<stockbt::ProgressToken> import_token_;
+    std::shared_ptr<stockbt::ProgressToken> backtest_token_;
+    std::shared_ptr<stockbt::ProgressToken> shown_token_; // job behind progress_bar_
 };
@@ -0,0 +1,134 @@
+#include "trades_model.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "backtest/time_utils.hpp"
+
+namespace {
+
+constexpr int kColumnCount = 7;
+
+double sort_key(const stockbt::Trade& t, int column) {
+    switch (column) {
+    case 0:
+        return static_cast<double>(t.entry_time);
+    case 1:
+        return t.entry_price;
+    case 2:
+        return static_cast<double>(t.exit_time);
+    case 3:
+        return t.exit_price;
+    case 4:
+        return static_cast<double>(t.qty);
+    case 5:
+        return t.pnl;
+    default:
+        return t.return_pct;
+    }
+}
+
+QString format_cell(const stockbt::Trade& t, int column) {
+    switch (column) {
+    case 0:
+        return QString::fromStdString(stockbt::format_timestamp_utc_iso8601(t.entry_time));
+    case 1:
+        return QString::number(t.entry_price, 'f', 6);
+    case 2:
+        return QString::fromStdString(stockbt::format_timestamp_utc_iso8601(t.exit_time));
+    case 3:
+        return QString::number(t.exit_price, 'f', 6);
+    case 4:
+        return QString::number(t.qty);
+    case 5:
+        return QString::number(t.pnl, 'f', 6);
+    default:
+        return QString::number(t.return_pct * 100.0, 'f', 4);
+    }
+}
+
+} // namespace
+
+TradesModel::TradesModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+void TradesModel::set_trades(const std::vector<stockbt::Trade>* trades) {
+    beginResetModel();
+    trades_ = trades;
+    order_.resize(trades_ ? trades_->size() : 0);
+    std::iota(order_.begin(), order_.end(), std::size_t{0});
+    endResetModel();
+    if (sort_column_ >= 0) {
+        sort(sort_column_, sort_order_);
+    }
+}
+
+int TradesModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid() || !trades_) {
+        return 0;
+    }
+    return trades_->empty() ? 1 : static_cast<int>(trades_->size());
+}
+
+int TradesModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : kColumnCount;
+}
+
+QVariant TradesModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || !trades_ || role != Qt::DisplayRole) {
+        return {};
+    }
+    if (trades_->empty()) {
+        return index.column() == 0 ? QVariant("No trades generated for current data/parameters.") : QVariant();
+    }
+    return format_cell((*trades_)[order_[static_cast<std::size_t>(index.row())]], index.column());
+}
+
+QVariant TradesModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole) {
+        return {};
+    }
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+    static const char* const kHeaders[kColumnCount] = {
+        "Entry Time", "Entry Price", "Exit Time", "Exit Price", "Qty", "PnL", "Return %"};
+    return (section >= 0 && section < kColumnCount) ? QVariant(kHeaders[section]) : QVariant();
+}
+
+void TradesModel::sort(int column, Qt::SortOrder order) {
+    sort_column_ = column;
+    sort_order_ = order;
+    if (!trades_ || trades_->size() < 2 || column < 0 || column >= kColumnCount) {
+        return;
+    }
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList before = persistentIndexList();
+    std::vector<std::size_t> tracked;
+    tracked.reserve(static_cast<std::size_t>(before.size()));
+    for (const QModelIndex& index : before) {
+        tracked.push_back(order_[static_cast<std::size_t>(index.row())]);
+    }
+
+    // Ties keep trade order in both directions.
+    const std::vector<stockbt::Trade>& trades = *trades_;
+    std::stable_sort(order_.begin(), order_.end(), [&](std::size_t a, std::size_t b) {
+        const double lhs = sort_key(trades[a], column);
+        const double rhs = sort_key(trades[b], column);
+        return (order == Qt::AscendingOrder) ? lhs < rhs : rhs < lhs;
+    });
+
+    if (!before.isEmpty()) {
+        std::vector<int> row_of(order_.size());
+        for (std::size_t row = 0; row < order_.size(); ++row) {
+            row_of[order_[row]] = static_cast<int>(row);
+        }
+        QModelIndexList after;
+        after.reserve(before.size());
+        for (qsizetype i = 0; i < before.size(); ++i) {
+            after.append(index(row_of[tracked[static_cast<std::size_t>(i)]], before[i].column()));
+        }
+        changePersistentIndexList(before, after);
+    }
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
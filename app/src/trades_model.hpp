@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <QAbstractTableModel>
+
+#include "backtest/types.hpp"
+
+// Read-only table over BacktestResult::trades. Cells are formatted when a view asks for
+// them, so only the visible rows cost anything; sorting reorders an index permutation.
+class TradesModel final : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    explicit TradesModel(QObject* parent = nullptr);
+
+    // trades is viewed, not copied: it must outlive the model or the next set_trades()
+    // call, and any change to it must be followed by set_trades(). nullptr clears the
+    // table; an empty vector shows a single "no trades" row.
+    void set_trades(const std::vector<stockbt::Trade>* trades);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    const std::vector<stockbt::Trade>* trades_{nullptr};
+    std::vector<std::size_t> order_; // row -> index in *trades_
+    int sort_column_{-1};
+    Qt::SortOrder sort_order_{Qt::AscendingOrder};
+};
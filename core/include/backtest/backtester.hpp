@@ -1,11 +1,91 @@
 #pragma once
 
+#include <array>
+#include <vector>
+
 #include "backtest/types.hpp"
 
 namespace stockbt {
 
-BacktestResult run_sma_backtest(const Series& candles,
+class ProgressToken;
+class SmaCache;
+
+// Optional inputs that change how a backtest is computed, never what it computes.
+struct BacktestContext {
+    // Precomputed averages for candles; used when it holds both windows and matches candles.size().
+    const SmaCache* sma_cache{nullptr};
+    // Progress and cancellation; a cancelled run returns an incomplete result.
+    ProgressToken* progress{nullptr};
+};
+
+// Buffers recycled by consecutive full backtests. A run given a workspace overwrites
+// workspace->result in place, reusing its equity, drawdown, trade and warning capacity,
+// and keeps precomputed averages in scratch for the next run. The allocating overloads
+// keep rolling sums in the loop instead. Keep one workspace per thread; results equal
+// those of the allocating overloads.
+struct BacktestWorkspace {
+    BacktestResult result;                         // latest run, overwritten by the next
+    std::array<std::vector<double>, 4> scratch;
+};
+
+BacktestResult run_sma_backtest(CandleView candles,
                                 const SmaParams& params,
                                 const BacktestSettings& settings);
 
+BacktestResult run_sma_backtest(CandleView candles,
+                                const SmaParams& params,
+                                const BacktestSettings& settings,
+                                const BacktestContext& context);
+
+// Column-storage (SoA) input; results are identical to the CandleView overloads.
+BacktestResult run_sma_backtest(ColumnsView columns,
+                                const SmaParams& params,
+                                const BacktestSettings& settings,
+                                const BacktestContext& context = BacktestContext{});
+
+// The workspace overloads return workspace->result.
+const BacktestResult& run_sma_backtest(CandleView candles,
+                                       const SmaParams& params,
+                                       const BacktestSettings& settings,
+                                       const BacktestContext& context,
+                                       BacktestWorkspace* workspace);
+
+const BacktestResult& run_sma_backtest(ColumnsView columns,
+                                       const SmaParams& params,
+                                       const BacktestSettings& settings,
+                                       const BacktestContext& context,
+                                       BacktestWorkspace* workspace);
+
+// Same metrics as run_sma_backtest(...).metrics, computed in a single streaming pass
+// without equity/drawdown curves, trade list or warnings (no per-bar allocation).
+Metrics run_sma_backtest_metrics(CandleView candles,
+                                 const SmaParams& params,
+                                 const BacktestSettings& settings,
+                                 const BacktestContext& context = BacktestContext{});
+
+Metrics run_sma_backtest_metrics(ColumnsView columns,
+                                 const SmaParams& params,
+                                 const BacktestSettings& settings,
+                                 const BacktestContext& context = BacktestContext{});
+
+// Channel breakout on the shared execution core (engine.hpp): same fills, commission,
+// stop-loss/take-profit and force-close rules as run_sma_backtest.
+BacktestResult run_breakout_backtest(CandleView candles,
+                                     const BreakoutParams& params,
+                                     const BacktestSettings& settings);
+
+BacktestResult run_breakout_backtest(ColumnsView columns,
+                                     const BreakoutParams& params,
+                                     const BacktestSettings& settings);
+
+const BacktestResult& run_breakout_backtest(CandleView candles,
+                                            const BreakoutParams& params,
+                                            const BacktestSettings& settings,
+                                            BacktestWorkspace* workspace);
+
+const BacktestResult& run_breakout_backtest(ColumnsView columns,
+                                            const BreakoutParams& params,
+                                            const BacktestSettings& settings,
+                                            BacktestWorkspace* workspace);
+
 } // namespace stockbt
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+class ProgressToken;
+class WorkStealingPool;
+
+// One configuration of a batch run; the remaining BacktestSettings are shared.
+struct BatchConfig {
+    SmaParams params;
+    double stop_loss_pct{0.0};
+    double take_profit_pct{0.0};
+};
+
+// Configurations advanced together in one pass over the bars.
+constexpr std::size_t kBatchLanes = 8;
+
+// Metrics for every config, identical to run_sma_backtest_metrics with the config's
+// windows and stop/take-profit. Configs are split into blocks of kBatchLanes whose
+// state lives in SoA lanes, so each block reads the bars once; averages come from
+// per-lane rolling sums over the close column, so subviews need no copies. Blocks run
+// on pool when given. Invalid configs (and an empty dataset) yield default Metrics, as
+// in the single run.
+std::vector<Metrics> run_sma_backtest_batch(ColumnsView columns,
+                                            const std::vector<BatchConfig>& configs,
+                                            const BacktestSettings& settings,
+                                            WorkStealingPool* pool = nullptr);
+
+// One dataset window of a multi-window run.
+struct BatchJob {
+    ColumnsView columns;
+    const std::vector<BatchConfig>* configs{nullptr};
+    std::vector<Metrics>* results{nullptr}; // resized to configs->size()
+};
+
+// Runs the blocks of all jobs in a single parallel_for, so several windows (e.g.
+// walk-forward folds) and their configs share one pool. progress counts finished
+// blocks; once it is cancelled, blocks not yet started keep default Metrics.
+void run_sma_backtest_batches(const std::vector<BatchJob>& jobs,
+                              const BacktestSettings& settings,
+                              WorkStealingPool* pool = nullptr,
+                              ProgressToken* progress = nullptr);
+
+// Row input is transposed to columns once up front.
+std::vector<Metrics> run_sma_backtest_batch(CandleView candles,
+                                            const std::vector<BatchConfig>& configs,
+                                            const BacktestSettings& settings,
+                                            WorkStealingPool* pool = nullptr);
+
+} // namespace stockbt
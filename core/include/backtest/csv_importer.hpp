@@ -1,11 +1,109 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "backtest/progress.hpp"
 #include "backtest/types.hpp"
 
 namespace stockbt {
 
+struct ImportOptions {
+    // Read through a read-only memory mapping and tokenize fields in place. Falls back
+    // to buffered stream reading when the path cannot be mapped (pipes, special files).
+    bool memory_map{true};
+
+    // Parse memory-mapped input on this many threads (0 = hardware concurrency). The
+    // file body is split into newline-aligned chunks of about chunk_bytes; results are
+    // merged in file order, so candles and issues match the single-threaded import.
+    std::size_t threads{1};
+    std::size_t chunk_bytes{std::size_t{8} << 20};
+
+    // Load "<stem>.sbt" next to the CSV instead of parsing when it was built from a CSV
+    // with the same size, mtime and date format; otherwise parse and (re)write it.
+    // Cache write failures are ignored. Paths ending in .sbt are always loaded directly.
+    bool binary_cache{false};
+
+    // Fill ImportResult::columns (SoA) instead of ImportResult::candles.
+    SeriesLayout layout{SeriesLayout::Rows};
+
+    // Line numbers kept per drop reason in ImportResult::row_issues; the counts are
+    // always exact.
+    std::size_t issue_samples{100};
+
+    // Optional; receives the fraction of the file parsed. A cancelled import fails
+    // with an "Import cancelled" error and writes no cache.
+    ProgressToken* progress{nullptr};
+};
+
 ImportResult import_ohlcv_csv(const std::string& csv_path, DateFormat date_format);
+ImportResult import_ohlcv_csv(const std::string& csv_path, DateFormat date_format, const ImportOptions& options);
+
+// Bounded-memory reading of datasets too large to import whole. Rows are validated
+// like import_ohlcv_csv but never collected: they are handed out in chunks of at most
+// chunk_rows bars, and only the chunk buffer and the row issue samples stay resident.
+struct StreamImportOptions {
+    std::size_t chunk_rows{std::size_t{1} << 16};
+    bool memory_map{true}; // as ImportOptions::memory_map
+    std::size_t issue_samples{100};
+    // Optional; receives the fraction of the input read. A cancelled stream fails with
+    // an "Import cancelled" error.
+    ProgressToken* progress{nullptr};
+};
+
+struct StreamImportResult {
+    bool success{false};
+    bool partial_success{false}; // rows were dropped
+    DatasetMetadata dataset;     // bars handed out and their time range
+    std::size_t dropped_rows{0};
+    std::size_t duplicates_removed{0};
+    std::vector<ImportIssue> warnings; // as ImportResult::warnings
+    std::vector<ImportIssue> errors;
+    RowIssueSummary row_issues;
+};
+
+// Receives each chunk in time order; the view is only valid during the call. Returning
+// false stops the stream, which then fails with *error.
+using StreamChunkFn = std::function<bool(ColumnsView chunk, std::string* error)>;
+
+// Streams a CSV or .sbt dataset. Unlike import_ohlcv_csv nothing can be sorted: CSV
+// timestamps must ascend (equal timestamps still keep the last row), and a row older
+// than its predecessor fails the stream. An .sbt file is already sorted and is handed
+// out straight from its mapping. The chunks concatenate to the candles import_ohlcv_csv
+// returns for ascending input, with the same warnings and row issue summary.
+StreamImportResult stream_ohlcv(const std::string& path,
+                                DateFormat date_format,
+                                const StreamImportOptions& options,
+                                const StreamChunkFn& on_chunk);
+
+// "Dropped row: invalid timestamp format" etc.
+const char* row_drop_message(RowDropReason reason);
+
+// One issue per sampled line in line order, then "<message> (N more rows)" for each
+// reason with more drops than samples.
+std::vector<ImportIssue> describe_row_issues(const RowIssueSummary& summary);
+
+// Cuts summary to `samples` lines per reason and rebuilds the describe_row_issues
+// messages that end warnings, e.g. for a dataset cache written with more samples.
+void limit_row_issue_samples(std::size_t samples, RowIssueSummary* summary, std::vector<ImportIssue>* warnings);
+
+// Stages of import_ohlcv_csv, exposed so they can be timed on their own
+// (tools/benchmark_suite).
+
+// Splits one data line into trimmed fields. Quoted lines are unescaped into *storage;
+// the views point into line or *storage until the next call.
+void split_csv_fields(std::string_view line, std::vector<std::string_view>* fields, std::vector<std::string>* storage);
+
+// One numeric field, accepting exactly what strtod accepts (surrounding spaces allowed).
+bool parse_csv_number(std::string_view text, double* out);
+
+// Stable-sorts rows by timestamp and keeps the last row of each timestamp, in place.
+// Ascending input is only deduped, newest-first input reversed, and input with few
+// out-of-order rows merged instead of fully sorted. Returns the number of rows
+// removed; *unsorted tells whether any row was out of order.
+std::size_t sort_and_dedupe_candles(Series* rows, bool* unsorted);
 
 } // namespace stockbt
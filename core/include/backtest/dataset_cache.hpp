@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "backtest/mapped_file.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+// Size and modification time of the CSV a cache was built from.
+struct SourceStamp {
+    uint64_t size{0};
+    int64_t mtime{0}; // file clock ticks; only compared for equality
+
+    bool operator==(const SourceStamp& other) const { return size == other.size && mtime == other.mtime; }
+    bool operator!=(const SourceStamp& other) const { return !(*this == other); }
+};
+
+bool read_source_stamp(const std::string& path, SourceStamp* stamp);
+
+// "<dir>/<stem>.sbt" next to the CSV.
+std::string dataset_cache_path(const std::string& csv_path);
+
+// Writes a successful import (either layout) as a binary columnar dataset (.sbt): one
+// raw array per ts/o/h/l/c/v column, plus DatasetMetadata, import flags and warnings.
+bool write_dataset_cache(const std::string& cache_path,
+                         const ImportResult& import,
+                         DateFormat date_format,
+                         const SourceStamp& source,
+                         std::string* error);
+
+// Read-only view of a .sbt dataset. Columns point straight into the memory mapping.
+class DatasetCache {
+public:
+    bool open(const std::string& cache_path, std::string* error);
+
+    std::size_t rows() const { return rows_; }
+    const int64_t* ts() const { return ts_; }
+    const double* o() const { return o_; }
+    const double* h() const { return h_; }
+    const double* l() const { return l_; }
+    const double* c() const { return c_; }
+    const double* v() const { return v_; }
+    ColumnsView columns() const { return ColumnsView(ts_, o_, h_, l_, c_, v_, rows_); }
+
+    // MappedFile::release for rows [begin, end) of every column, for one-pass readers.
+    void release_rows(std::size_t begin, std::size_t end) const;
+
+    const DatasetMetadata& metadata() const { return metadata_; }
+    const SourceStamp& source() const { return source_; }
+    DateFormat date_format() const { return date_format_; }
+
+    // Outcome of the import the cache was built from.
+    bool partial_success() const { return partial_success_; }
+    std::size_t dropped_rows() const { return dropped_rows_; }
+    const std::vector<ImportIssue>& warnings() const { return warnings_; }
+    const RowIssueSummary& row_issues() const { return row_issues_; }
+
+    // True when the cache was built from a CSV with this stamp and date format by the
+    // current importer.
+    bool matches(const SourceStamp& source, DateFormat date_format) const;
+
+    // Row issue samples (and their warnings) are cut to issue_samples per reason, so a
+    // cache written with more samples than the caller asks for stays within its bound.
+    ImportResult to_import_result(SeriesLayout layout = SeriesLayout::Rows,
+                                  std::size_t issue_samples = static_cast<std::size_t>(-1)) const;
+
+private:
+    MappedFile file_;
+    std::size_t rows_{0};
+    const int64_t* ts_{nullptr};
+    const double* o_{nullptr};
+    const double* h_{nullptr};
+    const double* l_{nullptr};
+    const double* c_{nullptr};
+    const double* v_{nullptr};
+    DatasetMetadata metadata_;
+    SourceStamp source_;
+    DateFormat date_format_{DateFormat::Iso};
+    uint32_t importer_version_{0};
+    bool partial_success_{false};
+    std::size_t dropped_rows_{0};
+    std::vector<ImportIssue> warnings_;
+    RowIssueSummary row_issues_;
+};
+
+} // namespace stockbt
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace stockbt {
@@ -22,4 +23,56 @@ std::vector<BucketMinMax> downsample_bucket_min_max(const std::vector<SeriesPoin
                                                      std::size_t pixel_width,
                                                      std::size_t display_cap = 50000);
 
+// Same buckets over separate timestamp/value columns, e.g. ColumnsView::ts() and c().
+std::vector<BucketMinMax> downsample_bucket_min_max(const int64_t* ts,
+                                                     const double* values,
+                                                     std::size_t count,
+                                                     std::size_t pixel_width,
+                                                     std::size_t display_cap = 50000);
+
+// Multi-resolution min/max index over a time-sorted series for interactive charts.
+// Level k holds the positions of the minimum and maximum of every block of
+// kFanout^k points, so the extremes of any index range take O(kFanout * log N)
+// and a whole screen of buckets O(pixels * log N), without copying the range.
+// Timestamps are held by shared pointer, so several series over the same bars (close,
+// equity, drawdown) can index one timestamp array.
+class MinMaxPyramid {
+public:
+    static constexpr std::size_t kFanout = 8;
+
+    MinMaxPyramid() = default;
+    explicit MinMaxPyramid(const std::vector<SeriesPoint>& points);
+    // values[i] belongs to (*ts)[i]; timestamps past values.size() are ignored.
+    // Requires values.size() <= ts->size().
+    MinMaxPyramid(std::shared_ptr<const std::vector<int64_t>> ts, std::vector<double> values);
+
+    std::size_t size() const { return values_.size(); }
+    const std::shared_ptr<const std::vector<int64_t>>& timestamps() const { return ts_; }
+    int64_t ts(std::size_t i) const { return (*ts_)[i]; }
+    double value(std::size_t i) const { return values_[i]; }
+
+    // Extremes of points [begin, end), ties resolved to the earliest point as in
+    // downsample_bucket_min_max. Requires begin < end <= size().
+    BucketMinMax range_min_max(std::size_t begin, std::size_t end) const;
+
+    // Same buckets as downsample_bucket_min_max over the points with
+    // t0 <= ts <= t1.
+    std::vector<BucketMinMax> query(int64_t t0,
+                                    int64_t t1,
+                                    std::size_t pixel_width,
+                                    std::size_t display_cap = 50000) const;
+
+private:
+    struct Level {
+        std::vector<std::size_t> min_index;
+        std::vector<std::size_t> max_index;
+    };
+
+    void build_levels();
+
+    std::shared_ptr<const std::vector<int64_t>> ts_;
+    std::vector<double> values_;
+    std::vector<Level> levels_; // levels_[k - 1] is level k; level 0 is values_
+};
+
 } // namespace stockbt
@@ -0,0 +1,424 @@
+#pragma once
+
+// Shared execution/accounting core for single-position long-only strategies.
+//
+// A strategy only produces signals; run_strategy owns fills and bookkeeping:
+// orders fill at the next bar's open, commission is charged on both legs, the
+// stop-loss/take-profit check runs on each close, and an open position is
+// force-closed at the last close. Strategies and recorders are template
+// parameters, so every combination compiles into its own loop without virtual
+// calls.
+//
+// Strategy requirements:
+//   const char* invalid_reason() const;      // nullptr when parameters are usable
+//   std::size_t warmup_bars() const;         // dataset length needed for any signal
+//   const char* short_data_warning() const;  // reported when size() < warmup_bars()
+//   Signal on_bar(std::size_t i);            // called once per bar, in order, after
+//                                            // fills; may only look at bars <= i
+//
+// Recorder requirements:
+//   void begin(std::size_t bars, double starting_cash);
+//   void warn(const char* message);
+//   void trade(const Trade& trade);
+//   void equity(std::size_t i, double value);
+//   void replace_last_equity(double value);  // force-close at the final bar
+//   void finish(const BacktestSettings& settings);
+//
+// Bars requirements: size(), ts(i), open(i), close(i) (see RowBars, ColumnBars).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "backtest/progress.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+enum class Signal {
+    None,
+    Enter, // open a long position at the next bar's open when flat
+    Exit,  // close the position at the next bar's open when long
+};
+
+// Bar access over row (AoS) storage.
+class RowBars {
+public:
+    explicit RowBars(CandleView candles) : candles_(candles) {}
+
+    std::size_t size() const { return candles_.size(); }
+    int64_t ts(std::size_t i) const { return candles_[i].ts; }
+    double open(std::size_t i) const { return candles_[i].o; }
+    double close(std::size_t i) const { return candles_[i].c; }
+
+private:
+    CandleView candles_;
+};
+
+// Bar access over column (SoA) storage; the loop only streams ts, o and c.
+class ColumnBars {
+public:
+    explicit ColumnBars(ColumnsView columns)
+        : ts_(columns.ts()), o_(columns.o()), c_(columns.c()), size_(columns.size()) {}
+
+    std::size_t size() const { return size_; }
+    int64_t ts(std::size_t i) const { return ts_[i]; }
+    double open(std::size_t i) const { return o_[i]; }
+    double close(std::size_t i) const { return c_[i]; }
+
+private:
+    const int64_t* ts_;
+    const double* o_;
+    const double* c_;
+    std::size_t size_;
+};
+
+inline double clamp01(double value) {
+    if (value < 0.0) {
+        return 0.0;
+    }
+    if (value > 1.0) {
+        return 1.0;
+    }
+    return value;
+}
+
+inline Trade make_trade(int64_t entry_time,
+                        double entry_price,
+                        int64_t exit_time,
+                        double exit_price,
+                        int qty,
+                        double commission_pct) {
+    Trade trade;
+    trade.entry_time = entry_time;
+    trade.entry_price = entry_price;
+    trade.exit_time = exit_time;
+    trade.exit_price = exit_price;
+    trade.qty = qty;
+    trade.pnl = (exit_price - entry_price) * static_cast<double>(qty) -
+                (entry_price * static_cast<double>(qty) * commission_pct) -
+                (exit_price * static_cast<double>(qty) * commission_pct);
+    trade.return_pct = (entry_price > 0.0) ? ((exit_price - entry_price) / entry_price) : 0.0;
+    return trade;
+}
+
+struct TradeTally {
+    int trades{0};
+    int wins{0};
+    double sum_returns{0.0};
+
+    void add(const Trade& trade) {
+        ++trades;
+        if (trade.pnl > 0.0) {
+            ++wins;
+        }
+        sum_returns += trade.return_pct;
+    }
+};
+
+inline Metrics finalize_metrics(double final_equity,
+                                double min_dd,
+                                const TradeTally& tally,
+                                const BacktestSettings& settings) {
+    Metrics metrics;
+    metrics.total_pnl = final_equity - settings.starting_cash;
+    metrics.total_return_pct =
+        (settings.starting_cash != 0.0) ? (metrics.total_pnl / settings.starting_cash) * 100.0 : 0.0;
+    metrics.trades = tally.trades;
+    metrics.win_rate_pct =
+        (tally.trades == 0) ? 0.0 : (static_cast<double>(tally.wins) / static_cast<double>(tally.trades)) * 100.0;
+    metrics.avg_trade_return_pct =
+        (tally.trades == 0) ? 0.0 : (tally.sum_returns / static_cast<double>(tally.trades)) * 100.0;
+    metrics.max_drawdown_pct = min_dd * 100.0;
+    return metrics;
+}
+
+// Records the full equity/drawdown curves, trade list and warnings.
+class FullRecorder {
+public:
+    explicit FullRecorder(BacktestResult* result) : result_(result) {}
+
+    void begin(std::size_t n, double starting_cash) {
+        result_->equity.assign(n, starting_cash);
+        result_->drawdown.assign(n, 0.0);
+    }
+    void warn(const char* message) { result_->warnings.push_back(message); }
+    void trade(const Trade& trade) { result_->trades.push_back(trade); }
+    void equity(std::size_t i, double value) { result_->equity[i] = value; }
+    void replace_last_equity(double value) { result_->equity.back() = value; }
+
+    void finish(const BacktestSettings& settings) {
+        double peak = -std::numeric_limits<double>::infinity();
+        double min_dd = 0.0;
+        for (std::size_t i = 0; i < result_->equity.size(); ++i) {
+            peak = std::max(peak, result_->equity[i]);
+            const double dd = (peak > 0.0) ? (result_->equity[i] - peak) / peak : 0.0;
+            result_->drawdown[i] = dd;
+            min_dd = std::min(min_dd, dd);
+        }
+
+        TradeTally tally;
+        for (const Trade& trade : result_->trades) {
+            tally.add(trade);
+        }
+        const double final_equity = result_->equity.empty() ? settings.starting_cash : result_->equity.back();
+        result_->metrics = finalize_metrics(final_equity, min_dd, tally, settings);
+    }
+
+private:
+    BacktestResult* result_;
+};
+
+// Running metrics of a MetricsRecorder between bars.
+struct MetricsState {
+    TradeTally tally;
+    double peak{-std::numeric_limits<double>::infinity()};
+    double min_dd{0.0};
+    double last{0.0};
+    bool has_last{false};
+};
+
+// Folds equity into peak/drawdown and trades into a tally as they are produced.
+// The latest equity value is held back because a force-close may still replace it.
+class MetricsRecorder {
+public:
+    explicit MetricsRecorder(Metrics* metrics) : metrics_(metrics) {}
+    // Resumes from a state returned by state().
+    MetricsRecorder(Metrics* metrics, const MetricsState& state) : metrics_(metrics), state_(state) {}
+
+    const MetricsState& state() const { return state_; }
+
+    void begin(std::size_t, double) {}
+    void warn(const char*) {}
+    void trade(const Trade& trade) { state_.tally.add(trade); }
+    void equity(std::size_t, double value) {
+        if (state_.has_last) {
+            fold(state_.last);
+        }
+        state_.last = value;
+        state_.has_last = true;
+    }
+    void replace_last_equity(double value) { state_.last = value; }
+
+    void finish(const BacktestSettings& settings) {
+        if (state_.has_last) {
+            fold(state_.last);
+        }
+        *metrics_ = finalize_metrics(state_.has_last ? state_.last : settings.starting_cash,
+                                     state_.min_dd,
+                                     state_.tally,
+                                     settings);
+    }
+
+private:
+    void fold(double value) {
+        state_.peak = std::max(state_.peak, value);
+        const double dd = (state_.peak > 0.0) ? (value - state_.peak) / state_.peak : 0.0;
+        state_.min_dd = std::min(state_.min_dd, dd);
+    }
+
+    Metrics* metrics_;
+    MetricsState state_;
+};
+
+enum class PendingOrder {
+    None,
+    Buy,
+    Sell,
+};
+
+// Position and cash of an ExecutionCore between bars.
+struct ExecutionState {
+    double cash{0.0};
+    int qty{0};
+    int64_t entry_time{0};
+    double entry_price{0.0};
+    PendingOrder pending{PendingOrder::None};
+};
+
+// Position and cash bookkeeping, advanced one bar at a time. Per bar, call
+// fill_pending, then on_signal, then close_bar; call finish after the last bar.
+// has_next tells whether another bar follows, since orders fill on the next open.
+template <typename Recorder>
+class ExecutionCore {
+public:
+    ExecutionCore(const BacktestSettings& settings, Recorder& recorder)
+        : ExecutionCore(settings, recorder, initial_state(settings)) {}
+
+    // Resumes from a state returned by state().
+    ExecutionCore(const BacktestSettings& settings, Recorder& recorder, const ExecutionState& state)
+        : settings_(settings),
+          recorder_(recorder),
+          position_size_pct_(clamp01(settings.position_size_pct)),
+          stop_loss_enabled_(settings.stop_loss_pct > 0.0),
+          take_profit_enabled_(settings.take_profit_pct > 0.0),
+          cash_(state.cash),
+          qty_(state.qty),
+          entry_time_(state.entry_time),
+          entry_price_(state.entry_price),
+          pending_(state.pending) {}
+
+    static ExecutionState initial_state(const BacktestSettings& settings) {
+        ExecutionState state;
+        state.cash = settings.starting_cash;
+        return state;
+    }
+
+    ExecutionState state() const {
+        ExecutionState state;
+        state.cash = cash_;
+        state.qty = qty_;
+        state.entry_time = entry_time_;
+        state.entry_price = entry_price_;
+        state.pending = pending_;
+        return state;
+    }
+
+    bool in_position() const { return qty_ > 0; }
+
+    // Executes the order scheduled on the previous bar at this bar's open.
+    void fill_pending(int64_t ts, double open) {
+        if (pending_ == PendingOrder::Buy) {
+            const double denom = open * (1.0 + settings_.commission_pct);
+            const double budget = cash_ * position_size_pct_;
+            const int buy_qty = (denom > 0.0) ? static_cast<int>(std::floor(budget / denom)) : 0;
+            if (buy_qty > 0) {
+                const double cost = static_cast<double>(buy_qty) * open;
+                const double commission = cost * settings_.commission_pct;
+                cash_ -= (cost + commission);
+                qty_ = buy_qty;
+                entry_time_ = ts;
+                entry_price_ = open;
+            }
+            pending_ = PendingOrder::None;
+        } else if (pending_ == PendingOrder::Sell) {
+            if (qty_ > 0) {
+                const double proceeds = static_cast<double>(qty_) * open;
+                const double commission = proceeds * settings_.commission_pct;
+                cash_ += (proceeds - commission);
+
+                recorder_.trade(make_trade(entry_time_, entry_price_, ts, open, qty_, settings_.commission_pct));
+                qty_ = 0;
+                entry_time_ = 0;
+                entry_price_ = 0.0;
+            }
+            pending_ = PendingOrder::None;
+        }
+    }
+
+    void on_signal(Signal signal, bool has_next) {
+        const bool act = (signal == Signal::Enter && qty_ == 0) || (signal == Signal::Exit && qty_ > 0);
+        if (!act || pending_ != PendingOrder::None) {
+            return;
+        }
+        if (has_next) {
+            pending_ = (signal == Signal::Enter) ? PendingOrder::Buy : PendingOrder::Sell;
+        } else {
+            recorder_.warn("Last bar signal discarded (no next bar for execution).");
+        }
+    }
+
+    // Stop-loss/take-profit check on the close, then marks equity for bar i.
+    void close_bar(std::size_t i, double close, bool has_next) {
+        if (qty_ > 0 && pending_ == PendingOrder::None) {
+            const double bar_return = (entry_price_ > 0.0) ? ((close - entry_price_) / entry_price_) : 0.0;
+            if (stop_loss_enabled_ && bar_return <= -settings_.stop_loss_pct) {
+                if (has_next) {
+                    pending_ = PendingOrder::Sell;
+                    recorder_.warn("Stop-loss triggered; exit scheduled on next bar open.");
+                } else {
+                    recorder_.warn("Stop-loss triggered on last bar; exiting at final close.");
+                }
+            } else if (take_profit_enabled_ && bar_return >= settings_.take_profit_pct) {
+                if (has_next) {
+                    pending_ = PendingOrder::Sell;
+                    recorder_.warn("Take-profit triggered; exit scheduled on next bar open.");
+                } else {
+                    recorder_.warn("Take-profit triggered on last bar; exiting at final close.");
+                }
+            }
+        }
+
+        recorder_.equity(i, cash_ + static_cast<double>(qty_) * close);
+    }
+
+    // Force-closes an open position at the last bar's close.
+    void finish(int64_t last_ts, double last_close) {
+        if (qty_ > 0) {
+            const double proceeds = static_cast<double>(qty_) * last_close;
+            const double commission = proceeds * settings_.commission_pct;
+            cash_ += (proceeds - commission);
+
+            recorder_.trade(
+                make_trade(entry_time_, entry_price_, last_ts, last_close, qty_, settings_.commission_pct));
+
+            qty_ = 0;
+            recorder_.replace_last_equity(cash_);
+            recorder_.warn("Open position force-closed at last bar close.");
+        }
+    }
+
+private:
+    const BacktestSettings& settings_;
+    Recorder& recorder_;
+    double position_size_pct_;
+    bool stop_loss_enabled_;
+    bool take_profit_enabled_;
+    double cash_;
+    int qty_;
+    int64_t entry_time_;
+    double entry_price_;
+    PendingOrder pending_;
+};
+
+// With a progress token the bars run in ProgressToken::kInterval slices; a cancelled
+// run stops at a slice boundary with a warning and without recorder.finish.
+template <typename Bars, typename Strategy, typename Recorder>
+void run_strategy(const Bars& bars,
+                  Strategy& strategy,
+                  const BacktestSettings& settings,
+                  Recorder& recorder,
+                  ProgressToken* progress = nullptr) {
+    if (bars.size() == 0) {
+        recorder.warn("Backtest skipped: empty dataset.");
+        return;
+    }
+    if (const char* reason = strategy.invalid_reason()) {
+        recorder.warn(reason);
+        return;
+    }
+
+    const std::size_t n = bars.size();
+    recorder.begin(n, settings.starting_cash);
+
+    if (n < strategy.warmup_bars()) {
+        recorder.warn(strategy.short_data_warning());
+    }
+
+    ExecutionCore<Recorder> core(settings, recorder);
+    const std::size_t slice = (progress != nullptr) ? ProgressToken::kInterval : n;
+    for (std::size_t begin = 0; begin < n; begin += slice) {
+        if (progress != nullptr) {
+            if (progress->cancelled()) {
+                recorder.warn("Backtest cancelled.");
+                return;
+            }
+            report_progress(progress, begin, n);
+        }
+        const std::size_t end = std::min(n, begin + slice);
+        for (std::size_t i = begin; i < end; ++i) {
+            const bool has_next = i + 1 < n;
+            core.fill_pending(bars.ts(i), bars.open(i));
+            core.on_signal(strategy.on_bar(i), has_next);
+            core.close_bar(i, bars.close(i), has_next);
+        }
+    }
+    core.finish(bars.ts(n - 1), bars.close(n - 1));
+
+    recorder.finish(settings);
+    report_progress(progress, n, n);
+}
+
+} // namespace stockbt
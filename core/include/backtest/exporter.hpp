@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "backtest/incremental_backtest.hpp"
+#include "backtest/sweep.hpp"
 #include "backtest/types.hpp"
 
 namespace stockbt {
 
 bool export_equity_csv(const std::string& output_path,
-                       const Series& candles,
+                       CandleView candles,
                        const BacktestResult& result,
                        std::string* error);
 
@@ -22,4 +28,85 @@ bool export_metrics_json(const std::string& output_path,
                          const Metrics& metrics,
                          std::string* error);
 
+// Writes the files of export_equity_csv and export_trades_csv while an
+// IncrementalSmaBacktest runs, keeping one output block per file in memory. Each equity
+// row is written once the next bar (or finish) makes it final.
+class StreamingCsvExporter final : public BacktestObserver {
+public:
+    StreamingCsvExporter();
+    ~StreamingCsvExporter() override;
+
+    // An empty path skips that file.
+    bool open(const std::string& equity_path, const std::string& trades_path, std::string* error);
+
+    void trade(const Trade& trade) override;
+    void equity(int64_t ts, double value) override;
+    void replace_last_equity(double value) override;
+
+    // Writes the last equity row and flushes; false when any write failed.
+    bool finish(std::string* error);
+
+private:
+    struct Files;
+
+    std::unique_ptr<Files> files_;
+    int64_t pending_ts_{0};
+    double pending_equity_{0.0};
+    bool has_pending_{false};
+};
+
+// Columnar binary exports: the container of the .sbt dataset cache with one column
+// per field, loaded back without text parsing. Metrics and trade fields keep full
+// double precision.
+struct BinaryExportOptions {
+    // Varint-encode columns (delta timestamps, XOR-packed doubles) instead of storing
+    // them raw; usually much smaller, at the cost of a decode pass on load.
+    bool compress{false};
+};
+
+struct EquityTable {
+    std::vector<int64_t> ts;
+    std::vector<double> equity;
+    std::vector<double> drawdown;
+};
+
+// Columns ts, equity and drawdown, as many rows as export_equity_csv writes.
+bool export_equity_binary(const std::string& output_path,
+                          CandleView candles,
+                          const BacktestResult& result,
+                          const BinaryExportOptions& options,
+                          std::string* error);
+bool load_equity_binary(const std::string& path, EquityTable* table, std::string* error);
+
+bool export_trades_binary(const std::string& output_path,
+                          const BacktestResult& result,
+                          const BinaryExportOptions& options,
+                          std::string* error);
+bool load_trades_binary(const std::string& path, std::vector<Trade>* trades, std::string* error);
+
+// Stored in a binary sweep report's metadata. A single-node report is shard 0 of 1.
+struct SweepReportInfo {
+    SweepShard shard;
+    std::size_t total_cells{0}; // configs in the whole grid
+    bool risk_axes{false};      // the CSV report lists stop_loss_pct,take_profit_pct
+    bool pruning{false};        // the CSV report lists pruned,pruned_at_bar
+};
+
+// Rows in the given order (sort first for report order). Without info the report is
+// recorded as a whole grid of rows.size() cells.
+bool export_sweep_binary(const std::string& output_path,
+                         const std::vector<SweepRow>& rows,
+                         const BinaryExportOptions& options,
+                         std::string* error);
+bool export_sweep_binary(const std::string& output_path,
+                         const std::vector<SweepRow>& rows,
+                         const SweepReportInfo& info,
+                         const BinaryExportOptions& options,
+                         std::string* error);
+bool load_sweep_binary(const std::string& path, std::vector<SweepRow>* rows, std::string* error);
+bool load_sweep_binary(const std::string& path,
+                       std::vector<SweepRow>* rows,
+                       SweepReportInfo* info,
+                       std::string* error);
+
 } // namespace stockbt
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "backtest/engine.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+// Receives the trades and per-bar equity of an IncrementalSmaBacktest as they are
+// produced, for streaming them out instead of keeping curves in memory. The equity of
+// the newest bar is provisional: finish() revises it through replace_last_equity()
+// when it force-closes an open position.
+class BacktestObserver {
+public:
+    virtual ~BacktestObserver() = default;
+    virtual void trade(const Trade& trade) = 0;
+    virtual void equity(int64_t ts, double value) = 0;
+    virtual void replace_last_equity(double value) = 0;
+};
+
+// Resumable SMA crossover backtest for series that only grow at the end. Holds the
+// rolling sums (with a ring of the last slow_window closes), crossover state, pending
+// order, position, cash and running metrics, so each appended bar costs O(1) and
+// metrics() always equals run_sma_backtest_metrics over every bar consumed so far.
+//
+// Bars are processed as if another bar follows; that choice only affects the pending
+// order, which metrics() does not depend on, and is exactly what a rerun does once
+// the next bar arrives.
+class IncrementalSmaBacktest {
+public:
+    IncrementalSmaBacktest() = default;
+    IncrementalSmaBacktest(const SmaParams& params, const BacktestSettings& settings);
+
+    const SmaParams& params() const { return params_; }
+    const BacktestSettings& settings() const { return settings_; }
+    std::size_t bars() const { return bars_; }
+    int64_t last_ts() const { return last_ts_; }
+
+    // Consumes bars in order. Fails without consuming anything when a timestamp is not
+    // after the previous bar's.
+    bool append(const Candle& bar, std::string* error);
+    bool append(CandleView bars, std::string* error);
+    bool append(ColumnsView bars, std::string* error);
+
+    // Consumes the rows of series beyond bars(), for callers that re-import the whole
+    // series. The row at bars() - 1 must carry last_ts().
+    bool extend(ColumnsView series, std::string* error);
+
+    Metrics metrics() const;
+
+    // Optional; not owned and not saved. Receives every bar appended from now on.
+    void set_observer(BacktestObserver* observer) { observer_ = observer; }
+
+    // metrics(), also reporting the final force-close to the observer. Call once,
+    // after the last bar: equity and trades then match run_sma_backtest over every
+    // consumed bar.
+    Metrics finish() const;
+
+    // Binary state file (same container as the .sbt dataset cache); doubles are stored
+    // bit-exact, so a loaded backtest continues exactly where the saved one stopped.
+    bool save(const std::string& path, std::string* error) const;
+    bool load(const std::string& path, std::string* error);
+
+private:
+    bool check_order(int64_t ts, int64_t prev_ts, std::size_t offset, std::string* error) const;
+    void consume(int64_t ts, double open, double close);
+    Metrics close_out(BacktestObserver* observer) const;
+
+    SmaParams params_;
+    BacktestSettings settings_;
+    std::size_t bars_{0};
+    int64_t last_ts_{0};
+    double last_close_{0.0};
+
+    double fast_sum_{0.0};
+    double slow_sum_{0.0};
+    std::vector<double> ring_; // close of bar i at ring_[i % slow_window]
+    double prev_fast_{0.0};
+    double prev_slow_{0.0};
+    bool prev_valid_{false};
+
+    ExecutionState execution_;
+    MetricsState recorder_;
+    BacktestObserver* observer_{nullptr};
+};
+
+} // namespace stockbt
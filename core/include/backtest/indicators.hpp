@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+
+namespace stockbt {
+
+// Instruction sets the indicator kernels can run on.
+enum class SimdLevel {
+    Scalar,
+    Avx2,
+    Neon,
+};
+
+// Best level supported by this build and CPU (checked once at runtime).
+SimdLevel detected_simd_level();
+
+const char* simd_level_name(SimdLevel level); // "scalar", "avx2", "neon"
+
+// Level the SMA, EMA and stddev kernels use for a call over `windows` windows: the
+// resolved level when at least two windows share a vector group, otherwise Scalar.
+SimdLevel indicator_kernel_level(std::size_t windows, SimdLevel level = detected_simd_level());
+
+// Rolling indicators over contiguous arrays such as ColumnsView::c(). Every output
+// holds n values; SMA, stddev, min and max entries before index window - 1 are 0, and
+// a window/period of 0 yields all zeros.
+//
+// Vector kernels run one SIMD lane per window/period with the same operation order
+// as the scalar reference, so every level returns bit-identical results (tolerance:
+// exact). FMA contraction is disabled for the module for the same reason. Inputs
+// must be finite. Requesting a level the CPU lacks falls back to Scalar.
+//
+// Single-window calls (rolling_sma, ema, rolling_stddev, and a batch whose last vector
+// group holds one window) stay scalar: their recurrences are sequential in time, and
+// splitting them across lanes (prefix sums, blocked updates) would change rounding.
+// Only the _batch calls over several windows use the vector kernels; rolling_min and
+// rolling_max vectorize along time for any call.
+
+// Same rolling-sum recurrence as run_sma_backtest.
+void rolling_sma(const double* values,
+                 std::size_t n,
+                 std::size_t window,
+                 double* out,
+                 SimdLevel level = detected_simd_level());
+
+// out[k] receives the SMA for windows[k].
+void rolling_sma_batch(const double* values,
+                       std::size_t n,
+                       const std::size_t* windows,
+                       std::size_t count,
+                       double* const* out,
+                       SimdLevel level = detected_simd_level());
+
+// alpha = 2 / (period + 1), seeded with values[0]; defined from index 0.
+void ema(const double* values, std::size_t n, std::size_t period, double* out, SimdLevel level = detected_simd_level());
+
+void ema_batch(const double* values,
+               std::size_t n,
+               const std::size_t* periods,
+               std::size_t count,
+               double* const* out,
+               SimdLevel level = detected_simd_level());
+
+// Population standard deviation, Welford-style sliding mean/M2 update (no sum-of-
+// squares cancellation).
+void rolling_stddev(const double* values,
+                    std::size_t n,
+                    std::size_t window,
+                    double* out,
+                    SimdLevel level = detected_simd_level());
+
+void rolling_stddev_batch(const double* values,
+                          std::size_t n,
+                          const std::size_t* windows,
+                          std::size_t count,
+                          double* const* out,
+                          SimdLevel level = detected_simd_level());
+
+// van Herk/Gil-Werman: block prefix/suffix extremes, then one vectorized combine
+// pass, about three comparisons per element for any window. Exact.
+void rolling_min(const double* values,
+                 std::size_t n,
+                 std::size_t window,
+                 double* out,
+                 SimdLevel level = detected_simd_level());
+
+void rolling_max(const double* values,
+                 std::size_t n,
+                 std::size_t window,
+                 double* out,
+                 SimdLevel level = detected_simd_level());
+
+} // namespace stockbt
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace stockbt {
+
+// Read-only memory mapping of a regular file. Empty files open successfully with size() == 0.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path, std::string* error);
+    void close();
+
+    // Lets the pages of [offset, offset + bytes) that were already read leave memory;
+    // later reads fault them back in from the file. Only whole pages inside the range
+    // are released, and it is a no-op where unsupported.
+    void release(std::size_t offset, std::size_t bytes) const;
+
+    bool is_open() const { return open_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_{nullptr};
+    std::size_t size_{0};
+    bool open_{false};
+#if defined(_WIN32)
+    void* file_handle_{nullptr};
+    void* mapping_handle_{nullptr};
+#endif
+};
+
+} // namespace stockbt
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+struct SymbolSource {
+    std::string symbol; // file stem unless the manifest names it
+    std::string path;
+};
+
+// A directory yields every *.csv and *.sbt in it, sorted by file name (a .csv wins
+// over a .sbt of the same stem). Any other path is read as a manifest: one
+// "path" or "symbol,path" per line, relative paths resolved against the manifest's
+// directory, blank lines and lines starting with '#' skipped.
+bool list_symbol_sources(const std::string& path, std::vector<SymbolSource>* sources, std::string* error);
+
+struct MultiSymbolOptions {
+    // Symbols processed concurrently (0 = hardware concurrency). Each worker holds
+    // one imported dataset at a time, so peak memory is bounded by this many series.
+    std::size_t threads{1};
+    DateFormat date_format{DateFormat::Iso};
+    bool binary_cache{false}; // as ImportOptions::binary_cache
+};
+
+struct SymbolResult {
+    std::string symbol;
+    std::string path;
+    bool success{false};
+    std::string error; // first import error when !success
+    std::size_t rows{0};
+    Metrics metrics;
+    double import_ms{0.0};
+    double backtest_ms{0.0};
+
+    // Imported + backtested rows per second of this symbol's pipeline.
+    double rows_per_second() const;
+};
+
+struct MultiSymbolSummary {
+    std::size_t symbols{0};
+    std::size_t failed{0};
+    std::size_t total_rows{0};
+    double wall_ms{0.0};
+    std::size_t peak_datasets{0}; // imported series alive at the same time
+    std::size_t peak_rows{0};     // rows held by those series
+};
+
+// Streams every source through import -> metrics-only SMA backtest -> release on a
+// work-stealing pool; datasets are dropped as soon as their metrics are known. A
+// failed import is reported in its SymbolResult and does not stop the run. Results
+// are in sources order for any thread count.
+std::vector<SymbolResult> run_multi_symbol_backtest(const std::vector<SymbolSource>& sources,
+                                                    const SmaParams& params,
+                                                    const BacktestSettings& settings,
+                                                    const MultiSymbolOptions& options,
+                                                    MultiSymbolSummary* summary = nullptr);
+
+} // namespace stockbt
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace stockbt {
+
+// Cooperative cancellation and progress for long-running calls (imports, backtests,
+// sweeps). The caller keeps the token alive for the whole call and may cancel() it
+// or read progress() from any thread. Workers poll it every kInterval rows or bars,
+// so a cancelled call returns within one interval; what it returns then is
+// incomplete and only tells the caller that it stopped.
+class ProgressToken {
+public:
+    static constexpr std::size_t kInterval = std::size_t{1} << 16;
+
+    ProgressToken() = default;
+    // on_progress runs on the reporting worker thread, possibly several at once.
+    explicit ProgressToken(std::function<void(double)> on_progress) : on_progress_(std::move(on_progress)) {}
+
+    ProgressToken(const ProgressToken&) = delete;
+    ProgressToken& operator=(const ProgressToken&) = delete;
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    // Fraction of the work done, in [0, 1]; never decreases.
+    double progress() const { return progress_.load(std::memory_order_relaxed); }
+
+    void report(double fraction) {
+        fraction = (fraction < 0.0) ? 0.0 : (fraction > 1.0 ? 1.0 : fraction);
+        double current = progress_.load(std::memory_order_relaxed);
+        while (current < fraction && !progress_.compare_exchange_weak(current, fraction, std::memory_order_relaxed)) {
+        }
+        if (current < fraction && on_progress_) {
+            on_progress_(fraction);
+        }
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<double> progress_{0.0};
+    std::function<void(double)> on_progress_;
+};
+
+// Null-tolerant helpers for the optional token pointers in option structs.
+inline bool is_cancelled(const ProgressToken* token) {
+    return token != nullptr && token->cancelled();
+}
+
+inline void report_progress(ProgressToken* token, std::size_t done, std::size_t total) {
+    if (token != nullptr && total > 0) {
+        token->report(static_cast<double>(done) / static_cast<double>(total));
+    }
+}
+
+} // namespace stockbt
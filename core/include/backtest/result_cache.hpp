@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+// Version of the backtest semantics behind cached metrics. Bump it with every change
+// that can alter Metrics for the same bars, parameters and settings; caches written by
+// another version are discarded on load.
+constexpr uint32_t kEngineVersion = 1;
+
+// Content hash of the fields a backtest reads (ts, open, close) and the row count.
+// Row and column storage of the same bars hash identically.
+uint64_t hash_series(CandleView candles);
+uint64_t hash_series(ColumnsView columns);
+
+// Metrics of finished SMA backtests keyed by dataset hash, parameters and settings, so
+// sweeps over overlapping grids only run the new cells. Not thread-safe; engines look
+// up and insert from the calling thread.
+class MetricsCache {
+public:
+    // Cached metrics, or nullptr; counts a hit or a miss.
+    const Metrics* find(uint64_t dataset, const SmaParams& params, const BacktestSettings& settings);
+    void insert(uint64_t dataset, const SmaParams& params, const BacktestSettings& settings, const Metrics& metrics);
+
+    std::size_t size() const { return entries_.size(); }
+    std::size_t hits() const { return hits_; }
+    std::size_t misses() const { return misses_; }
+    // Entries the last load dropped because they came from another engine version.
+    std::size_t discarded() const { return discarded_; }
+
+    // Replaces the entries with the file's; a missing file loads an empty cache.
+    bool load(const std::string& path, std::string* error);
+    bool save(const std::string& path, std::string* error) const;
+
+private:
+    struct Key {
+        uint64_t dataset;
+        uint64_t fast;
+        uint64_t slow;
+        uint64_t settings[5]; // bit patterns of the BacktestSettings fields
+
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    static Key make_key(uint64_t dataset, const SmaParams& params, const BacktestSettings& settings);
+
+    std::unordered_map<Key, Metrics, KeyHash> entries_;
+    std::size_t hits_{0};
+    std::size_t misses_{0};
+    std::size_t discarded_{0};
+};
+
+} // namespace stockbt
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+class WorkStealingPool;
+
+// Read-only store of simple moving averages of close, one vector per window,
+// built once per dataset and shared by every backtest over that dataset.
+// Values come from rolling_sma_batch (indicators.hpp), which uses the same rolling-sum
+// recurrence as run_sma_backtest, so cached and uncached runs are bit-identical.
+// Entries before index window - 1 are 0.
+class SmaCache {
+public:
+    SmaCache() = default;
+    SmaCache(CandleView candles, std::vector<std::size_t> windows, WorkStealingPool* pool = nullptr);
+    SmaCache(ColumnsView columns, std::vector<std::size_t> windows, WorkStealingPool* pool = nullptr);
+
+    std::size_t rows() const { return rows_; }
+    const std::vector<std::size_t>& windows() const { return windows_; }
+
+    // Returns the SMA vector for window, or nullptr when it was not precomputed.
+    const double* find(std::size_t window) const;
+
+private:
+    void build(const double* closes, std::vector<std::size_t> windows, WorkStealingPool* pool);
+
+    std::size_t rows_{0};
+    std::vector<std::size_t> windows_; // sorted, unique
+    std::vector<std::vector<double>> values_;
+};
+
+} // namespace stockbt
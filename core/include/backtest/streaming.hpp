@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+#include "backtest/csv_importer.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+struct StreamingBacktestOptions {
+    StreamImportOptions input;
+    // Written like export_equity_csv / export_trades_csv when not empty.
+    std::string equity_csv;
+    std::string trades_csv;
+};
+
+struct StreamingBacktestResult {
+    bool success{false};
+    std::string error;        // first import, parameter or export error when !success
+    StreamImportResult input; // bars read, dropped rows and import warnings
+    Metrics metrics;
+};
+
+// Backtests a dataset of any size: stream_ohlcv chunks feed an IncrementalSmaBacktest
+// whose trades and equity go straight to a StreamingCsvExporter, so memory is bounded
+// by the chunk buffer and the output blocks rather than the number of bars. Metrics and
+// exported files equal run_sma_backtest + export_*_csv over the imported dataset.
+StreamingBacktestResult run_streaming_sma_backtest(const std::string& path,
+                                                   DateFormat date_format,
+                                                   const SmaParams& params,
+                                                   const BacktestSettings& settings,
+                                                   const StreamingBacktestOptions& options);
+
+} // namespace stockbt
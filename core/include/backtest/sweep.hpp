@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "backtest/batch_backtester.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+class MetricsCache;
+
+struct SweepGrid {
+    std::size_t fast_min{5};
+    std::size_t fast_max{80};
+    std::size_t slow_min{20};
+    std::size_t slow_max{300};
+    std::size_t step{5};
+    // Optional extra grid axes; empty uses the BacktestSettings value.
+    std::vector<double> stop_loss_pcts;
+    std::vector<double> take_profit_pcts;
+};
+
+enum class SweepPruneReason {
+    None,
+    Drawdown, // train drawdown deeper than SweepPruning::max_drawdown_pct
+    Equity,   // train equity below SweepPruning::min_equity
+    Halving,  // ranked out by successive halving on a train prefix
+};
+
+const char* sweep_prune_reason_name(SweepPruneReason reason); // "", "drawdown", "equity", "halving"
+
+// Early termination of sweep cells on the train window. A pruned cell stops at the bar
+// that pruned it, keeps its train metrics up to that bar (an open position is closed
+// there) and skips the test run, so its test metrics keep their defaults. Cells that
+// are not pruned get exactly the metrics of an unpruned sweep.
+struct SweepPruning {
+    // Prune once the train drawdown is deeper than this many percent (25 = -25%); 0 disables.
+    double max_drawdown_pct{0.0};
+    // Prune once train equity falls below this; 0 disables.
+    double min_equity{0.0};
+    // Successive halving when > 0: cells are ranked (ranks_above) on train prefixes of
+    // n / 2^(rungs - 1), ..., n / 2 bars, and at each rung only the better half of the
+    // remaining cells continues, but never fewer than keep_top. Prefixes shorter than
+    // the largest slow window are skipped.
+    std::size_t keep_top{0};
+    std::size_t rungs{4};
+
+    bool enabled() const { return max_drawdown_pct > 0.0 || min_equity > 0.0 || keep_top > 0; }
+};
+
+// Deterministic partition of a sweep for running it on several machines: shard index
+// of count runs the configs whose enumerate_sweep_configs index i has
+// i % count == index, so every shard gets a similar mix of window lengths.
+struct SweepShard {
+    std::size_t index{0};
+    std::size_t count{1};
+
+    bool contains(std::size_t cell) const { return count <= 1 || cell % count == index; }
+};
+
+struct SweepOptions {
+    std::size_t threads{1}; // 0 = hardware concurrency
+    bool batch{true};       // run_sma_backtest_batch; false runs one backtest per cell
+    // With pruning enabled, train runs step every cell on SmaCache averages (batch then
+    // only applies to the test runs of the surviving cells).
+    SweepPruning pruning;
+    // Only this shard's configs run. Successive halving ranks the whole grid, so
+    // pruning.keep_top > 0 cannot be combined with shard.count > 1.
+    SweepShard shard;
+    // Progress over all train and test runs; a cancelled sweep leaves the metrics of
+    // unfinished cells at their defaults.
+    ProgressToken* progress{nullptr};
+    // Train and test metrics are looked up here before a cell runs, and the cells that
+    // ran are added unless the sweep was cancelled. Unused with pruning, whose metrics
+    // may cover only part of the train window.
+    MetricsCache* cache{nullptr};
+};
+
+struct SweepRow {
+    std::size_t cell{0}; // index in enumerate_sweep_configs order
+    std::size_t fast{0};
+    std::size_t slow{0};
+    double stop_loss_pct{0.0};
+    double take_profit_pct{0.0};
+    Metrics train;
+    Metrics test;
+    SweepPruneReason pruned{SweepPruneReason::None};
+    std::size_t pruned_at_bar{0}; // train bars run before the cell was pruned
+};
+
+// Valid (fast, slow) pairs of the grid in row-major order (fast outer, slow inner),
+// limited to windows that fit in both train and test lengths.
+std::vector<SmaParams> enumerate_sweep_cells(const SweepGrid& grid, std::size_t train_rows, std::size_t test_rows);
+
+// Every cell crossed with the stop-loss and take-profit axes (take-profit innermost).
+std::vector<BatchConfig> enumerate_sweep_configs(const SweepGrid& grid,
+                                                 const BacktestSettings& settings,
+                                                 std::size_t train_rows,
+                                                 std::size_t test_rows);
+
+// False, with a message, for options run_parameter_sweep refuses: successive halving
+// on a shard.
+bool check_sweep_options(const SweepOptions& options, std::string* error);
+
+// Runs every grid config of options.shard on train and test. Rows are returned in
+// enumerate_sweep_configs order regardless of thread count or path, so the report is
+// identical to a serial run. Returns no rows when check_sweep_options fails.
+std::vector<SweepRow> run_parameter_sweep(CandleView train,
+                                          CandleView test,
+                                          const SweepGrid& grid,
+                                          const BacktestSettings& settings,
+                                          const SweepOptions& options);
+
+// Column-storage (SoA) input, run without copying the windows; rows are identical to the
+// CandleView overload.
+std::vector<SweepRow> run_parameter_sweep(ColumnsView train,
+                                          ColumnsView test,
+                                          const SweepGrid& grid,
+                                          const BacktestSettings& settings,
+                                          const SweepOptions& options);
+
+// Reassembles the rows of every shard of a total_cells sweep in enumerate_sweep_configs
+// order; fails when a cell is missing, duplicated or out of range, or when more than
+// one shard has cells pruned by successive halving. sort_sweep_rows on the result
+// gives the report of a single-node run.
+bool merge_sweep_shards(const std::vector<std::vector<SweepRow>>& shards,
+                        std::size_t total_cells,
+                        std::vector<SweepRow>* rows,
+                        std::string* error);
+
+// In-sample ranking: higher return first, then the shallower max drawdown.
+bool ranks_above(const Metrics& a, const Metrics& b);
+
+// Report order: cells that were not pruned first, each group by ranks_above on the
+// train metrics.
+void sort_sweep_rows(std::vector<SweepRow>* rows);
+
+} // namespace stockbt
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stockbt {
+
+// Fixed-size pool that runs index ranges with work stealing: each worker owns a
+// contiguous slice of the range and, once it runs dry, steals the upper half of
+// the largest remaining slice from another worker.
+class WorkStealingPool {
+public:
+    // thread_count == 0 selects std::thread::hardware_concurrency().
+    explicit WorkStealingPool(std::size_t thread_count);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t thread_count() const { return queues_.size(); }
+
+    // Calls body(index, worker) for every index in [0, count) and blocks until all
+    // calls returned. worker is in [0, thread_count()) and identifies the executing
+    // thread (the caller participates as worker 0). body must not throw.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& body);
+
+private:
+    struct Slice {
+        std::mutex mutex;
+        std::size_t begin{0};
+        std::size_t end{0};
+    };
+
+    void worker_loop(std::size_t worker);
+    void drain(std::size_t worker);
+    bool pop_local(std::size_t worker, std::size_t* index);
+    bool steal(std::size_t worker);
+
+    std::vector<std::unique_ptr<Slice>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(std::size_t, std::size_t)>* body_{nullptr};
+    std::size_t generation_{0};
+    std::size_t remaining_{0};
+    std::size_t busy_workers_{0};
+    bool stopping_{false};
+};
+
+} // namespace stockbt
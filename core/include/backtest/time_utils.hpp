@@ -1,16 +1,55 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "backtest/types.hpp"
 
 namespace stockbt {
 
-std::optional<int64_t> parse_timestamp_utc(const std::string& text, DateFormat fmt);
-std::optional<int64_t> parse_date_time_utc_yyyymmdd_hhmmss(const std::string& date_text,
-                                                           const std::string& time_text);
+std::optional<int64_t> parse_timestamp_utc(std::string_view text, DateFormat fmt);
+std::optional<int64_t> parse_date_time_utc_yyyymmdd_hhmmss(std::string_view date_text, std::string_view time_text);
 std::string format_timestamp_utc_iso8601(int64_t ts);
 
+// Seconds since the Unix epoch for a proleptic Gregorian UTC date-time. Out-of-month
+// days and second 60 carry into the following day/minute, as timegm does.
+int64_t epoch_from_civil_utc(int64_t year, int month, int day, int hour, int minute, int second);
+
+// Per-file timestamp parser. The fixed layout (e.g. YYYY-MM-DD HH:MM:SS or
+// YYYYMMDD + HHMMSS) is detected once, from the first value that parses, and later
+// values are read by offset; values in any other layout fall back to the general parser.
+class TimestampParser {
+public:
+    explicit TimestampParser(DateFormat fmt) : fmt_(fmt) {}
+
+    std::optional<int64_t> parse(std::string_view text);
+    std::optional<int64_t> parse_date_time(std::string_view date_text, std::string_view time_text);
+
+private:
+    DateFormat fmt_;
+    int layout_{-1};
+    int date_layout_{-1};
+    int time_layout_{-1};
+};
+
+// Writes format_timestamp_utc_iso8601(ts) without allocating. The "YYYY-MM-DDT"
+// prefix of the latest day is cached, so consecutive bars of one day only format
+// the time of day. Timestamps outside years 0..9999 use the general formatter.
+class TimestampFormatter {
+public:
+    static constexpr std::size_t kMaxLength = 32;
+
+    // Writes at most kMaxLength characters at out and returns the end of the text.
+    char* format_iso8601(int64_t ts, char* out);
+
+private:
+    int64_t day_{0};
+    bool has_day_{false};
+    bool day_in_range_{false};
+    char prefix_[11]{};
+};
+
 } // namespace stockbt
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cstddef>
 #include <string>
@@ -24,6 +25,167 @@ struct Candle {
 
 using Series = std::vector<Candle>;
 
+// Non-owning view over contiguous candles (std::span<const Candle> stand-in for C++17).
+// Implicitly built from a Series so window splits and folds can be passed without copying.
+class CandleView {
+public:
+    CandleView() = default;
+    CandleView(const Candle* data, std::size_t size) : data_(data), size_(size) {}
+    CandleView(const Series& series) : data_(series.data()), size_(series.size()) {}
+
+    const Candle* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const Candle* begin() const { return data_; }
+    const Candle* end() const { return data_ + size_; }
+    const Candle& operator[](std::size_t i) const { return data_[i]; }
+    const Candle& front() const { return data_[0]; }
+    const Candle& back() const { return data_[size_ - 1]; }
+
+    // Candles [offset, offset + count), clamped to the view.
+    CandleView subview(std::size_t offset, std::size_t count = static_cast<std::size_t>(-1)) const {
+        if (offset > size_) {
+            offset = size_;
+        }
+        if (count > size_ - offset) {
+            count = size_ - offset;
+        }
+        return CandleView(data_ + offset, count);
+    }
+
+private:
+    const Candle* data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Structure-of-arrays candles: one contiguous array per column, so passes that read a
+// single field (closes for indicators, opens on fills) stream only that field.
+struct SeriesColumns {
+    std::vector<int64_t> ts;
+    std::vector<double> o;
+    std::vector<double> h;
+    std::vector<double> l;
+    std::vector<double> c;
+    std::vector<double> v;
+
+    std::size_t size() const { return ts.size(); }
+    bool empty() const { return ts.empty(); }
+
+    void resize(std::size_t n) {
+        ts.resize(n);
+        o.resize(n);
+        h.resize(n);
+        l.resize(n);
+        c.resize(n);
+        v.resize(n);
+    }
+
+    void reserve(std::size_t n) {
+        ts.reserve(n);
+        o.reserve(n);
+        h.reserve(n);
+        l.reserve(n);
+        c.reserve(n);
+        v.reserve(n);
+    }
+
+    void push_back(const Candle& candle) {
+        ts.push_back(candle.ts);
+        o.push_back(candle.o);
+        h.push_back(candle.h);
+        l.push_back(candle.l);
+        c.push_back(candle.c);
+        v.push_back(candle.v);
+    }
+
+    void set(std::size_t i, const Candle& candle) {
+        ts[i] = candle.ts;
+        o[i] = candle.o;
+        h[i] = candle.h;
+        l[i] = candle.l;
+        c[i] = candle.c;
+        v[i] = candle.v;
+    }
+};
+
+// Non-owning SoA counterpart of CandleView. All column pointers cover size() rows.
+class ColumnsView {
+public:
+    ColumnsView() = default;
+    ColumnsView(const int64_t* ts,
+                const double* o,
+                const double* h,
+                const double* l,
+                const double* c,
+                const double* v,
+                std::size_t size)
+        : ts_(ts), o_(o), h_(h), l_(l), c_(c), v_(v), size_(size) {}
+    ColumnsView(const SeriesColumns& columns)
+        : ColumnsView(columns.ts.data(),
+                      columns.o.data(),
+                      columns.h.data(),
+                      columns.l.data(),
+                      columns.c.data(),
+                      columns.v.data(),
+                      columns.size()) {}
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const int64_t* ts() const { return ts_; }
+    const double* o() const { return o_; }
+    const double* h() const { return h_; }
+    const double* l() const { return l_; }
+    const double* c() const { return c_; }
+    const double* v() const { return v_; }
+
+    Candle operator[](std::size_t i) const { return Candle{ts_[i], o_[i], h_[i], l_[i], c_[i], v_[i]}; }
+
+    // Rows [offset, offset + count), clamped to the view.
+    ColumnsView subview(std::size_t offset, std::size_t count = static_cast<std::size_t>(-1)) const {
+        if (offset > size_) {
+            offset = size_;
+        }
+        if (count > size_ - offset) {
+            count = size_ - offset;
+        }
+        return ColumnsView(ts_ + offset, o_ + offset, h_ + offset, l_ + offset, c_ + offset, v_ + offset, count);
+    }
+
+private:
+    const int64_t* ts_{nullptr};
+    const double* o_{nullptr};
+    const double* h_{nullptr};
+    const double* l_{nullptr};
+    const double* c_{nullptr};
+    const double* v_{nullptr};
+    std::size_t size_{0};
+};
+
+inline SeriesColumns to_columns(CandleView candles) {
+    SeriesColumns columns;
+    columns.resize(candles.size());
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        columns.set(i, candles[i]);
+    }
+    return columns;
+}
+
+inline Series to_series(ColumnsView columns) {
+    Series series(columns.size());
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        series[i] = columns[i];
+    }
+    return series;
+}
+
+// Which container import fills: ImportResult::candles (rows) or ImportResult::columns.
+enum class SeriesLayout {
+    Rows,
+    Columns,
+};
+
 struct Trade {
     int64_t entry_time{0};
     double entry_price{0.0};
@@ -60,18 +222,97 @@ struct SmaParams {
     }
 };
 
+struct BreakoutParams {
+    std::size_t entry_window{20}; // enter above the highest high of the previous entry_window bars
+    std::size_t exit_window{10};  // exit below the lowest low of the previous exit_window bars
+
+    bool is_valid() const { return entry_window > 0 && exit_window > 0; }
+};
+
 struct ImportIssue {
     std::size_t line{0};
     std::string message;
 };
 
+// Why the importer dropped a data row; indexes ImportStats::dropped_by_reason.
+enum class RowDropReason {
+    MissingFields,
+    InvalidTimestamp,
+    InvalidNumber,
+    NonPositivePrice,
+    NegativeVolume,
+};
+
+constexpr std::size_t kRowDropReasons = 5;
+
+// Dropped rows as exact counts per reason plus the line numbers of the first few drops
+// of each reason (ImportOptions::issue_samples), so a dirty file costs no more memory
+// than a clean one. describe_row_issues (csv_importer.hpp) rebuilds the messages.
+struct RowIssueSummary {
+    std::array<std::size_t, kRowDropReasons> counts{};
+    std::array<std::vector<std::size_t>, kRowDropReasons> sample_lines; // ascending
+
+    std::size_t count(RowDropReason reason) const { return counts[static_cast<std::size_t>(reason)]; }
+    std::size_t total() const {
+        std::size_t sum = 0;
+        for (std::size_t count : counts) {
+            sum += count;
+        }
+        return sum;
+    }
+
+    // Keeps the first `samples` lines of each reason, as an import with that
+    // issue_samples would have; true when any were dropped.
+    bool limit_samples(std::size_t samples) {
+        bool cut = false;
+        for (std::vector<std::size_t>& lines : sample_lines) {
+            if (lines.size() > samples) {
+                lines.resize(samples);
+                cut = true;
+            }
+        }
+        return cut;
+    }
+};
+
+// Instrumentation (see stats.hpp for formatting). Only collected when core is built
+// with STOCKBT_INSTRUMENTATION on, the default; otherwise collected stays false and
+// every other field keeps its default.
+struct ImportStats {
+    bool collected{false};
+    bool from_cache{false};     // loaded from a .sbt file instead of parsing
+    std::size_t rows_parsed{0}; // non-blank data lines
+    std::array<std::size_t, kRowDropReasons> dropped_by_reason{};
+    bool sorted{false};         // rows arrived out of order
+    std::size_t duplicates_removed{0};
+    double parse_ms{0.0};
+    double sort_ms{0.0};        // sort and dedupe
+    double total_ms{0.0};
+
+    std::size_t dropped(RowDropReason reason) const { return dropped_by_reason[static_cast<std::size_t>(reason)]; }
+};
+
+struct BacktestStats {
+    bool collected{false};
+    std::size_t bars{0};
+    std::size_t trades{0};
+    double elapsed_ms{0.0};
+
+    double bars_per_sec() const { return (elapsed_ms > 0.0) ? static_cast<double>(bars) * 1000.0 / elapsed_ms : 0.0; }
+};
+
 struct ImportResult {
     bool success{false};
     bool partial_success{false};
     std::size_t dropped_rows{0};
-    Series candles;
+    Series candles;         // filled for SeriesLayout::Rows
+    SeriesColumns columns;  // filled instead for SeriesLayout::Columns
+    // Row drops appear here as describe_row_issues(row_issues): the sampled lines and
+    // one line per reason with the rows not listed.
     std::vector<ImportIssue> warnings;
     std::vector<ImportIssue> errors;
+    RowIssueSummary row_issues;
+    ImportStats stats;
 };
 
 struct BacktestResult {
@@ -80,6 +321,7 @@ struct BacktestResult {
     std::vector<Trade> trades;
     Metrics metrics;
     std::vector<std::string> warnings;
+    BacktestStats stats;
 };
 
 struct DatasetMetadata {
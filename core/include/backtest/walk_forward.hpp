@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "backtest/batch_backtester.hpp"
+#include "backtest/sweep.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+enum class WalkForwardMode {
+    Rolling,  // fixed-length train window that moves with the test window
+    Anchored, // train window always starts at bar 0 and grows by step_bars per fold
+};
+
+struct WalkForwardOptions {
+    WalkForwardMode mode{WalkForwardMode::Rolling};
+    std::size_t train_bars{0};
+    std::size_t test_bars{0};
+    std::size_t step_bars{0}; // 0 = test_bars (back-to-back test windows)
+    std::size_t threads{1};   // 0 = hardware concurrency
+    // Fold train metrics are looked up here before the grid runs and added after.
+    MetricsCache* cache{nullptr};
+};
+
+// Bar ranges [begin, end) of one fold; the test window starts where training ends.
+struct WalkForwardFold {
+    std::size_t train_begin{0};
+    std::size_t train_end{0};
+    std::size_t test_begin{0};
+    std::size_t test_end{0};
+};
+
+struct WalkForwardFoldResult {
+    WalkForwardFold fold;
+    bool has_best{false}; // false when no grid config fits the fold
+    BatchConfig best;     // highest-ranked (ranks_above) train config
+    Metrics train;
+    Metrics test;
+};
+
+struct WalkForwardResult {
+    std::vector<WalkForwardFoldResult> folds;
+    // Out-of-sample equity of all folds chained into one account. Each fold's
+    // segment runs from starting_cash and is rescaled by the equity carried over, so
+    // returns compound. When step_bars < test_bars a segment ends where the next
+    // fold's test window begins; folds without a best config hold the equity flat.
+    std::vector<int64_t> oos_ts;
+    std::vector<double> oos_equity;
+    Metrics oos;
+};
+
+// Folds with complete train and test windows, in time order.
+std::vector<WalkForwardFold> enumerate_walk_forward_folds(std::size_t rows, const WalkForwardOptions& options);
+
+// Runs the grid (enumerate_sweep_configs) on every fold's train window, picks the best
+// config per fold and stitches its out-of-sample segments. The train grids of all folds
+// are scheduled as batch blocks on one pool over zero-copy subviews of data, and the
+// result is identical for every thread count.
+WalkForwardResult run_walk_forward(ColumnsView data,
+                                   const SweepGrid& grid,
+                                   const BacktestSettings& settings,
+                                   const WalkForwardOptions& options);
+
+} // namespace stockbt
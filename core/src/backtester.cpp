@@ -1,230 +1,303 @@
 #include "backtest/backtester.hpp"
 
-#include <algorithm>
-#include <cmath>
-#include <limits>
-#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "backtest/engine.hpp"
+#include "backtest/indicators.hpp"
+#include "backtest/sma_cache.hpp"
+#include "instrumentation.hpp"
+#include "sma_cross.hpp"
 
 namespace stockbt {
 namespace {
 
-enum class PendingAction {
-    None,
-    Buy,
-    Sell,
-};
+// Maintains the fast/slow rolling sums inside the backtest loop.
+template <typename Bars>
+class RollingSma {
+public:
+    RollingSma(const Bars& bars, const SmaParams& params) : bars_(bars), params_(params) {}
 
-double clamp01(double value) {
-    if (value < 0.0) {
-        return 0.0;
-    }
-    if (value > 1.0) {
-        return 1.0;
+    void advance(std::size_t i) {
+        fast_sum_ += bars_.close(i);
+        slow_sum_ += bars_.close(i);
+        if (i >= params_.fast_window) {
+            fast_sum_ -= bars_.close(i - params_.fast_window);
+        }
+        if (i >= params_.slow_window) {
+            slow_sum_ -= bars_.close(i - params_.slow_window);
+        }
     }
-    return value;
-}
 
-} // namespace
+    double fast() const { return fast_sum_ / static_cast<double>(params_.fast_window); }
+    double slow() const { return slow_sum_ / static_cast<double>(params_.slow_window); }
 
-BacktestResult run_sma_backtest(const Series& candles,
-                                const SmaParams& params,
-                                const BacktestSettings& settings) {
-    BacktestResult result;
-    if (candles.empty()) {
-        result.warnings.push_back("Backtest skipped: empty dataset.");
-        return result;
-    }
-    if (!params.is_valid()) {
-        result.warnings.push_back("Backtest skipped: invalid SMA parameters (require fast < slow and > 0).");
-        return result;
-    }
-
-    const std::size_t n = candles.size();
-    result.equity.assign(n, settings.starting_cash);
-    result.drawdown.assign(n, 0.0);
+private:
+    const Bars& bars_;
+    const SmaParams& params_;
+    double fast_sum_{0.0};
+    double slow_sum_{0.0};
+};
 
-    if (n < params.slow_window) {
-        result.warnings.push_back("Dataset length is below slow_window. No signals/trades generated.");
+// Channel breakout: enter when the close exceeds the highest high of the previous
+// entry_window bars, exit when it falls below the lowest low of the previous
+// exit_window bars. Channels are precomputed with rolling_max / rolling_min into
+// caller-owned buffers.
+template <typename Bars>
+class BreakoutStrategy {
+public:
+    BreakoutStrategy(const Bars& bars,
+                     const double* highs,
+                     const double* lows,
+                     const BreakoutParams& params,
+                     std::vector<double>* upper,
+                     std::vector<double>* lower)
+        : bars_(bars), params_(params), upper_(*upper), lower_(*lower) {
+        if (params_.is_valid()) {
+            upper_.resize(bars.size());
+            lower_.resize(bars.size());
+            rolling_max(highs, bars.size(), params_.entry_window, upper_.data());
+            rolling_min(lows, bars.size(), params_.exit_window, lower_.data());
+        }
     }
 
-    double cash = settings.starting_cash;
-    int qty = 0;
-    const double position_size_pct = clamp01(settings.position_size_pct);
-    const bool stop_loss_enabled = settings.stop_loss_pct > 0.0;
-    const bool take_profit_enabled = settings.take_profit_pct > 0.0;
-
-    int64_t open_entry_time = 0;
-    double open_entry_price = 0.0;
-
-    PendingAction pending = PendingAction::None;
-
-    double fast_sum = 0.0;
-    double slow_sum = 0.0;
-    double prev_fast = 0.0;
-    double prev_slow = 0.0;
-    bool prev_valid = false;
-
-    for (std::size_t i = 0; i < n; ++i) {
-        const Candle& bar = candles[i];
-
-        if (pending == PendingAction::Buy) {
-            const double entry_price = bar.o;
-            const double denom = entry_price * (1.0 + settings.commission_pct);
-            const double budget = cash * position_size_pct;
-            const int buy_qty = (denom > 0.0) ? static_cast<int>(std::floor(budget / denom)) : 0;
-            if (buy_qty > 0) {
-                const double cost = static_cast<double>(buy_qty) * entry_price;
-                const double commission = cost * settings.commission_pct;
-                cash -= (cost + commission);
-                qty = buy_qty;
-                open_entry_time = bar.ts;
-                open_entry_price = entry_price;
-            }
-            pending = PendingAction::None;
-        } else if (pending == PendingAction::Sell) {
-            if (qty > 0) {
-                const double exit_price = bar.o;
-                const double proceeds = static_cast<double>(qty) * exit_price;
-                const double commission = proceeds * settings.commission_pct;
-                cash += (proceeds - commission);
-
-                Trade trade;
-                trade.entry_time = open_entry_time;
-                trade.entry_price = open_entry_price;
-                trade.exit_time = bar.ts;
-                trade.exit_price = exit_price;
-                trade.qty = qty;
-                trade.pnl = (exit_price - open_entry_price) * static_cast<double>(qty) -
-                            (open_entry_price * static_cast<double>(qty) * settings.commission_pct) -
-                            (exit_price * static_cast<double>(qty) * settings.commission_pct);
-                trade.return_pct = (open_entry_price > 0.0) ? ((exit_price - open_entry_price) / open_entry_price) : 0.0;
-                result.trades.push_back(trade);
-                qty = 0;
-                open_entry_time = 0;
-                open_entry_price = 0.0;
-            }
-            pending = PendingAction::None;
-        }
+    const char* invalid_reason() const {
+        return params_.is_valid() ? nullptr : "Backtest skipped: invalid breakout parameters (require windows > 0).";
+    }
+    std::size_t warmup_bars() const { return params_.entry_window + 1; }
+    const char* short_data_warning() const {
+        return "Dataset length is below entry_window + 1. No signals/trades generated.";
+    }
 
-        fast_sum += bar.c;
-        slow_sum += bar.c;
-        if (i >= params.fast_window) {
-            fast_sum -= candles[i - params.fast_window].c;
+    Signal on_bar(std::size_t i) {
+        const double close = bars_.close(i);
+        if (i >= params_.entry_window && close > upper_[i - 1]) {
+            return Signal::Enter;
         }
-        if (i >= params.slow_window) {
-            slow_sum -= candles[i - params.slow_window].c;
+        if (i >= params_.exit_window && close < lower_[i - 1]) {
+            return Signal::Exit;
         }
+        return Signal::None;
+    }
 
-        const bool fast_valid = i + 1 >= params.fast_window;
-        const bool slow_valid = i + 1 >= params.slow_window;
-
-        if (fast_valid && slow_valid) {
-            const double fast = fast_sum / static_cast<double>(params.fast_window);
-            const double slow = slow_sum / static_cast<double>(params.slow_window);
-
-            if (prev_valid) {
-                const bool cross_up = (prev_fast <= prev_slow) && (fast > slow);
-                const bool cross_down = (prev_fast >= prev_slow) && (fast < slow);
-
-                if (cross_up && qty == 0 && pending == PendingAction::None) {
-                    if (i + 1 < n) {
-                        pending = PendingAction::Buy;
-                    } else {
-                        result.warnings.push_back("Last bar signal discarded (no next bar for execution).");
-                    }
-                } else if (cross_down && qty > 0 && pending == PendingAction::None) {
-                    if (i + 1 < n) {
-                        pending = PendingAction::Sell;
-                    } else {
-                        result.warnings.push_back("Last bar signal discarded (no next bar for execution).");
-                    }
-                }
-            }
-
-            prev_fast = fast;
-            prev_slow = slow;
-            prev_valid = true;
-        }
+private:
+    const Bars& bars_;
+    const BreakoutParams& params_;
+    std::vector<double>& upper_;
+    std::vector<double>& lower_;
+};
 
-        if (qty > 0 && pending == PendingAction::None) {
-            const double bar_return = (open_entry_price > 0.0) ? ((bar.c - open_entry_price) / open_entry_price) : 0.0;
-            if (stop_loss_enabled && bar_return <= -settings.stop_loss_pct) {
-                if (i + 1 < n) {
-                    pending = PendingAction::Sell;
-                    result.warnings.push_back("Stop-loss triggered; exit scheduled on next bar open.");
-                } else {
-                    result.warnings.push_back("Stop-loss triggered on last bar; exiting at final close.");
-                }
-            } else if (take_profit_enabled && bar_return >= settings.take_profit_pct) {
-                if (i + 1 < n) {
-                    pending = PendingAction::Sell;
-                    result.warnings.push_back("Take-profit triggered; exit scheduled on next bar open.");
-                } else {
-                    result.warnings.push_back("Take-profit triggered on last bar; exiting at final close.");
-                }
-            }
-        }
+bool cache_covers(const SmaCache* cache, std::size_t rows, const SmaParams& params) {
+    return cache != nullptr && cache->rows() == rows && cache->find(params.fast_window) != nullptr &&
+           cache->find(params.slow_window) != nullptr;
+}
 
-        result.equity[i] = cash + static_cast<double>(qty) * bar.c;
+template <typename Bars, typename Recorder>
+void dispatch_sma(const Bars& bars,
+                  const SmaParams& params,
+                  const BacktestSettings& settings,
+                  const BacktestContext& context,
+                  Recorder& recorder) {
+    if (cache_covers(context.sma_cache, bars.size(), params)) {
+        CachedSma sma(context.sma_cache->find(params.fast_window), context.sma_cache->find(params.slow_window));
+        SmaCrossStrategy<CachedSma> strategy(sma, params);
+        run_strategy(bars, strategy, settings, recorder, context.progress);
+        return;
     }
+    RollingSma<Bars> sma(bars, params);
+    SmaCrossStrategy<RollingSma<Bars>> strategy(sma, params);
+    run_strategy(bars, strategy, settings, recorder, context.progress);
+}
 
-    if (qty > 0) {
-        const Candle& last = candles.back();
-        const double exit_price = last.c;
-        const double proceeds = static_cast<double>(qty) * exit_price;
-        const double commission = proceeds * settings.commission_pct;
-        cash += (proceeds - commission);
-
-        Trade trade;
-        trade.entry_time = open_entry_time;
-        trade.entry_price = open_entry_price;
-        trade.exit_time = last.ts;
-        trade.exit_price = exit_price;
-        trade.qty = qty;
-        trade.pnl = (exit_price - open_entry_price) * static_cast<double>(qty) -
-                    (open_entry_price * static_cast<double>(qty) * settings.commission_pct) -
-                    (exit_price * static_cast<double>(qty) * settings.commission_pct);
-        trade.return_pct = (open_entry_price > 0.0) ? ((exit_price - open_entry_price) / open_entry_price) : 0.0;
-        result.trades.push_back(trade);
-
-        qty = 0;
-        result.equity.back() = cash;
-        result.warnings.push_back("Open position force-closed at last bar close.");
+// Closes of bars as a contiguous array; row storage is copied into *scratch.
+const double* close_array(CandleView candles, std::vector<double>* scratch) {
+    scratch->resize(candles.size());
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        (*scratch)[i] = candles[i].c;
     }
+    return scratch->data();
+}
 
-    double peak = -std::numeric_limits<double>::infinity();
-    double min_dd = 0.0;
-    for (std::size_t i = 0; i < result.equity.size(); ++i) {
-        peak = std::max(peak, result.equity[i]);
-        const double dd = (peak > 0.0) ? (result.equity[i] - peak) / peak : 0.0;
-        result.drawdown[i] = dd;
-        min_dd = std::min(min_dd, dd);
-    }
+const double* close_array(ColumnsView columns, std::vector<double>*) { return columns.c(); }
 
-    const double final_equity = result.equity.empty() ? settings.starting_cash : result.equity.back();
-    result.metrics.total_pnl = final_equity - settings.starting_cash;
-    result.metrics.total_return_pct = (settings.starting_cash != 0.0)
-                                          ? (result.metrics.total_pnl / settings.starting_cash) * 100.0
-                                          : 0.0;
-    result.metrics.trades = static_cast<int>(result.trades.size());
-
-    int wins = 0;
-    double sum_returns = 0.0;
-    for (const Trade& trade : result.trades) {
-        if (trade.pnl > 0.0) {
-            ++wins;
-        }
-        sum_returns += trade.return_pct;
+// Empties a recycled result without releasing its buffers.
+void reset_result(BacktestResult* result) {
+    result->equity.clear();
+    result->drawdown.clear();
+    result->trades.clear();
+    result->warnings.clear();
+    result->metrics = Metrics{};
+    result->stats = BacktestStats{};
+}
+
+// Without a usable cache, a run on a caller's workspace precomputes both averages with
+// the indicator kernels (same values as an SmaCache) into its scratch, which later runs
+// reuse. A run on a throwaway workspace keeps the in-loop recurrence rather than
+// allocating per-bar averages (and, for row storage, a copy of the closes) it would
+// use only once.
+template <typename View, typename Bars>
+void run_full_backtest(View view,
+                       const Bars& bars,
+                       const SmaParams& params,
+                       const BacktestSettings& settings,
+                       const BacktestContext& context,
+                       BacktestWorkspace* workspace,
+                       bool reused_workspace) {
+    FullRecorder recorder(&workspace->result);
+    if (reused_workspace && !cache_covers(context.sma_cache, bars.size(), params) && params.is_valid() &&
+        bars.size() > 0) {
+        std::vector<double>& fast = workspace->scratch[0];
+        std::vector<double>& slow = workspace->scratch[1];
+        fast.resize(bars.size());
+        slow.resize(bars.size());
+        const double* closes = close_array(view, &workspace->scratch[2]);
+        const std::size_t windows[2] = {params.fast_window, params.slow_window};
+        double* const out[2] = {fast.data(), slow.data()};
+        rolling_sma_batch(closes, bars.size(), windows, 2, out);
+        CachedSma sma(fast.data(), slow.data());
+        SmaCrossStrategy<CachedSma> strategy(sma, params);
+        run_strategy(bars, strategy, settings, recorder, context.progress);
+        return;
     }
-    result.metrics.win_rate_pct = result.trades.empty()
-                                      ? 0.0
-                                      : (static_cast<double>(wins) / static_cast<double>(result.trades.size())) * 100.0;
-    result.metrics.avg_trade_return_pct = result.trades.empty()
-                                              ? 0.0
-                                              : (sum_returns / static_cast<double>(result.trades.size())) * 100.0;
-    result.metrics.max_drawdown_pct = min_dd * 100.0;
+    dispatch_sma(bars, params, settings, context, recorder);
+}
 
+// Runs a full backtest into workspace->result and, in instrumented builds, fills its
+// stats.
+template <typename Run>
+const BacktestResult& timed_backtest(std::size_t bars, BacktestWorkspace* workspace, Run run) {
+    BacktestResult& result = workspace->result;
+    reset_result(&result);
+    double elapsed_ms = 0.0;
+    {
+        STOCKBT_TIME_SCOPE(&elapsed_ms);
+        run();
+    }
+    STOCKBT_STATS(result.stats.collected = true);
+    STOCKBT_STATS(result.stats.bars = bars);
+    STOCKBT_STATS(result.stats.trades = result.trades.size());
+    STOCKBT_STATS(result.stats.elapsed_ms = elapsed_ms);
     return result;
 }
 
+} // namespace
+
+BacktestResult run_sma_backtest(CandleView candles,
+                                const SmaParams& params,
+                                const BacktestSettings& settings) {
+    return run_sma_backtest(candles, params, settings, BacktestContext{});
+}
+
+BacktestResult run_sma_backtest(CandleView candles,
+                                const SmaParams& params,
+                                const BacktestSettings& settings,
+                                const BacktestContext& context) {
+    BacktestWorkspace workspace;
+    timed_backtest(candles.size(), &workspace, [&]() {
+        run_full_backtest(candles, RowBars(candles), params, settings, context, &workspace, false);
+    });
+    return std::move(workspace.result);
+}
+
+BacktestResult run_sma_backtest(ColumnsView columns,
+                                const SmaParams& params,
+                                const BacktestSettings& settings,
+                                const BacktestContext& context) {
+    BacktestWorkspace workspace;
+    timed_backtest(columns.size(), &workspace, [&]() {
+        run_full_backtest(columns, ColumnBars(columns), params, settings, context, &workspace, false);
+    });
+    return std::move(workspace.result);
+}
+
+const BacktestResult& run_sma_backtest(CandleView candles,
+                                       const SmaParams& params,
+                                       const BacktestSettings& settings,
+                                       const BacktestContext& context,
+                                       BacktestWorkspace* workspace) {
+    return timed_backtest(candles.size(), workspace, [&]() {
+        run_full_backtest(candles, RowBars(candles), params, settings, context, workspace, true);
+    });
+}
+
+const BacktestResult& run_sma_backtest(ColumnsView columns,
+                                       const SmaParams& params,
+                                       const BacktestSettings& settings,
+                                       const BacktestContext& context,
+                                       BacktestWorkspace* workspace) {
+    return timed_backtest(columns.size(), workspace, [&]() {
+        run_full_backtest(columns, ColumnBars(columns), params, settings, context, workspace, true);
+    });
+}
+
+Metrics run_sma_backtest_metrics(CandleView candles,
+                                 const SmaParams& params,
+                                 const BacktestSettings& settings,
+                                 const BacktestContext& context) {
+    Metrics metrics;
+    MetricsRecorder recorder(&metrics);
+    dispatch_sma(RowBars(candles), params, settings, context, recorder);
+    return metrics;
+}
+
+Metrics run_sma_backtest_metrics(ColumnsView columns,
+                                 const SmaParams& params,
+                                 const BacktestSettings& settings,
+                                 const BacktestContext& context) {
+    Metrics metrics;
+    MetricsRecorder recorder(&metrics);
+    dispatch_sma(ColumnBars(columns), params, settings, context, recorder);
+    return metrics;
+}
+
+BacktestResult run_breakout_backtest(CandleView candles,
+                                     const BreakoutParams& params,
+                                     const BacktestSettings& settings) {
+    BacktestWorkspace workspace;
+    run_breakout_backtest(candles, params, settings, &workspace);
+    return std::move(workspace.result);
+}
+
+BacktestResult run_breakout_backtest(ColumnsView columns,
+                                     const BreakoutParams& params,
+                                     const BacktestSettings& settings) {
+    BacktestWorkspace workspace;
+    run_breakout_backtest(columns, params, settings, &workspace);
+    return std::move(workspace.result);
+}
+
+const BacktestResult& run_breakout_backtest(CandleView candles,
+                                            const BreakoutParams& params,
+                                            const BacktestSettings& settings,
+                                            BacktestWorkspace* workspace) {
+    std::vector<double>& highs = workspace->scratch[2];
+    std::vector<double>& lows = workspace->scratch[3];
+    highs.resize(candles.size());
+    lows.resize(candles.size());
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        highs[i] = candles[i].h;
+        lows[i] = candles[i].l;
+    }
+    const RowBars bars(candles);
+    return timed_backtest(candles.size(), workspace, [&]() {
+        BreakoutStrategy<RowBars> strategy(
+            bars, highs.data(), lows.data(), params, &workspace->scratch[0], &workspace->scratch[1]);
+        FullRecorder recorder(&workspace->result);
+        run_strategy(bars, strategy, settings, recorder);
+    });
+}
+
+const BacktestResult& run_breakout_backtest(ColumnsView columns,
+                                            const BreakoutParams& params,
+                                            const BacktestSettings& settings,
+                                            BacktestWorkspace* workspace) {
+    const ColumnBars bars(columns);
+    return timed_backtest(columns.size(), workspace, [&]() {
+        BreakoutStrategy<ColumnBars> strategy(
+            bars, columns.h(), columns.l(), params, &workspace->scratch[0], &workspace->scratch[1]);
+        FullRecorder recorder(&workspace->result);
+        run_strategy(bars, strategy, settings, recorder);
+    });
+}
+
 } // namespace stockbt
@@ -0,0 +1,367 @@
+#include "backtest/batch_backtester.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "backtest/engine.hpp"
+#include "backtest/indicators.hpp"
+#include "backtest/progress.hpp"
+#include "backtest/thread_pool.hpp"
+
+namespace stockbt {
+namespace {
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STOCKBT_BATCH_AVX2 1
+#endif
+
+constexpr std::size_t L = kBatchLanes;
+
+// Per-lane replica of SmaCrossStrategy<RollingSma>, ExecutionCore and MetricsRecorder.
+// Each lane keeps the single run's operation order, so it reproduces
+// run_sma_backtest_metrics bit for bit; the per-bar updates are written as selects
+// over fixed-size lane arrays so the compiler vectorizes them across configs.
+// Padding lanes repeat lane 0. Flags are 64-bit so masks line up with the doubles.
+constexpr int64_t kNone = 0;
+constexpr int64_t kBuy = 1;
+constexpr int64_t kSell = 2;
+
+struct LaneBlock {
+    int64_t fast_window[L];
+    int64_t slow_window[L];
+    int64_t warmup[L];
+    double fast_divisor[L];
+    double slow_divisor[L];
+    double stop_loss_pct[L];
+    double take_profit_pct[L];
+    int64_t stop_loss_enabled[L];
+    int64_t take_profit_enabled[L];
+
+    double fast_sum[L];
+    double slow_sum[L];
+    double prev_fast[L];
+    double prev_slow[L];
+    int64_t prev_valid[L];
+    int64_t signal[L];
+
+    double cash[L];
+    double qty[L]; // whole shares; double because AVX2 cannot convert int64 lanes
+    int64_t entry_time[L];
+    double entry_price[L];
+    int64_t pending[L];
+
+    TradeTally tally[L];
+    double peak[L];
+    double min_dd[L];
+    double last[L];
+};
+
+void init_block(LaneBlock* block, const BatchConfig* const* configs, const BacktestSettings& settings) {
+    for (std::size_t k = 0; k < L; ++k) {
+        const BatchConfig& config = *configs[k];
+        block->fast_window[k] = static_cast<int64_t>(config.params.fast_window);
+        block->slow_window[k] = static_cast<int64_t>(config.params.slow_window);
+        block->warmup[k] = static_cast<int64_t>(std::max(config.params.fast_window, config.params.slow_window));
+        block->fast_divisor[k] = static_cast<double>(config.params.fast_window);
+        block->slow_divisor[k] = static_cast<double>(config.params.slow_window);
+        block->stop_loss_pct[k] = config.stop_loss_pct;
+        block->take_profit_pct[k] = config.take_profit_pct;
+        block->stop_loss_enabled[k] = config.stop_loss_pct > 0.0;
+        block->take_profit_enabled[k] = config.take_profit_pct > 0.0;
+
+        block->fast_sum[k] = 0.0;
+        block->slow_sum[k] = 0.0;
+        block->prev_fast[k] = 0.0;
+        block->prev_slow[k] = 0.0;
+        block->prev_valid[k] = 0;
+        block->signal[k] = 0;
+
+        block->cash[k] = settings.starting_cash;
+        block->qty[k] = 0.0;
+        block->entry_time[k] = 0;
+        block->entry_price[k] = 0.0;
+        block->pending[k] = kNone;
+
+        block->tally[k] = TradeTally{};
+        block->peak[k] = -std::numeric_limits<double>::infinity();
+        block->min_dd[k] = 0.0;
+        block->last[k] = 0.0;
+    }
+}
+
+// Shared inputs of one block pass; the columns are the caller's (sub)view.
+struct BlockInput {
+    const int64_t* ts;
+    const double* o;
+    const double* c;
+    std::size_t n;
+    double commission_pct;
+    double position_size_pct;
+};
+
+// Orders scheduled on the previous bar. Rare, so this stays a plain branchy loop.
+inline void fill_pending(const BlockInput& in, std::size_t i, LaneBlock* b) {
+    const double open = in.o[i];
+    for (std::size_t k = 0; k < L; ++k) {
+        if (b->pending[k] == kBuy) {
+            const double denom = open * (1.0 + in.commission_pct);
+            const double budget = b->cash[k] * in.position_size_pct;
+            const int buy_qty = (denom > 0.0) ? static_cast<int>(std::floor(budget / denom)) : 0;
+            if (buy_qty > 0) {
+                const double cost = static_cast<double>(buy_qty) * open;
+                const double commission = cost * in.commission_pct;
+                b->cash[k] -= (cost + commission);
+                b->qty[k] = static_cast<double>(buy_qty);
+                b->entry_time[k] = in.ts[i];
+                b->entry_price[k] = open;
+            }
+        } else if (b->pending[k] == kSell && b->qty[k] > 0.0) {
+            const int qty = static_cast<int>(b->qty[k]);
+            const double proceeds = static_cast<double>(qty) * open;
+            const double commission = proceeds * in.commission_pct;
+            b->cash[k] += (proceeds - commission);
+            b->tally[k].add(make_trade(b->entry_time[k], b->entry_price[k], in.ts[i], open, qty, in.commission_pct));
+            b->qty[k] = 0.0;
+            b->entry_time[k] = 0;
+            b->entry_price[k] = 0.0;
+        }
+        b->pending[k] = kNone;
+    }
+}
+
+// SMA update, signal, order scheduling, stop/take-profit check and equity for bar i.
+// Returns whether any lane scheduled an order. Fold is false only for bar 0, which
+// has no earlier equity value to fold; Filled means i >= every lane's windows.
+template <bool Fold, bool Filled>
+inline __attribute__((always_inline)) bool advance_bar(const BlockInput& in, std::size_t i, LaneBlock* b) {
+    const double close = in.c[i];
+    const int64_t bar = static_cast<int64_t>(i);
+    const int64_t has_next = (i + 1 < in.n) ? 1 : 0;
+    // Until every lane's window has filled, a lane whose window has not yet filled
+    // subtracts 0.0 (read from an in-bounds index); x - 0.0 == x, so the sums match
+    // the guarded subtraction. Afterwards the offsets are loop-invariant.
+    const double* leaving = in.c + i;
+    for (std::size_t k = 0; k < L; ++k) {
+        double fast_leaving = 0.0;
+        double slow_leaving = 0.0;
+        if (Filled) {
+            fast_leaving = leaving[-b->fast_window[k]];
+            slow_leaving = leaving[-b->slow_window[k]];
+        } else {
+            const int64_t fast_index = bar - b->fast_window[k];
+            const int64_t slow_index = bar - b->slow_window[k];
+            const double fast_value = in.c[(fast_index >= 0) ? fast_index : 0];
+            const double slow_value = in.c[(slow_index >= 0) ? slow_index : 0];
+            fast_leaving = (fast_index >= 0) ? fast_value : 0.0;
+            slow_leaving = (slow_index >= 0) ? slow_value : 0.0;
+        }
+        b->fast_sum[k] += close;
+        b->slow_sum[k] += close;
+        b->fast_sum[k] -= fast_leaving;
+        b->slow_sum[k] -= slow_leaving;
+    }
+
+    for (std::size_t k = 0; k < L; ++k) {
+        const double fast = b->fast_sum[k] / b->fast_divisor[k];
+        const double slow = b->slow_sum[k] / b->slow_divisor[k];
+        const int64_t ready = (bar + 1 >= b->warmup[k]) ? 1 : 0;
+        const int64_t compare = ready & b->prev_valid[k];
+        const int64_t enter = compare & ((b->prev_fast[k] <= b->prev_slow[k]) ? 1 : 0) & ((fast > slow) ? 1 : 0);
+        const int64_t exit = compare & (enter ^ 1) & ((b->prev_fast[k] >= b->prev_slow[k]) ? 1 : 0) &
+                             ((fast < slow) ? 1 : 0);
+        b->signal[k] = enter | (exit << 1);
+        b->prev_fast[k] = ready ? fast : b->prev_fast[k];
+        b->prev_slow[k] = ready ? slow : b->prev_slow[k];
+        b->prev_valid[k] |= ready;
+    }
+
+    int64_t scheduled = 0;
+    for (std::size_t k = 0; k < L; ++k) {
+        const int64_t signal = b->signal[k];
+        const double qty = b->qty[k];
+        const int64_t flat = (qty == 0.0) ? 1 : 0;
+        const int64_t open_position = (qty > 0.0) ? 1 : 0;
+        const int64_t act = (((signal == kBuy) ? 1 : 0) & flat) | (((signal == kSell) ? 1 : 0) & open_position);
+        int64_t pending = b->pending[k];
+        pending = (act & ((pending == kNone) ? 1 : 0) & has_next) ? signal : pending;
+
+        // Divisions are evaluated unconditionally (lanes without a position divide by
+        // zero and discard the result); a guarded division would block vectorization.
+        const double entry = b->entry_price[k];
+        const double ratio = (close - entry) / entry;
+        const double bar_return = (entry > 0.0) ? ratio : 0.0;
+        const int64_t hit = (b->stop_loss_enabled[k] & ((bar_return <= -b->stop_loss_pct[k]) ? 1 : 0)) |
+                            (b->take_profit_enabled[k] & ((bar_return >= b->take_profit_pct[k]) ? 1 : 0));
+        pending = (open_position & ((pending == kNone) ? 1 : 0) & has_next & hit) ? kSell : pending;
+        b->pending[k] = pending;
+        scheduled |= pending;
+
+        if (Fold) {
+            const double value = b->last[k];
+            const double peak = std::max(b->peak[k], value);
+            const double drop = (value - peak) / peak;
+            const double dd = (peak > 0.0) ? drop : 0.0;
+            b->peak[k] = peak;
+            b->min_dd[k] = std::min(b->min_dd[k], dd);
+        }
+        b->last[k] = b->cash[k] + qty * close;
+    }
+    return scheduled != 0;
+}
+
+// Works on a local copy so the lane state provably does not alias the input columns.
+inline __attribute__((always_inline)) void run_bars(const BlockInput& in, LaneBlock* block) {
+    LaneBlock lanes = *block;
+    const std::size_t filled =
+        std::min(in.n, static_cast<std::size_t>(*std::max_element(lanes.warmup, lanes.warmup + L)));
+    bool pending = advance_bar<false, false>(in, 0, &lanes);
+    std::size_t i = 1;
+    for (; i < filled; ++i) {
+        if (pending) {
+            fill_pending(in, i, &lanes);
+        }
+        pending = advance_bar<true, false>(in, i, &lanes);
+    }
+    for (; i < in.n; ++i) {
+        if (pending) {
+            fill_pending(in, i, &lanes);
+        }
+        pending = advance_bar<true, true>(in, i, &lanes);
+    }
+    *block = lanes;
+}
+
+void run_bars_default(const BlockInput& in, LaneBlock* b) {
+    run_bars(in, b);
+}
+
+#if defined(STOCKBT_BATCH_AVX2)
+// Same code with 4-wide vectors; AVX2 does not imply FMA, so no contraction changes
+// the rounding.
+__attribute__((target("avx2"))) void run_bars_avx2(const BlockInput& in, LaneBlock* b) {
+    run_bars(in, b);
+}
+#endif
+
+void run_block(const BlockInput& in, const BacktestSettings& settings, LaneBlock* b, Metrics* out) {
+#if defined(STOCKBT_BATCH_AVX2)
+    if (detected_simd_level() == SimdLevel::Avx2) {
+        run_bars_avx2(in, b);
+    } else {
+        run_bars_default(in, b);
+    }
+#else
+    run_bars_default(in, b);
+#endif
+
+    const std::size_t last = in.n - 1;
+    for (std::size_t k = 0; k < L; ++k) {
+        if (b->qty[k] > 0.0) {
+            const int qty = static_cast<int>(b->qty[k]);
+            const double proceeds = static_cast<double>(qty) * in.c[last];
+            const double commission = proceeds * in.commission_pct;
+            b->cash[k] += (proceeds - commission);
+            b->tally[k].add(
+                make_trade(b->entry_time[k], b->entry_price[k], in.ts[last], in.c[last], qty, in.commission_pct));
+            b->qty[k] = 0.0;
+            b->last[k] = b->cash[k];
+        }
+        const double value = b->last[k];
+        b->peak[k] = std::max(b->peak[k], value);
+        const double dd = (b->peak[k] > 0.0) ? (value - b->peak[k]) / b->peak[k] : 0.0;
+        b->min_dd[k] = std::min(b->min_dd[k], dd);
+        out[k] = finalize_metrics(value, b->min_dd[k], b->tally[k], settings);
+    }
+}
+
+} // namespace
+
+void run_sma_backtest_batches(const std::vector<BatchJob>& jobs,
+                              const BacktestSettings& settings,
+                              WorkStealingPool* pool,
+                              ProgressToken* progress) {
+    struct Block {
+        std::size_t job;
+        std::size_t first; // into valid[job]
+    };
+
+    std::vector<std::vector<std::size_t>> valid(jobs.size());
+    std::vector<Block> blocks;
+    for (std::size_t job = 0; job < jobs.size(); ++job) {
+        const std::vector<BatchConfig>& configs = *jobs[job].configs;
+        jobs[job].results->assign(configs.size(), Metrics{});
+        if (jobs[job].columns.empty()) {
+            continue;
+        }
+        for (std::size_t index = 0; index < configs.size(); ++index) {
+            if (configs[index].params.is_valid()) {
+                valid[job].push_back(index);
+            }
+        }
+        for (std::size_t first = 0; first < valid[job].size(); first += L) {
+            blocks.push_back(Block{job, first});
+        }
+    }
+
+    std::atomic<std::size_t> finished{0};
+    auto run_one = [&](std::size_t block_index, std::size_t) {
+        if (is_cancelled(progress)) {
+            return;
+        }
+        const Block& task = blocks[block_index];
+        const BatchJob& job = jobs[task.job];
+        const std::vector<std::size_t>& lanes = valid[task.job];
+        const std::size_t active = std::min(L, lanes.size() - task.first);
+        const BatchConfig* lane_configs[L];
+        for (std::size_t k = 0; k < L; ++k) {
+            lane_configs[k] = &(*job.configs)[lanes[task.first + (k < active ? k : 0)]];
+        }
+
+        BlockInput input;
+        input.ts = job.columns.ts();
+        input.o = job.columns.o();
+        input.c = job.columns.c();
+        input.n = job.columns.size();
+        input.commission_pct = settings.commission_pct;
+        input.position_size_pct = clamp01(settings.position_size_pct);
+
+        LaneBlock block;
+        init_block(&block, lane_configs, settings);
+        Metrics lane_metrics[L];
+        run_block(input, settings, &block, lane_metrics);
+        for (std::size_t k = 0; k < active; ++k) {
+            (*job.results)[lanes[task.first + k]] = lane_metrics[k];
+        }
+        report_progress(progress, finished.fetch_add(1) + 1, blocks.size());
+    };
+
+    if (pool != nullptr) {
+        pool->parallel_for(blocks.size(), run_one);
+    } else {
+        for (std::size_t block_index = 0; block_index < blocks.size(); ++block_index) {
+            run_one(block_index, 0);
+        }
+    }
+}
+
+std::vector<Metrics> run_sma_backtest_batch(ColumnsView columns,
+                                            const std::vector<BatchConfig>& configs,
+                                            const BacktestSettings& settings,
+                                            WorkStealingPool* pool) {
+    std::vector<Metrics> results;
+    run_sma_backtest_batches({BatchJob{columns, &configs, &results}}, settings, pool);
+    return results;
+}
+
+std::vector<Metrics> run_sma_backtest_batch(CandleView candles,
+                                            const std::vector<BatchConfig>& configs,
+                                            const BacktestSettings& settings,
+                                            WorkStealingPool* pool) {
+    const SeriesColumns columns = to_columns(candles);
+    return run_sma_backtest_batch(ColumnsView(columns), configs, settings, pool);
+}
+
+} // namespace stockbt
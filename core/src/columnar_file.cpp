@@ -0,0 +1,340 @@
+#include "columnar_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace stockbt {
+namespace columnar {
+
+namespace {
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t{7};
+}
+
+void set_error(std::string* error, const std::string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+bool write_padding(std::ofstream& out, uint64_t from, uint64_t to) {
+    static const char zeros[8] = {};
+    if (to > from) {
+        out.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+    return static_cast<bool>(out);
+}
+
+std::size_t type_size(uint32_t type) {
+    switch (static_cast<ColumnType>(type)) {
+    case ColumnType::Int64:
+    case ColumnType::Float64:
+        return 8;
+    }
+    return 0;
+}
+
+uint64_t load_bits(const unsigned char* bytes) {
+    uint64_t value = 0;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+// Int64 columns: zigzag of the delta. Float64 columns: XOR of the bit patterns.
+uint64_t varint_residual(ColumnType type, uint64_t value, uint64_t prev) {
+    if (type == ColumnType::Int64) {
+        const auto delta = static_cast<int64_t>(value - prev);
+        return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    }
+    return value ^ prev;
+}
+
+uint64_t varint_value(ColumnType type, uint64_t residual, uint64_t prev) {
+    if (type == ColumnType::Int64) {
+        return prev + ((residual >> 1) ^ (~(residual & 1) + 1));
+    }
+    return residual ^ prev;
+}
+
+std::size_t stride_of(const ColumnSource& column) {
+    return (column.stride != 0) ? column.stride : 8;
+}
+
+std::vector<char> encode_varint(const ColumnSource& column) {
+    std::vector<char> encoded;
+    const auto* bytes = static_cast<const unsigned char*>(column.data);
+    const std::size_t count = column.bytes / 8;
+    const std::size_t stride = stride_of(column);
+    encoded.reserve(count * 2);
+    uint64_t prev = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const uint64_t value = load_bits(bytes + i * stride);
+        uint64_t residual = varint_residual(column.type, value, prev);
+        prev = value;
+        while (residual >= 0x80) {
+            encoded.push_back(static_cast<char>((residual & 0x7f) | 0x80));
+            residual >>= 7;
+        }
+        encoded.push_back(static_cast<char>(residual));
+    }
+    return encoded;
+}
+
+// Raw payload of a strided column, packed through a small buffer.
+void write_strided(std::ofstream& out, const ColumnSource& column) {
+    const auto* bytes = static_cast<const char*>(column.data);
+    const std::size_t count = column.bytes / 8;
+    char buffer[4096];
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::memcpy(buffer + used, bytes + i * column.stride, 8);
+        used += 8;
+        if (used == sizeof(buffer) || i + 1 == count) {
+            out.write(buffer, static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+}
+
+} // namespace
+
+void ByteWriter::put_string(std::string_view text) {
+    put<uint32_t>(static_cast<uint32_t>(text.size()));
+    data_.insert(data_.end(), text.begin(), text.end());
+}
+
+bool ByteReader::get_string(std::string* text) {
+    uint32_t length = 0;
+    if (!get(&length) || static_cast<std::size_t>(end_ - pos_) < length) {
+        return false;
+    }
+    text->assign(pos_, length);
+    pos_ += length;
+    return true;
+}
+
+bool write_file(const std::string& path,
+                FileKind kind,
+                uint64_t row_count,
+                const std::vector<char>& meta,
+                const std::vector<ColumnSource>& columns,
+                std::string* error) {
+    FileHeader header{};
+    std::copy(std::begin(kMagic), std::end(kMagic), header.magic);
+    header.version = kFormatVersion;
+    header.endian_tag = kEndianTag;
+    header.kind = static_cast<uint32_t>(kind);
+    header.column_count = static_cast<uint32_t>(columns.size());
+    header.row_count = row_count;
+    header.meta_offset = sizeof(FileHeader);
+    header.meta_size = meta.size();
+    header.directory_offset = align8(header.meta_offset + header.meta_size);
+
+    std::vector<std::vector<char>> encoded(columns.size());
+    std::vector<ColumnEntry> directory(columns.size());
+    uint64_t offset = header.directory_offset + sizeof(ColumnEntry) * columns.size();
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        ColumnEntry& entry = directory[i];
+        const std::string& name = columns[i].name;
+        if (name.size() >= sizeof(entry.name)) {
+            set_error(error, "Column name too long: " + name);
+            return false;
+        }
+        std::copy(name.begin(), name.end(), entry.name);
+        entry.type = static_cast<uint32_t>(columns[i].type);
+        entry.encoding = static_cast<uint32_t>(columns[i].encoding);
+        entry.offset = align8(offset);
+        entry.size = columns[i].bytes;
+        if (columns[i].encoding == Encoding::Varint) {
+            encoded[i] = encode_varint(columns[i]);
+            entry.size = encoded[i].size();
+        }
+        offset = entry.offset + entry.size;
+    }
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            set_error(error, "Unable to open output file: " + tmp_path);
+            return false;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(meta.data(), static_cast<std::streamsize>(meta.size()));
+        write_padding(out, header.meta_offset + header.meta_size, header.directory_offset);
+        out.write(reinterpret_cast<const char*>(directory.data()),
+                  static_cast<std::streamsize>(sizeof(ColumnEntry) * directory.size()));
+        uint64_t written = header.directory_offset + sizeof(ColumnEntry) * directory.size();
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            write_padding(out, written, directory[i].offset);
+            if (columns[i].encoding == Encoding::Varint) {
+                out.write(encoded[i].data(), static_cast<std::streamsize>(directory[i].size));
+            } else if (stride_of(columns[i]) != 8) {
+                write_strided(out, columns[i]);
+            } else {
+                out.write(static_cast<const char*>(columns[i].data), static_cast<std::streamsize>(directory[i].size));
+            }
+            written = directory[i].offset + directory[i].size;
+        }
+        out.close();
+        if (!out) {
+            std::remove(tmp_path.c_str());
+            set_error(error, "Failed while writing file: " + tmp_path);
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        // Windows rename does not replace an existing file.
+        std::remove(path.c_str());
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            std::remove(tmp_path.c_str());
+            set_error(error, "Unable to replace file: " + path);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Reader::open(const char* data, std::size_t size, FileKind kind, std::string* error) {
+    data_ = nullptr;
+    columns_.clear();
+    header_ = FileHeader{};
+    auto fail = [&](const std::string& message) {
+        columns_.clear();
+        header_ = FileHeader{};
+        set_error(error, message);
+        return false;
+    };
+
+    if (size < sizeof(FileHeader)) {
+        return fail("File too small");
+    }
+    std::memcpy(&header_, data, sizeof(FileHeader));
+    if (!std::equal(std::begin(kMagic), std::end(kMagic), header_.magic)) {
+        return fail("Not a stockbt binary file");
+    }
+    if (header_.endian_tag != kEndianTag) {
+        return fail("File was written with a different byte order");
+    }
+    if (header_.version != kFormatVersion) {
+        return fail("Unsupported file version");
+    }
+    if (header_.kind != static_cast<uint32_t>(kind)) {
+        return fail("Unexpected file kind");
+    }
+    if (header_.meta_offset > size || header_.meta_size > size - header_.meta_offset ||
+        header_.directory_offset > size ||
+        header_.column_count > (size - header_.directory_offset) / sizeof(ColumnEntry)) {
+        return fail("Corrupt file header");
+    }
+
+    columns_.resize(header_.column_count);
+    std::memcpy(columns_.data(), data + header_.directory_offset, sizeof(ColumnEntry) * columns_.size());
+    for (const ColumnEntry& entry : columns_) {
+        if (entry.offset % 8 != 0 || entry.offset > size || entry.size > size - entry.offset ||
+            entry.name[sizeof(entry.name) - 1] != '\0') {
+            return fail("Corrupt column directory");
+        }
+    }
+    data_ = data;
+    return true;
+}
+
+ByteReader Reader::meta() const {
+    if (data_ == nullptr) {
+        return ByteReader(nullptr, 0);
+    }
+    return ByteReader(data_ + header_.meta_offset, static_cast<std::size_t>(header_.meta_size));
+}
+
+const ColumnEntry* Reader::find(std::string_view name, ColumnType type) const {
+    for (const ColumnEntry& entry : columns_) {
+        if (name == entry.name) {
+            return (entry.type == static_cast<uint32_t>(type)) ? &entry : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+const void* Reader::raw_column(std::string_view name, ColumnType type) const {
+    const ColumnEntry* entry = find(name, type);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    const std::size_t width = type_size(entry->type);
+    if (entry->encoding != static_cast<uint32_t>(Encoding::Raw) || width == 0 ||
+        entry->size / width != header_.row_count || entry->size % width != 0) {
+        return nullptr;
+    }
+    return data_ + entry->offset;
+}
+
+bool Reader::read_bits(std::string_view name, ColumnType type, std::vector<uint64_t>* bits) const {
+    bits->clear();
+    if (const void* raw = raw_column(name, type)) {
+        bits->resize(static_cast<std::size_t>(header_.row_count));
+        std::memcpy(bits->data(), raw, bits->size() * sizeof(uint64_t));
+        return true;
+    }
+    const ColumnEntry* entry = find(name, type);
+    if (entry == nullptr || entry->encoding != static_cast<uint32_t>(Encoding::Varint) ||
+        header_.row_count > entry->size) {
+        return false;
+    }
+
+    bits->resize(static_cast<std::size_t>(header_.row_count));
+    const auto* pos = reinterpret_cast<const unsigned char*>(data_ + entry->offset);
+    const unsigned char* end = pos + entry->size;
+    uint64_t prev = 0;
+    for (uint64_t& value : *bits) {
+        uint64_t residual = 0;
+        for (int shift = 0;; shift += 7) {
+            if (pos == end || shift > 63) {
+                bits->clear();
+                return false;
+            }
+            const unsigned char byte = *pos++;
+            residual |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        value = varint_value(type, residual, prev);
+        prev = value;
+    }
+    if (pos != end) {
+        bits->clear();
+        return false;
+    }
+    return true;
+}
+
+bool Reader::read_column(std::string_view name, std::vector<int64_t>* values) const {
+    std::vector<uint64_t> bits;
+    if (!read_bits(name, ColumnType::Int64, &bits)) {
+        values->clear();
+        return false;
+    }
+    values->resize(bits.size());
+    std::memcpy(values->data(), bits.data(), bits.size() * sizeof(uint64_t));
+    return true;
+}
+
+bool Reader::read_column(std::string_view name, std::vector<double>* values) const {
+    std::vector<uint64_t> bits;
+    if (!read_bits(name, ColumnType::Float64, &bits)) {
+        values->clear();
+        return false;
+    }
+    values->resize(bits.size());
+    std::memcpy(values->data(), bits.data(), bits.size() * sizeof(uint64_t));
+    return true;
+}
+
+} // namespace columnar
+} // namespace stockbt
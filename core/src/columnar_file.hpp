@@ -0,0 +1,155 @@
+#pragma once
+
+// Internal on-disk container shared by every binary file core writes (dataset
+// cache, backtest state, result exports). Layout, all little-endian host order:
+//
+//   FileHeader (64 bytes)
+//   metadata blob (kind-specific, padded to 8 bytes)
+//   ColumnEntry[column_count] (48 bytes each)
+//   column payloads, each starting on an 8-byte boundary
+//
+// Raw columns can be used in place from a memory mapping. Varint columns trade that
+// for size: Int64 values are stored as zigzag LEB128 deltas from the previous value,
+// Float64 values as LEB128 of their bits XOR the previous value's bits, so sorted
+// timestamps and runs of repeated values take one or two bytes per row.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stockbt {
+namespace columnar {
+
+constexpr char kMagic[8] = {'S', 'T', 'O', 'C', 'K', 'B', 'T', '\0'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr uint32_t kEndianTag = 0x01020304u;
+
+enum class FileKind : uint32_t {
+    Dataset = 1,
+    BacktestState = 2,
+    EquityCurve = 3,
+    TradeList = 4,
+    SweepReport = 5,
+    MetricsCache = 6,
+};
+
+enum class ColumnType : uint32_t {
+    Int64 = 1,
+    Float64 = 2,
+};
+
+enum class Encoding : uint32_t {
+    Raw = 0,
+    Varint = 1,
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t kind;
+    uint32_t column_count;
+    uint64_t row_count;
+    uint64_t meta_offset;
+    uint64_t meta_size;
+    uint64_t directory_offset;
+    uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout is part of the file format");
+
+struct ColumnEntry {
+    char name[24];
+    uint32_t type;
+    uint32_t encoding;
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(ColumnEntry) == 48, "ColumnEntry layout is part of the file format");
+
+// Appends plain values and length-prefixed strings to a metadata blob.
+class ByteWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        const auto* bytes = reinterpret_cast<const char*>(&value);
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+    void put_string(std::string_view text);
+
+    const std::vector<char>& data() const { return data_; }
+
+private:
+    std::vector<char> data_;
+};
+
+// Bounds-checked reader over a metadata blob. Every read fails once the blob is exhausted.
+class ByteReader {
+public:
+    ByteReader(const char* data, std::size_t size) : pos_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T* value) {
+        if (static_cast<std::size_t>(end_ - pos_) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool get_string(std::string* text);
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+struct ColumnSource {
+    std::string name;
+    ColumnType type{ColumnType::Int64};
+    const void* data{nullptr};
+    std::size_t bytes{0}; // payload size, 8 per value
+    Encoding encoding{Encoding::Raw};
+    // Bytes from one value to the next in data, e.g. sizeof(Candle) for a field of row
+    // storage; 0 means packed.
+    std::size_t stride{0};
+};
+
+// Writes header, metadata and columns to a temporary file and renames it over path,
+// so readers never observe a partially written file.
+bool write_file(const std::string& path,
+                FileKind kind,
+                uint64_t row_count,
+                const std::vector<char>& meta,
+                const std::vector<ColumnSource>& columns,
+                std::string* error);
+
+// Non-owning reader over a whole file image (usually a MappedFile); validates the
+// header and directory bounds on open.
+class Reader {
+public:
+    bool open(const char* data, std::size_t size, FileKind kind, std::string* error);
+
+    uint64_t row_count() const { return header_.row_count; }
+    ByteReader meta() const;
+
+    // Raw column payload with row_count() values of the given type, or nullptr.
+    const void* raw_column(std::string_view name, ColumnType type) const;
+
+    // Copies or decodes a column of any encoding; false when it is missing or corrupt.
+    bool read_column(std::string_view name, std::vector<int64_t>* values) const;
+    bool read_column(std::string_view name, std::vector<double>* values) const;
+
+private:
+    const ColumnEntry* find(std::string_view name, ColumnType type) const;
+    bool read_bits(std::string_view name, ColumnType type, std::vector<uint64_t>* bits) const;
+
+    const char* data_{nullptr};
+    FileHeader header_{};
+    std::vector<ColumnEntry> columns_;
+};
+
+} // namespace columnar
+} // namespace stockbt
@@ -1,14 +1,26 @@
 #include "backtest/csv_importer.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
+#include <cfloat>
+#include <charconv>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 
+#include "backtest/dataset_cache.hpp"
+#include "backtest/mapped_file.hpp"
+#include "backtest/thread_pool.hpp"
 #include "backtest/time_utils.hpp"
+#include "instrumentation.hpp"
 
 namespace stockbt {
 namespace {
@@ -25,6 +37,18 @@ std::string trim(const std::string& input) {
     return input.substr(start, end - start);
 }
 
+std::string_view trim_view(std::string_view input) {
+    std::size_t start = 0;
+    while (start < input.size() && std::isspace(static_cast<unsigned char>(input[start])) != 0) {
+        ++start;
+    }
+    std::size_t end = input.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(input[end - 1])) != 0) {
+        --end;
+    }
+    return input.substr(start, end - start);
+}
+
 std::string lowercase(std::string input) {
     for (char& ch : input) {
         ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
@@ -53,7 +77,7 @@ std::size_t find_header_any(const std::unordered_map<std::string, std::size_t>&
     return kMissing;
 }
 
-std::vector<std::string> parse_csv_line(const std::string& line) {
+std::vector<std::string> parse_csv_line(std::string_view line) {
     std::vector<std::string> fields;
     std::string current;
     bool in_quotes = false;
@@ -78,11 +102,8 @@ std::vector<std::string> parse_csv_line(const std::string& line) {
     return fields;
 }
 
-bool parse_double_strict(const std::string& text, double* out) {
-    const std::string t = trim(text);
-    if (t.empty()) {
-        return false;
-    }
+bool parse_double_strtod(std::string_view text, double* out) {
+    const std::string t(text);
     char* end_ptr = nullptr;
     errno = 0;
     const double value = std::strtod(t.c_str(), &end_ptr);
@@ -97,81 +118,95 @@ void append_issue(std::vector<ImportIssue>* issues, std::size_t line, const std:
     issues->push_back({line, message});
 }
 
-} // namespace
-
-ImportResult import_ohlcv_csv(const std::string& csv_path, DateFormat date_format) {
-    ImportResult result;
-
-    std::ifstream in(csv_path);
-    if (!in.is_open()) {
-        append_issue(&result.errors, 0, "Unable to open CSV file: " + csv_path);
-        return result;
-    }
-
-    std::string header_line;
-    if (!std::getline(in, header_line)) {
-        append_issue(&result.errors, 1, "CSV is empty");
-        return result;
-    }
+struct ColumnLayout {
+    std::size_t timestamp_col{kMissing};
+    std::size_t dt_col{kMissing};
+    std::size_t tm_col{kMissing};
+    std::size_t o_col{kMissing};
+    std::size_t h_col{kMissing};
+    std::size_t l_col{kMissing};
+    std::size_t c_col{kMissing};
+    std::size_t v_col{kMissing};
+    bool has_single_timestamp{false};
+    bool has_split_datetime{false};
+    std::size_t max_index{0};
+};
 
+bool parse_header(std::string_view header_line, ColumnLayout* layout) {
     const std::vector<std::string> headers_raw = parse_csv_line(header_line);
     std::unordered_map<std::string, std::size_t> header_index;
     for (std::size_t i = 0; i < headers_raw.size(); ++i) {
         header_index[normalize_header(headers_raw[i])] = i;
     }
 
-    const std::size_t timestamp_col = find_header_any(header_index, {"timestamp", "date"});
-    const std::size_t dt_col = find_header_any(header_index, {"dtyyyymmdd"});
-    const std::size_t tm_col = find_header_any(header_index, {"time"});
-    const std::size_t o_col = find_header_any(header_index, {"open"});
-    const std::size_t h_col = find_header_any(header_index, {"high"});
-    const std::size_t l_col = find_header_any(header_index, {"low"});
-    const std::size_t c_col = find_header_any(header_index, {"close"});
-    const std::size_t v_col = find_header_any(header_index, {"volume", "vol"});
-
-    const bool has_single_timestamp = timestamp_col != kMissing;
-    const bool has_split_datetime = dt_col != kMissing && tm_col != kMissing;
-    if ((!has_single_timestamp && !has_split_datetime) || o_col == kMissing || h_col == kMissing || l_col == kMissing ||
-        c_col == kMissing || v_col == kMissing) {
-        append_issue(&result.errors,
-                     1,
-                     "Missing required columns. Required: Date/Timestamp OR DTYYYYMMDD+TIME, Open, High, Low, "
-                     "Close, Volume/VOL");
-        return result;
+    layout->timestamp_col = find_header_any(header_index, {"timestamp", "date"});
+    layout->dt_col = find_header_any(header_index, {"dtyyyymmdd"});
+    layout->tm_col = find_header_any(header_index, {"time"});
+    layout->o_col = find_header_any(header_index, {"open"});
+    layout->h_col = find_header_any(header_index, {"high"});
+    layout->l_col = find_header_any(header_index, {"low"});
+    layout->c_col = find_header_any(header_index, {"close"});
+    layout->v_col = find_header_any(header_index, {"volume", "vol"});
+
+    layout->has_single_timestamp = layout->timestamp_col != kMissing;
+    layout->has_split_datetime = layout->dt_col != kMissing && layout->tm_col != kMissing;
+    if ((!layout->has_single_timestamp && !layout->has_split_datetime) || layout->o_col == kMissing ||
+        layout->h_col == kMissing || layout->l_col == kMissing || layout->c_col == kMissing ||
+        layout->v_col == kMissing) {
+        return false;
     }
 
-    std::vector<ImportIssue> row_issues;
-    std::vector<Candle> valid_rows;
+    const std::size_t ts_req_col = layout->has_single_timestamp ? layout->timestamp_col : layout->dt_col;
+    layout->max_index = layout->has_split_datetime
+                            ? std::max({layout->dt_col, layout->tm_col, layout->o_col, layout->h_col, layout->l_col,
+                                        layout->c_col, layout->v_col})
+                            : std::max({ts_req_col, layout->o_col, layout->h_col, layout->l_col, layout->c_col,
+                                        layout->v_col});
+    return true;
+}
 
-    std::string line;
-    std::size_t line_number = 1;
-    while (std::getline(in, line)) {
-        ++line_number;
-        if (trim(line).empty()) {
-            continue;
-        }
+void append_rows(Series* rows, const Series& more) {
+    rows->insert(rows->end(), more.begin(), more.end());
+}
+
+void append_rows(SeriesColumns* rows, const SeriesColumns& more) {
+    rows->ts.insert(rows->ts.end(), more.ts.begin(), more.ts.end());
+    rows->o.insert(rows->o.end(), more.o.begin(), more.o.end());
+    rows->h.insert(rows->h.end(), more.h.begin(), more.h.end());
+    rows->l.insert(rows->l.end(), more.l.begin(), more.l.end());
+    rows->c.insert(rows->c.end(), more.c.begin(), more.c.end());
+    rows->v.insert(rows->v.end(), more.v.begin(), more.v.end());
+}
+
+// Validates data rows into candles, appended to a Series or straight into the arrays
+// of a SeriesColumns. Field views point into the line (or into quoted_ when the line
+// needs unescaping), and all buffers are reused between rows, so steady-state parsing
+// does not allocate.
+template <typename Rows>
+class RowParser {
+public:
+    RowParser(const ColumnLayout& layout, DateFormat date_format, std::size_t issue_samples)
+        : layout_(layout), timestamps_(date_format), issue_samples_(issue_samples) {}
 
-        const std::vector<std::string> fields = parse_csv_line(line);
-        const std::size_t ts_req_col = has_single_timestamp ? timestamp_col : dt_col;
-        const std::size_t max_index = has_split_datetime
-                                          ? std::max({dt_col, tm_col, o_col, h_col, l_col, c_col, v_col})
-                                          : std::max({ts_req_col, o_col, h_col, l_col, c_col, v_col});
-        if (fields.size() <= max_index) {
-            ++result.dropped_rows;
-            append_issue(&row_issues, line_number, "Dropped row: missing one or more required field values");
-            continue;
+    void parse_line(std::string_view line, std::size_t line_number) {
+        if (trim_view(line).empty()) {
+            return;
         }
+        STOCKBT_STATS(++parsed);
 
-        std::optional<int64_t> ts;
-        if (has_split_datetime) {
-            ts = parse_date_time_utc_yyyymmdd_hhmmss(fields[dt_col], fields[tm_col]);
-        } else {
-            ts = parse_timestamp_utc(fields[timestamp_col], date_format);
+        split_csv_fields(line, &fields_, &quoted_);
+        if (fields_.size() <= layout_.max_index) {
+            drop(line_number, RowDropReason::MissingFields);
+            return;
         }
+
+        const std::optional<int64_t> ts =
+            layout_.has_split_datetime
+                ? timestamps_.parse_date_time(fields_[layout_.dt_col], fields_[layout_.tm_col])
+                : timestamps_.parse(fields_[layout_.timestamp_col]);
         if (!ts.has_value()) {
-            ++result.dropped_rows;
-            append_issue(&row_issues, line_number, "Dropped row: invalid timestamp format");
-            continue;
+            drop(line_number, RowDropReason::InvalidTimestamp);
+            return;
         }
 
         double o = 0.0;
@@ -179,74 +214,928 @@ ImportResult import_ohlcv_csv(const std::string& csv_path, DateFormat date_forma
         double l = 0.0;
         double c = 0.0;
         double v = 0.0;
-        if (!parse_double_strict(fields[o_col], &o) || !parse_double_strict(fields[h_col], &h) ||
-            !parse_double_strict(fields[l_col], &l) || !parse_double_strict(fields[c_col], &c) ||
-            !parse_double_strict(fields[v_col], &v)) {
-            ++result.dropped_rows;
-            append_issue(&row_issues, line_number, "Dropped row: invalid numeric value");
-            continue;
+        if (!parse_csv_number(fields_[layout_.o_col], &o) || !parse_csv_number(fields_[layout_.h_col], &h) ||
+            !parse_csv_number(fields_[layout_.l_col], &l) || !parse_csv_number(fields_[layout_.c_col], &c) ||
+            !parse_csv_number(fields_[layout_.v_col], &v)) {
+            drop(line_number, RowDropReason::InvalidNumber);
+            return;
         }
 
         if (o <= 0.0 || h <= 0.0 || l <= 0.0 || c <= 0.0) {
-            ++result.dropped_rows;
-            append_issue(&row_issues, line_number, "Dropped row: prices must be > 0");
-            continue;
+            drop(line_number, RowDropReason::NonPositivePrice);
+            return;
         }
         if (v < 0.0) {
-            ++result.dropped_rows;
-            append_issue(&row_issues, line_number, "Dropped row: volume must be >= 0");
-            continue;
+            drop(line_number, RowDropReason::NegativeVolume);
+            return;
         }
 
-        valid_rows.push_back({*ts, o, h, l, c, v});
+        rows.push_back(Candle{*ts, o, h, l, c, v});
     }
 
-    if (valid_rows.empty()) {
-        append_issue(&result.errors, 0, "Import failed: zero valid rows remain after filtering");
-        result.errors.insert(result.errors.end(), row_issues.begin(), row_issues.end());
-        return result;
+    Rows rows;
+    RowIssueSummary issues;
+    std::size_t dropped{0};
+    std::size_t parsed{0}; // instrumentation only; stays zero when STOCKBT_INSTRUMENTATION is off
+
+    // Appends other (parsed from the following lines, numbered from 0) to this parser.
+    void append(RowParser&& other, std::size_t first_line) {
+        append_rows(&rows, other.rows);
+        for (std::size_t reason = 0; reason < kRowDropReasons; ++reason) {
+            issues.counts[reason] += other.issues.counts[reason];
+            std::vector<std::size_t>& samples = issues.sample_lines[reason];
+            for (std::size_t line : other.issues.sample_lines[reason]) {
+                if (samples.size() == issue_samples_) {
+                    break;
+                }
+                samples.push_back(line + first_line);
+            }
+        }
+        dropped += other.dropped;
+        STOCKBT_STATS(parsed += other.parsed);
+        other.rows = Rows();
     }
 
-    bool unordered = false;
-    for (std::size_t i = 1; i < valid_rows.size(); ++i) {
-        if (valid_rows[i].ts < valid_rows[i - 1].ts) {
-            unordered = true;
-            break;
+private:
+    void drop(std::size_t line_number, RowDropReason reason) {
+        const auto index = static_cast<std::size_t>(reason);
+        ++dropped;
+        ++issues.counts[index];
+        if (issues.sample_lines[index].size() < issue_samples_) {
+            issues.sample_lines[index].push_back(line_number);
         }
     }
 
-    if (unordered) {
-        append_issue(&result.warnings, 0, "Timestamps were unsorted. Data was sorted ascending.");
+    const ColumnLayout& layout_;
+    TimestampParser timestamps_;
+    std::size_t issue_samples_;
+    std::vector<std::string_view> fields_;
+    std::vector<std::string> quoted_;
+};
+
+// Splits a mapped buffer into lines with std::getline semantics: '\n' terminates a
+// line, and a trailing newline does not produce an extra empty line.
+class MappedLineReader {
+public:
+    MappedLineReader(const char* data, std::size_t size) : begin_(data), pos_(data), end_(data + size) {}
+
+    bool next(std::string_view* line) {
+        if (pos_ == end_) {
+            return false;
+        }
+        const void* newline = std::memchr(pos_, '\n', static_cast<std::size_t>(end_ - pos_));
+        const char* line_end = (newline != nullptr) ? static_cast<const char*>(newline) : end_;
+        *line = std::string_view(pos_, static_cast<std::size_t>(line_end - pos_));
+        pos_ = (line_end == end_) ? end_ : line_end + 1;
+        return true;
     }
 
-    std::stable_sort(valid_rows.begin(), valid_rows.end(), [](const Candle& a, const Candle& b) { return a.ts < b.ts; });
+    const char* position() const { return pos_; }
+    std::size_t consumed() const { return static_cast<std::size_t>(pos_ - begin_); }
 
-    std::vector<Candle> deduped;
-    deduped.reserve(valid_rows.size());
-    std::size_t duplicate_count = 0;
-    for (const Candle& c : valid_rows) {
-        if (!deduped.empty() && deduped.back().ts == c.ts) {
-            deduped.back() = c;
-            ++duplicate_count;
-        } else {
-            deduped.push_back(c);
+private:
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+};
+
+class StreamLineReader {
+public:
+    explicit StreamLineReader(std::istream& in) : in_(in) {}
+
+    bool next(std::string_view* line) {
+        if (!std::getline(in_, buffer_)) {
+            return false;
         }
+        consumed_ += buffer_.size() + 1;
+        *line = buffer_;
+        return true;
+    }
+
+    std::size_t consumed() const { return consumed_; }
+
+private:
+    std::istream& in_;
+    std::string buffer_;
+    std::size_t consumed_{0};
+};
+
+// Where parse_lines reports to; total_bytes == 0 only polls for cancellation.
+struct ParseProgress {
+    ProgressToken* token{nullptr};
+    std::size_t total_bytes{0};
+};
+
+ImportResult cancelled_import() {
+    ImportResult result;
+    append_issue(&result.errors, 0, "Import cancelled");
+    return result;
+}
+
+// Defined with sort_and_dedupe_candles; same rules, applied to every column.
+std::size_t sort_and_dedupe_columns(SeriesColumns* columns, bool* unsorted);
+
+std::size_t sort_and_dedupe(Series* rows, bool* unsorted) {
+    return sort_and_dedupe_candles(rows, unsorted);
+}
+
+std::size_t sort_and_dedupe(SeriesColumns* rows, bool* unsorted) {
+    return sort_and_dedupe_columns(rows, unsorted);
+}
+
+void store_rows(Series&& rows, ImportResult* result) {
+    result->candles = std::move(rows);
+}
+
+void store_rows(SeriesColumns&& rows, ImportResult* result) {
+    result->columns = std::move(rows);
+}
+
+template <typename Rows>
+void finalize_import(RowParser<Rows>* parser, double parse_ms, ImportResult* result) {
+    STOCKBT_STATS(result->stats.collected = true);
+    STOCKBT_STATS(result->stats.rows_parsed = parser->parsed);
+    STOCKBT_STATS(result->stats.dropped_by_reason = parser->issues.counts);
+    STOCKBT_STATS(result->stats.parse_ms = parse_ms);
+    result->dropped_rows = parser->dropped;
+    result->row_issues = std::move(parser->issues);
+    Rows& valid_rows = parser->rows;
+
+    if (valid_rows.empty()) {
+        append_issue(&result->errors, 0, "Import failed: zero valid rows remain after filtering");
+        const std::vector<ImportIssue> row_issues = describe_row_issues(result->row_issues);
+        result->errors.insert(result->errors.end(), row_issues.begin(), row_issues.end());
+        return;
+    }
+
+    bool unordered = false;
+    std::size_t duplicate_count = 0;
+    {
+        STOCKBT_TIME_SCOPE(&result->stats.sort_ms);
+        duplicate_count = sort_and_dedupe(&valid_rows, &unordered);
+    }
+    STOCKBT_STATS(result->stats.sorted = unordered);
+    STOCKBT_STATS(result->stats.duplicates_removed = duplicate_count);
+    if (unordered) {
+        append_issue(&result->warnings, 0, "Timestamps were unsorted. Data was sorted ascending.");
     }
     if (duplicate_count > 0) {
         std::ostringstream oss;
         oss << "Duplicate timestamps detected. Kept last occurrence for " << duplicate_count << " row(s).";
-        append_issue(&result.warnings, 0, oss.str());
+        append_issue(&result->warnings, 0, oss.str());
+    }
+
+    store_rows(std::move(valid_rows), result);
+    result->success = true;
+    result->partial_success = result->dropped_rows > 0;
+
+    if (result->partial_success) {
+        const std::vector<ImportIssue> row_issues = describe_row_issues(result->row_issues);
+        result->warnings.insert(result->warnings.end(), row_issues.begin(), row_issues.end());
+    }
+}
+
+template <typename LineReader>
+bool read_header(LineReader& reader, ColumnLayout* layout, std::vector<ImportIssue>* errors) {
+    std::string_view header_line;
+    if (!reader.next(&header_line)) {
+        append_issue(errors, 1, "CSV is empty");
+        return false;
+    }
+    if (!parse_header(header_line, layout)) {
+        append_issue(errors,
+                     1,
+                     "Missing required columns. Required: Date/Timestamp OR DTYYYYMMDD+TIME, Open, High, Low, "
+                     "Close, Volume/VOL");
+        return false;
+    }
+    return true;
+}
+
+// Parses lines until the reader is exhausted or progress is cancelled, numbering
+// them from first_line. Returns the number of lines consumed.
+template <typename LineReader, typename Rows>
+std::size_t parse_lines(LineReader& reader,
+                        std::size_t first_line,
+                        RowParser<Rows>* parser,
+                        const ParseProgress& progress) {
+    std::string_view line;
+    std::size_t line_number = first_line;
+    while (reader.next(&line)) {
+        parser->parse_line(line, line_number);
+        ++line_number;
+        if (progress.token != nullptr && (line_number - first_line) % ProgressToken::kInterval == 0) {
+            if (progress.token->cancelled()) {
+                break;
+            }
+            report_progress(progress.token, reader.consumed(), progress.total_bytes);
+        }
+    }
+    return line_number - first_line;
+}
+
+template <typename Rows, typename LineReader>
+ImportResult import_lines(LineReader& reader,
+                          DateFormat date_format,
+                          std::size_t issue_samples,
+                          const ParseProgress& progress) {
+    ImportResult result;
+    ColumnLayout layout;
+    if (!read_header(reader, &layout, &result.errors)) {
+        return result;
+    }
+
+    RowParser<Rows> parser(layout, date_format, issue_samples);
+    double parse_ms = 0.0;
+    {
+        STOCKBT_TIME_SCOPE(&parse_ms);
+        parse_lines(reader, 2, &parser, progress);
+    }
+    if (is_cancelled(progress.token)) {
+        return cancelled_import();
+    }
+    finalize_import(&parser, parse_ms, &result);
+    return result;
+}
+
+// Splits [begin, end) into chunks of roughly chunk_bytes that each start right
+// after a '\n', so every chunk holds whole lines.
+std::vector<std::string_view> split_line_chunks(const char* begin, const char* end, std::size_t chunk_bytes) {
+    std::vector<std::string_view> chunks;
+    const char* pos = begin;
+    while (pos < end) {
+        const std::size_t remaining = static_cast<std::size_t>(end - pos);
+        const char* cut = end;
+        if (remaining > chunk_bytes) {
+            const void* newline = std::memchr(pos + chunk_bytes, '\n', remaining - chunk_bytes);
+            cut = (newline != nullptr) ? static_cast<const char*>(newline) + 1 : end;
+        }
+        chunks.emplace_back(pos, static_cast<std::size_t>(cut - pos));
+        pos = cut;
+    }
+    return chunks;
+}
+
+template <typename Rows>
+ImportResult import_mapped_parallel(const MappedFile& mapped, DateFormat date_format, const ImportOptions& options) {
+    MappedLineReader header_reader(mapped.data(), mapped.size());
+    ImportResult result;
+    ColumnLayout layout;
+    if (!read_header(header_reader, &layout, &result.errors)) {
+        return result;
+    }
+
+    const std::vector<std::string_view> chunks =
+        split_line_chunks(header_reader.position(), mapped.data() + mapped.size(), std::max<std::size_t>(1, options.chunk_bytes));
+    if (chunks.size() <= 1) {
+        RowParser<Rows> parser(layout, date_format, options.issue_samples);
+        double parse_ms = 0.0;
+        {
+            STOCKBT_TIME_SCOPE(&parse_ms);
+            parse_lines(header_reader, 2, &parser, ParseProgress{options.progress, mapped.size()});
+        }
+        if (is_cancelled(options.progress)) {
+            return cancelled_import();
+        }
+        finalize_import(&parser, parse_ms, &result);
+        return result;
+    }
+
+    // Chunks are numbered from 0 and shifted once the line counts of all preceding
+    // chunks are known.
+    std::vector<RowParser<Rows>> parsers;
+    parsers.reserve(chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        parsers.emplace_back(layout, date_format, options.issue_samples);
+    }
+    std::vector<std::size_t> line_counts(chunks.size(), 0);
+
+    double parse_ms = 0.0;
+    std::atomic<std::size_t> parsed_bytes{0};
+    {
+        STOCKBT_TIME_SCOPE(&parse_ms);
+        WorkStealingPool pool(options.threads);
+        pool.parallel_for(chunks.size(), [&](std::size_t index, std::size_t) {
+            if (is_cancelled(options.progress)) {
+                return;
+            }
+            MappedLineReader reader(chunks[index].data(), chunks[index].size());
+            line_counts[index] = parse_lines(reader, 0, &parsers[index], ParseProgress{options.progress, 0});
+            report_progress(options.progress, parsed_bytes.fetch_add(chunks[index].size()) + chunks[index].size(),
+                            mapped.size());
+        });
+    }
+    if (is_cancelled(options.progress)) {
+        return cancelled_import();
+    }
+
+    std::size_t total_rows = 0;
+    for (const RowParser<Rows>& parser : parsers) {
+        total_rows += parser.rows.size();
+    }
+
+    RowParser<Rows> merged(layout, date_format, options.issue_samples);
+    merged.rows.reserve(total_rows);
+    std::size_t first_line = 2;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        merged.append(std::move(parsers[i]), first_line);
+        first_line += line_counts[i];
+    }
+
+    finalize_import(&merged, parse_ms, &result);
+    return result;
+}
+
+// Rows is Series or SeriesColumns, the storage options.layout asks for.
+template <typename Rows>
+ImportResult import_csv_file(const std::string& csv_path, DateFormat date_format, const ImportOptions& options) {
+    if (options.memory_map) {
+        MappedFile mapped;
+        if (mapped.open(csv_path, nullptr)) {
+            if (options.threads != 1) {
+                return import_mapped_parallel<Rows>(mapped, date_format, options);
+            }
+            MappedLineReader reader(mapped.data(), mapped.size());
+            return import_lines<Rows>(reader, date_format, options.issue_samples,
+                                      ParseProgress{options.progress, mapped.size()});
+        }
+    }
+
+    std::ifstream in(csv_path);
+    if (!in.is_open()) {
+        ImportResult result;
+        append_issue(&result.errors, 0, "Unable to open CSV file: " + csv_path);
+        return result;
+    }
+    std::error_code ec;
+    const auto file_bytes = std::filesystem::file_size(csv_path, ec);
+    const ParseProgress progress{options.progress, ec ? 0 : static_cast<std::size_t>(file_bytes)};
+    StreamLineReader reader(in);
+    return import_lines<Rows>(reader, date_format, options.issue_samples, progress);
+}
+
+ImportResult import_csv_file(const std::string& csv_path, DateFormat date_format, const ImportOptions& options) {
+    if (options.layout == SeriesLayout::Columns) {
+        return import_csv_file<SeriesColumns>(csv_path, date_format, options);
+    }
+    return import_csv_file<Series>(csv_path, date_format, options);
+}
+
+ImportResult import_dataset_cache(const std::string& cache_path, const ImportOptions& options) {
+    DatasetCache cache;
+    std::string error;
+    if (!cache.open(cache_path, &error)) {
+        ImportResult result;
+        append_issue(&result.errors, 0, error);
+        return result;
+    }
+    ImportResult result = cache.to_import_result(options.layout, options.issue_samples);
+    STOCKBT_STATS(result.stats.from_cache = true);
+    return result;
+}
+
+ImportResult import_any(const std::string& csv_path, DateFormat date_format, const ImportOptions& options) {
+    if (std::filesystem::path(csv_path).extension() == ".sbt") {
+        return import_dataset_cache(csv_path, options);
+    }
+    if (!options.binary_cache) {
+        return import_csv_file(csv_path, date_format, options);
+    }
+
+    const std::string cache_path = dataset_cache_path(csv_path);
+    SourceStamp before;
+    if (!read_source_stamp(csv_path, &before)) {
+        return import_csv_file(csv_path, date_format, options);
+    }
+    {
+        DatasetCache cache;
+        if (cache.open(cache_path, nullptr) && cache.matches(before, date_format)) {
+            ImportResult result = cache.to_import_result(options.layout, options.issue_samples);
+            STOCKBT_STATS(result.stats.from_cache = true);
+            return result;
+        }
     }
 
-    result.candles = std::move(deduped);
+    ImportResult result = import_csv_file(csv_path, date_format, options);
+    SourceStamp after;
+    // Skip the write if the CSV changed while it was being parsed.
+    if (result.success && read_source_stamp(csv_path, &after) && after == before) {
+        write_dataset_cache(cache_path, result, date_format, before, nullptr);
+    }
+    return result;
+}
+
+// Collects the ascending rows of stream_ohlcv into a fixed chunk buffer. The newest
+// row is held back until a later timestamp arrives, so duplicates that straddle a chunk
+// boundary still keep the last row.
+class ChunkAssembler {
+public:
+    ChunkAssembler(std::size_t chunk_rows, const StreamChunkFn& on_chunk, StreamImportResult* result)
+        : on_chunk_(on_chunk), result_(result) {
+        chunk_.resize(std::max<std::size_t>(1, chunk_rows));
+    }
+
+    bool add(const Candle& row, std::size_t line_number) {
+        if (has_pending_) {
+            if (row.ts == pending_.ts) {
+                pending_ = row;
+                ++result_->duplicates_removed;
+                return true;
+            }
+            if (row.ts < pending_.ts) {
+                append_issue(&result_->errors,
+                             line_number,
+                             "Timestamp is before the previous row; streaming requires ascending timestamps");
+                return false;
+            }
+            if (!push(pending_)) {
+                return false;
+            }
+        }
+        pending_ = row;
+        has_pending_ = true;
+        return true;
+    }
+
+    bool finish() {
+        if (has_pending_) {
+            has_pending_ = false;
+            if (!push(pending_)) {
+                return false;
+            }
+        }
+        return flush();
+    }
+
+private:
+    bool push(const Candle& row) {
+        DatasetMetadata& dataset = result_->dataset;
+        if (dataset.rows == 0) {
+            dataset.start_ts = row.ts;
+        }
+        ++dataset.rows;
+        dataset.end_ts = row.ts;
+        chunk_.set(used_++, row);
+        return used_ < chunk_.size() || flush();
+    }
+
+    bool flush() {
+        if (used_ == 0) {
+            return true;
+        }
+        const ColumnsView chunk = ColumnsView(chunk_).subview(0, used_);
+        used_ = 0;
+        std::string error;
+        if (on_chunk_(chunk, &error)) {
+            return true;
+        }
+        append_issue(&result_->errors, 0, error.empty() ? "Stream stopped by the chunk consumer" : error);
+        return false;
+    }
+
+    const StreamChunkFn& on_chunk_;
+    StreamImportResult* result_;
+    SeriesColumns chunk_;
+    std::size_t used_{0};
+    Candle pending_;
+    bool has_pending_{false};
+};
+
+StreamImportResult cancelled_stream() {
+    StreamImportResult result;
+    append_issue(&result.errors, 0, "Import cancelled");
+    return result;
+}
+
+// The success, warning and error rules of finalize_import, without the sort.
+void finalize_stream(StreamImportResult* result) {
+    if (result->dataset.rows == 0) {
+        append_issue(&result->errors, 0, "Import failed: zero valid rows remain after filtering");
+        const std::vector<ImportIssue> row_issues = describe_row_issues(result->row_issues);
+        result->errors.insert(result->errors.end(), row_issues.begin(), row_issues.end());
+        return;
+    }
+    if (result->duplicates_removed > 0) {
+        std::ostringstream oss;
+        oss << "Duplicate timestamps detected. Kept last occurrence for " << result->duplicates_removed
+            << " row(s).";
+        append_issue(&result->warnings, 0, oss.str());
+    }
+    result->success = true;
+    result->partial_success = result->dropped_rows > 0;
+    if (result->partial_success) {
+        const std::vector<ImportIssue> row_issues = describe_row_issues(result->row_issues);
+        result->warnings.insert(result->warnings.end(), row_issues.begin(), row_issues.end());
+    }
+}
+
+// With a mapping, the lines already read are released every ProgressToken::kInterval
+// lines so resident memory does not grow with the file.
+template <typename LineReader>
+StreamImportResult stream_lines(LineReader& reader,
+                                DateFormat date_format,
+                                const StreamImportOptions& options,
+                                std::size_t total_bytes,
+                                const MappedFile* mapped,
+                                const StreamChunkFn& on_chunk) {
+    StreamImportResult result;
+    ColumnLayout layout;
+    if (!read_header(reader, &layout, &result.errors)) {
+        return result;
+    }
+
+    // The parser only ever holds the row of the current line.
+    RowParser<Series> parser(layout, date_format, options.issue_samples);
+    ChunkAssembler chunks(options.chunk_rows, on_chunk, &result);
+    std::string_view line;
+    std::size_t line_number = 2;
+    std::size_t released = 0;
+    bool ok = true;
+    while (ok && reader.next(&line)) {
+        parser.parse_line(line, line_number);
+        if (!parser.rows.empty()) {
+            ok = chunks.add(parser.rows.back(), line_number);
+            parser.rows.clear();
+        }
+        ++line_number;
+        if ((line_number - 2) % ProgressToken::kInterval == 0) {
+            if (mapped != nullptr) {
+                mapped->release(released, reader.consumed() - released);
+                released = reader.consumed();
+            }
+            if (is_cancelled(options.progress)) {
+                break;
+            }
+            report_progress(options.progress, reader.consumed(), total_bytes);
+        }
+    }
+    if (is_cancelled(options.progress)) {
+        return cancelled_stream();
+    }
+    ok = ok && chunks.finish();
+    result.dropped_rows = parser.dropped;
+    result.row_issues = std::move(parser.issues);
+    if (ok) {
+        finalize_stream(&result);
+    }
+    return result;
+}
+
+StreamImportResult stream_csv_file(const std::string& csv_path,
+                                   DateFormat date_format,
+                                   const StreamImportOptions& options,
+                                   const StreamChunkFn& on_chunk) {
+    if (options.memory_map) {
+        MappedFile mapped;
+        if (mapped.open(csv_path, nullptr)) {
+            MappedLineReader reader(mapped.data(), mapped.size());
+            return stream_lines(reader, date_format, options, mapped.size(), &mapped, on_chunk);
+        }
+    }
+
+    std::ifstream in(csv_path);
+    if (!in.is_open()) {
+        StreamImportResult result;
+        append_issue(&result.errors, 0, "Unable to open CSV file: " + csv_path);
+        return result;
+    }
+    std::error_code ec;
+    const auto file_bytes = std::filesystem::file_size(csv_path, ec);
+    StreamLineReader reader(in);
+    return stream_lines(reader, date_format, options, ec ? 0 : static_cast<std::size_t>(file_bytes), nullptr, on_chunk);
+}
+
+StreamImportResult stream_dataset_cache(const std::string& cache_path,
+                                        const StreamImportOptions& options,
+                                        const StreamChunkFn& on_chunk) {
+    StreamImportResult result;
+    DatasetCache cache;
+    std::string error;
+    if (!cache.open(cache_path, &error)) {
+        append_issue(&result.errors, 0, error);
+        return result;
+    }
+
+    const ColumnsView columns = cache.columns();
+    const std::size_t chunk_rows = std::max<std::size_t>(1, options.chunk_rows);
+    for (std::size_t begin = 0; begin < columns.size(); begin += chunk_rows) {
+        if (is_cancelled(options.progress)) {
+            return cancelled_stream();
+        }
+        if (!on_chunk(columns.subview(begin, chunk_rows), &error)) {
+            append_issue(&result.errors, 0, error.empty() ? "Stream stopped by the chunk consumer" : error);
+            return result;
+        }
+        cache.release_rows(begin, std::min(columns.size(), begin + chunk_rows));
+        report_progress(options.progress, std::min(columns.size(), begin + chunk_rows), columns.size());
+    }
+
+    if (columns.empty()) {
+        append_issue(&result.errors, 0, "Import failed: zero valid rows remain after filtering");
+        return result;
+    }
+    result.dataset = cache.metadata();
+    result.dropped_rows = cache.dropped_rows();
+    result.row_issues = cache.row_issues();
+    result.warnings = cache.warnings();
+    limit_row_issue_samples(options.issue_samples, &result.row_issues, &result.warnings);
+    result.partial_success = cache.partial_success();
     result.success = true;
-    result.partial_success = result.dropped_rows > 0;
+    return result;
+}
+
+} // namespace
+
+void split_csv_fields(std::string_view line, std::vector<std::string_view>* fields, std::vector<std::string>* storage) {
+    fields->clear();
+    if (line.find('"') != std::string_view::npos) {
+        *storage = parse_csv_line(line);
+        for (const std::string& field : *storage) {
+            fields->push_back(field);
+        }
+        return;
+    }
+
+    std::size_t start = 0;
+    for (;;) {
+        const std::size_t comma = line.find(',', start);
+        if (comma == std::string_view::npos) {
+            fields->push_back(trim_view(line.substr(start)));
+            return;
+        }
+        fields->push_back(trim_view(line.substr(start, comma - start)));
+        start = comma + 1;
+    }
+}
 
-    if (result.partial_success) {
-        result.warnings.insert(result.warnings.end(), row_issues.begin(), row_issues.end());
+// Accepts exactly what strtod accepted before: from_chars handles the common
+// decimal forms, anything else (leading '+', hex floats, subnormals that strtod
+// reports as ERANGE) goes through strtod.
+bool parse_csv_number(std::string_view text, double* out) {
+    const std::string_view t = trim_view(text);
+    if (t.empty()) {
+        return false;
     }
 
+    std::string_view digits = t;
+    if (digits.front() == '+') {
+        digits.remove_prefix(1);
+        if (digits.empty() || digits.front() == '+' || digits.front() == '-') {
+            return parse_double_strtod(t, out);
+        }
+    }
+
+    double value = 0.0;
+    const char* end = digits.data() + digits.size();
+    const auto parsed = std::from_chars(digits.data(), end, value);
+    if (parsed.ec == std::errc() && parsed.ptr == end && (value == 0.0 || !(std::fabs(value) < DBL_MIN))) {
+        *out = value;
+        return true;
+    }
+    return parse_double_strtod(t, out);
+}
+
+namespace {
+
+// The algorithms below work on Series and on the (ts, index) entries that order a
+// SeriesColumns; they only read .ts and copy whole rows.
+
+// Keeps the last row of each timestamp of sorted rows, compacting in place.
+template <typename Row>
+std::size_t dedupe_sorted(std::vector<Row>* rows) {
+    std::vector<Row>& r = *rows;
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        if (out > 0 && r[out - 1].ts == r[i].ts) {
+            r[out - 1] = r[i];
+        } else {
+            r[out++] = r[i];
+        }
+    }
+    const std::size_t removed = r.size() - out;
+    r.resize(out);
+    return removed;
+}
+
+// Newest-first files: reversing restores ascending order, and reversing each group of
+// equal timestamps back restores their file order.
+template <typename Row>
+void reverse_descending(std::vector<Row>* rows) {
+    std::reverse(rows->begin(), rows->end());
+    auto group = rows->begin();
+    while (group != rows->end()) {
+        const int64_t ts = group->ts;
+        const auto group_end = std::find_if(group, rows->end(), [ts](const Row& row) { return row.ts != ts; });
+        std::reverse(group, group_end);
+        group = group_end;
+    }
+}
+
+// Mostly sorted input: the stragglers (rows below the running maximum) move to a side
+// list, leaving an ascending subsequence in place, and the stably sorted side list is
+// merged back in from the end. Equal timestamps keep file order: every remaining row
+// with a straggler's timestamp precedes it in the file.
+template <typename Row>
+void merge_stragglers(std::vector<Row>* rows, std::size_t stragglers) {
+    std::vector<Row>& r = *rows;
+    std::vector<Row> side;
+    side.reserve(stragglers);
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        if (kept == 0 || r[i].ts >= r[kept - 1].ts) {
+            r[kept++] = r[i];
+        } else {
+            side.push_back(r[i]);
+        }
+    }
+    std::stable_sort(side.begin(), side.end(), [](const Row& a, const Row& b) { return a.ts < b.ts; });
+
+    std::size_t out = r.size();
+    std::size_t pending = side.size();
+    while (pending > 0) {
+        if (kept > 0 && side[pending - 1].ts < r[kept - 1].ts) {
+            r[--out] = r[--kept];
+        } else {
+            r[--out] = side[--pending];
+        }
+    }
+}
+
+template <typename Row>
+std::size_t sort_and_dedupe_rows(std::vector<Row>* rows, bool* unsorted) {
+    std::vector<Row>& r = *rows;
+    bool descends = false;
+    bool non_increasing = true;
+    std::size_t stragglers = 0;
+    int64_t running_max = r.empty() ? 0 : r[0].ts;
+    for (std::size_t i = 1; i < r.size(); ++i) {
+        descends = descends || r[i].ts < r[i - 1].ts;
+        non_increasing = non_increasing && r[i].ts <= r[i - 1].ts;
+        stragglers += (r[i].ts < running_max) ? 1 : 0;
+        running_max = std::max(running_max, r[i].ts);
+    }
+    *unsorted = descends;
+
+    // Sorted input (the common case) is only deduped; a second full-size buffer is
+    // needed only by the stable sort of heavily shuffled input.
+    if (descends) {
+        if (non_increasing) {
+            reverse_descending(rows);
+        } else if (stragglers <= r.size() / 8) {
+            merge_stragglers(rows, stragglers);
+        } else {
+            std::stable_sort(r.begin(), r.end(), [](const Row& a, const Row& b) { return a.ts < b.ts; });
+        }
+    }
+    return dedupe_sorted(rows);
+}
+
+struct RowOrder {
+    int64_t ts;
+    std::size_t index;
+};
+
+template <typename T>
+void gather(const std::vector<RowOrder>& order, std::vector<T>* column, std::vector<T>* buffer) {
+    buffer->resize(order.size());
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        (*buffer)[k] = (*column)[order[k].index];
+    }
+    std::swap(*column, *buffer);
+}
+
+std::size_t sort_and_dedupe_columns(SeriesColumns* columns, bool* unsorted) {
+    const std::vector<int64_t>& ts = columns->ts;
+    const std::size_t n = ts.size();
+    bool descends = false;
+    for (std::size_t i = 1; i < n && !descends; ++i) {
+        descends = ts[i] < ts[i - 1];
+    }
+
+    // Sorted input is deduped in place, row by row across the columns.
+    if (!descends) {
+        *unsorted = false;
+        const ColumnsView rows(*columns);
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t to = (out > 0 && ts[out - 1] == ts[i]) ? out - 1 : out++;
+            if (to != i) {
+                columns->set(to, rows[i]);
+            }
+        }
+        columns->resize(out);
+        return n - out;
+    }
+
+    // Otherwise the rows are ordered as (ts, index) entries, and each column is then
+    // gathered through one spare buffer, so no full copy of the candles is made.
+    std::vector<RowOrder> order(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        order[i] = RowOrder{ts[i], i};
+    }
+    const std::size_t removed = sort_and_dedupe_rows(&order, unsorted);
+    std::vector<double> buffer;
+    for (std::vector<double>* column : {&columns->o, &columns->h, &columns->l, &columns->c, &columns->v}) {
+        gather(order, column, &buffer);
+    }
+    columns->ts.resize(order.size());
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        columns->ts[k] = order[k].ts;
+    }
+    return removed;
+}
+
+} // namespace
+
+std::size_t sort_and_dedupe_candles(Series* rows, bool* unsorted) {
+    return sort_and_dedupe_rows(rows, unsorted);
+}
+
+ImportResult import_ohlcv_csv(const std::string& csv_path, DateFormat date_format) {
+    return import_ohlcv_csv(csv_path, date_format, ImportOptions{});
+}
+
+ImportResult import_ohlcv_csv(const std::string& csv_path, DateFormat date_format, const ImportOptions& options) {
+    double total_ms = 0.0;
+    ImportResult result;
+    {
+        STOCKBT_TIME_SCOPE(&total_ms);
+        result = import_any(csv_path, date_format, options);
+    }
+    STOCKBT_STATS(result.stats.collected = true);
+    STOCKBT_STATS(result.stats.total_ms = total_ms);
+    if (!is_cancelled(options.progress)) {
+        report_progress(options.progress, 1, 1);
+    }
+    return result;
+}
+
+StreamImportResult stream_ohlcv(const std::string& path,
+                                DateFormat date_format,
+                                const StreamImportOptions& options,
+                                const StreamChunkFn& on_chunk) {
+    StreamImportResult result = (std::filesystem::path(path).extension() == ".sbt")
+                                    ? stream_dataset_cache(path, options, on_chunk)
+                                    : stream_csv_file(path, date_format, options, on_chunk);
+    if (!is_cancelled(options.progress)) {
+        report_progress(options.progress, 1, 1);
+    }
     return result;
 }
 
+const char* row_drop_message(RowDropReason reason) {
+    switch (reason) {
+    case RowDropReason::MissingFields:
+        return "Dropped row: missing one or more required field values";
+    case RowDropReason::InvalidTimestamp:
+        return "Dropped row: invalid timestamp format";
+    case RowDropReason::InvalidNumber:
+        return "Dropped row: invalid numeric value";
+    case RowDropReason::NonPositivePrice:
+        return "Dropped row: prices must be > 0";
+    case RowDropReason::NegativeVolume:
+        return "Dropped row: volume must be >= 0";
+    }
+    return "Dropped row";
+}
+
+std::vector<ImportIssue> describe_row_issues(const RowIssueSummary& summary) {
+    std::vector<std::pair<std::size_t, RowDropReason>> samples;
+    for (std::size_t reason = 0; reason < kRowDropReasons; ++reason) {
+        for (std::size_t line : summary.sample_lines[reason]) {
+            samples.emplace_back(line, static_cast<RowDropReason>(reason));
+        }
+    }
+    std::sort(samples.begin(), samples.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<ImportIssue> issues;
+    issues.reserve(samples.size() + kRowDropReasons);
+    for (const auto& sample : samples) {
+        issues.push_back({sample.first, row_drop_message(sample.second)});
+    }
+    for (std::size_t reason = 0; reason < kRowDropReasons; ++reason) {
+        const std::size_t listed = summary.sample_lines[reason].size();
+        if (summary.counts[reason] > listed) {
+            issues.push_back({0, std::string(row_drop_message(static_cast<RowDropReason>(reason))) + " (" +
+                                     std::to_string(summary.counts[reason] - listed) + " more rows)"});
+        }
+    }
+    return issues;
+}
+
+void limit_row_issue_samples(std::size_t samples, RowIssueSummary* summary, std::vector<ImportIssue>* warnings) {
+    RowIssueSummary limited = *summary;
+    if (!limited.limit_samples(samples)) {
+        return;
+    }
+    const std::size_t described = describe_row_issues(*summary).size();
+    if (described <= warnings->size()) {
+        warnings->resize(warnings->size() - described);
+        const std::vector<ImportIssue> row_issues = describe_row_issues(limited);
+        warnings->insert(warnings->end(), row_issues.begin(), row_issues.end());
+    }
+    *summary = std::move(limited);
+}
+
 } // namespace stockbt
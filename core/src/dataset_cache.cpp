@@ -0,0 +1,231 @@
+#include "backtest/dataset_cache.hpp"
+
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "backtest/csv_importer.hpp"
+#include "columnar_file.hpp"
+
+namespace stockbt {
+
+namespace {
+
+// Bump whenever CSV parsing rules change so caches written by an older importer are rebuilt.
+// Version 2 added the row issue summary after the warnings; version 3 keeps the time of
+// 'T'-separated ISO timestamps.
+constexpr uint32_t kImporterVersion = 3;
+
+const char* const kColumnNames[] = {"ts", "o", "h", "l", "c", "v"};
+
+} // namespace
+
+bool read_source_stamp(const std::string& path, SourceStamp* stamp) {
+    std::error_code ec;
+    const std::filesystem::path file(path);
+    const auto size = std::filesystem::file_size(file, ec);
+    if (ec) {
+        return false;
+    }
+    const auto mtime = std::filesystem::last_write_time(file, ec);
+    if (ec) {
+        return false;
+    }
+    stamp->size = static_cast<uint64_t>(size);
+    stamp->mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+std::string dataset_cache_path(const std::string& csv_path) {
+    return std::filesystem::path(csv_path).replace_extension(".sbt").string();
+}
+
+bool write_dataset_cache(const std::string& cache_path,
+                         const ImportResult& import,
+                         DateFormat date_format,
+                         const SourceStamp& source,
+                         std::string* error) {
+    if (!import.success) {
+        if (error != nullptr) {
+            *error = "Only successful imports can be cached";
+        }
+        return false;
+    }
+
+    // Column imports are written as they are; row imports are read field by field with
+    // the stride of a Candle rather than transposed first.
+    const bool from_rows = !import.candles.empty();
+    const std::size_t rows = from_rows ? import.candles.size() : import.columns.size();
+    const int64_t start_ts = from_rows ? import.candles.front().ts : (rows > 0 ? import.columns.ts.front() : 0);
+    const int64_t end_ts = from_rows ? import.candles.back().ts : (rows > 0 ? import.columns.ts.back() : 0);
+
+    columnar::ByteWriter meta;
+    meta.put<uint32_t>(kImporterVersion);
+    meta.put<uint32_t>(static_cast<uint32_t>(date_format));
+    meta.put<uint64_t>(source.size);
+    meta.put<int64_t>(source.mtime);
+    meta.put<uint8_t>(import.partial_success ? 1 : 0);
+    meta.put<uint64_t>(import.dropped_rows);
+    meta.put<uint64_t>(rows);
+    meta.put<int64_t>(start_ts);
+    meta.put<int64_t>(end_ts);
+    meta.put<uint64_t>(import.warnings.size());
+    for (const ImportIssue& warning : import.warnings) {
+        meta.put<uint64_t>(warning.line);
+        meta.put_string(warning.message);
+    }
+    for (std::size_t reason = 0; reason < kRowDropReasons; ++reason) {
+        meta.put<uint64_t>(import.row_issues.counts[reason]);
+        meta.put<uint64_t>(import.row_issues.sample_lines[reason].size());
+        for (std::size_t line : import.row_issues.sample_lines[reason]) {
+            meta.put<uint64_t>(line);
+        }
+    }
+
+    std::vector<columnar::ColumnSource> columns;
+    if (from_rows) {
+        const Candle& first = import.candles.front();
+        const void* fields[6] = {&first.ts, &first.o, &first.h, &first.l, &first.c, &first.v};
+        for (std::size_t i = 0; i < 6; ++i) {
+            columns.push_back({kColumnNames[i],
+                               (i == 0) ? columnar::ColumnType::Int64 : columnar::ColumnType::Float64,
+                               fields[i],
+                               rows * 8,
+                               columnar::Encoding::Raw,
+                               sizeof(Candle)});
+        }
+    } else {
+        const SeriesColumns& data = import.columns;
+        columns.push_back({kColumnNames[0], columnar::ColumnType::Int64, data.ts.data(), rows * sizeof(int64_t)});
+        const std::vector<double>* values[5] = {&data.o, &data.h, &data.l, &data.c, &data.v};
+        for (std::size_t i = 0; i < 5; ++i) {
+            columns.push_back(
+                {kColumnNames[i + 1], columnar::ColumnType::Float64, values[i]->data(), rows * sizeof(double)});
+        }
+    }
+
+    return columnar::write_file(cache_path, columnar::FileKind::Dataset, rows, meta.data(), columns, error);
+}
+
+bool DatasetCache::open(const std::string& cache_path, std::string* error) {
+    *this = DatasetCache();
+    if (!file_.open(cache_path, error)) {
+        return false;
+    }
+
+    auto fail = [&](const std::string& message) {
+        *this = DatasetCache();
+        if (error != nullptr) {
+            *error = message + ": " + cache_path;
+        }
+        return false;
+    };
+
+    columnar::Reader reader;
+    std::string reader_error;
+    if (!reader.open(file_.data(), file_.size(), columnar::FileKind::Dataset, &reader_error)) {
+        return fail(reader_error);
+    }
+
+    columnar::ByteReader meta = reader.meta();
+    uint32_t date_format = 0;
+    uint64_t source_size = 0;
+    uint8_t partial = 0;
+    uint64_t dropped = 0;
+    uint64_t meta_rows = 0;
+    uint64_t warning_count = 0;
+    if (!meta.get(&importer_version_) || !meta.get(&date_format) || !meta.get(&source_size) ||
+        !meta.get(&source_.mtime) || !meta.get(&partial) || !meta.get(&dropped) || !meta.get(&meta_rows) ||
+        !meta.get(&metadata_.start_ts) || !meta.get(&metadata_.end_ts) || !meta.get(&warning_count)) {
+        return fail("Corrupt dataset metadata");
+    }
+    for (uint64_t i = 0; i < warning_count; ++i) {
+        uint64_t line = 0;
+        ImportIssue warning;
+        if (!meta.get(&line) || !meta.get_string(&warning.message)) {
+            return fail("Corrupt dataset warnings");
+        }
+        warning.line = static_cast<std::size_t>(line);
+        warnings_.push_back(std::move(warning));
+    }
+    // Older caches end after the warnings; they never match() and load without a summary.
+    for (std::size_t reason = 0; importer_version_ >= 2 && reason < kRowDropReasons; ++reason) {
+        uint64_t count = 0;
+        uint64_t samples = 0;
+        if (!meta.get(&count) || !meta.get(&samples) || samples > count) {
+            return fail("Corrupt dataset row issues");
+        }
+        row_issues_.counts[reason] = static_cast<std::size_t>(count);
+        for (uint64_t i = 0; i < samples; ++i) {
+            uint64_t line = 0;
+            if (!meta.get(&line)) {
+                return fail("Corrupt dataset row issues");
+            }
+            row_issues_.sample_lines[reason].push_back(static_cast<std::size_t>(line));
+        }
+    }
+    if (meta_rows != reader.row_count() || date_format > static_cast<uint32_t>(DateFormat::Dmy)) {
+        return fail("Corrupt dataset metadata");
+    }
+
+    ts_ = static_cast<const int64_t*>(reader.raw_column(kColumnNames[0], columnar::ColumnType::Int64));
+    const double** values[5] = {&o_, &h_, &l_, &c_, &v_};
+    for (std::size_t i = 0; i < 5; ++i) {
+        *values[i] = static_cast<const double*>(reader.raw_column(kColumnNames[i + 1], columnar::ColumnType::Float64));
+        if (*values[i] == nullptr) {
+            return fail("Missing dataset column");
+        }
+    }
+    if (ts_ == nullptr) {
+        return fail("Missing dataset column");
+    }
+
+    rows_ = static_cast<std::size_t>(meta_rows);
+    metadata_.rows = rows_;
+    source_.size = source_size;
+    date_format_ = static_cast<DateFormat>(date_format);
+    partial_success_ = partial != 0;
+    dropped_rows_ = static_cast<std::size_t>(dropped);
+    return true;
+}
+
+bool DatasetCache::matches(const SourceStamp& source, DateFormat date_format) const {
+    return file_.is_open() && importer_version_ == kImporterVersion && source_ == source &&
+           date_format_ == date_format;
+}
+
+void DatasetCache::release_rows(std::size_t begin, std::size_t end) const {
+    const void* columns[] = {ts_, o_, h_, l_, c_, v_};
+    for (const void* column : columns) {
+        if (column != nullptr && begin < end) {
+            const auto offset = static_cast<std::size_t>(static_cast<const char*>(column) - file_.data());
+            file_.release(offset + begin * 8, (end - begin) * 8);
+        }
+    }
+}
+
+ImportResult DatasetCache::to_import_result(SeriesLayout layout, std::size_t issue_samples) const {
+    ImportResult result;
+    if (!file_.is_open()) {
+        return result;
+    }
+    if (layout == SeriesLayout::Columns) {
+        result.columns.ts.assign(ts_, ts_ + rows_);
+        result.columns.o.assign(o_, o_ + rows_);
+        result.columns.h.assign(h_, h_ + rows_);
+        result.columns.l.assign(l_, l_ + rows_);
+        result.columns.c.assign(c_, c_ + rows_);
+        result.columns.v.assign(v_, v_ + rows_);
+    } else {
+        result.candles = to_series(columns());
+    }
+    result.warnings = warnings_;
+    result.row_issues = row_issues_;
+    limit_row_issue_samples(issue_samples, &result.row_issues, &result.warnings);
+    result.dropped_rows = dropped_rows_;
+    result.partial_success = partial_success_;
+    result.success = true;
+    return result;
+}
+
+} // namespace stockbt
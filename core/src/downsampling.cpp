@@ -1,21 +1,39 @@
 #include "backtest/downsampling.hpp"
 
 #include <algorithm>
+#include <memory>
+#include <utility>
 
 namespace stockbt {
+namespace {
 
-std::vector<BucketMinMax> downsample_bucket_min_max(const std::vector<SeriesPoint>& points,
-                                                     std::size_t pixel_width,
-                                                     std::size_t display_cap) {
-    if (points.empty() || pixel_width == 0) {
+struct PointRows {
+    const SeriesPoint* points;
+    int64_t ts(std::size_t i) const { return points[i].ts; }
+    double value(std::size_t i) const { return points[i].value; }
+};
+
+struct PointColumns {
+    const int64_t* ts_column;
+    const double* values;
+    int64_t ts(std::size_t i) const { return ts_column[i]; }
+    double value(std::size_t i) const { return values[i]; }
+};
+
+template <typename Points>
+std::vector<BucketMinMax> downsample_impl(const Points& points,
+                                          std::size_t count,
+                                          std::size_t pixel_width,
+                                          std::size_t display_cap) {
+    if (count == 0 || pixel_width == 0) {
         return {};
     }
 
-    if (points.size() <= display_cap) {
+    if (count <= display_cap) {
         std::vector<BucketMinMax> out;
-        out.reserve(points.size());
-        for (const SeriesPoint& p : points) {
-            out.push_back({p.ts, p.value, p.ts, p.value});
+        out.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            out.push_back({points.ts(i), points.value(i), points.ts(i), points.value(i)});
         }
         return out;
     }
@@ -25,8 +43,8 @@ std::vector<BucketMinMax> downsample_bucket_min_max(const std::vector<SeriesPoin
     out.reserve(bucket_count);
 
     for (std::size_t b = 0; b < bucket_count; ++b) {
-        const std::size_t start = (b * points.size()) / bucket_count;
-        const std::size_t end = ((b + 1) * points.size()) / bucket_count;
+        const std::size_t start = (b * count) / bucket_count;
+        const std::size_t end = ((b + 1) * count) / bucket_count;
         if (start >= end) {
             continue;
         }
@@ -34,17 +52,151 @@ std::vector<BucketMinMax> downsample_bucket_min_max(const std::vector<SeriesPoin
         std::size_t min_idx = start;
         std::size_t max_idx = start;
         for (std::size_t i = start + 1; i < end; ++i) {
-            if (points[i].value < points[min_idx].value) {
+            if (points.value(i) < points.value(min_idx)) {
                 min_idx = i;
             }
-            if (points[i].value > points[max_idx].value) {
+            if (points.value(i) > points.value(max_idx)) {
                 max_idx = i;
             }
         }
 
-        out.push_back({points[min_idx].ts, points[min_idx].value, points[max_idx].ts, points[max_idx].value});
+        out.push_back({points.ts(min_idx), points.value(min_idx), points.ts(max_idx), points.value(max_idx)});
+    }
+
+    return out;
+}
+
+} // namespace
+
+std::vector<BucketMinMax> downsample_bucket_min_max(const std::vector<SeriesPoint>& points,
+                                                     std::size_t pixel_width,
+                                                     std::size_t display_cap) {
+    return downsample_impl(PointRows{points.data()}, points.size(), pixel_width, display_cap);
+}
+
+std::vector<BucketMinMax> downsample_bucket_min_max(const int64_t* ts,
+                                                     const double* values,
+                                                     std::size_t count,
+                                                     std::size_t pixel_width,
+                                                     std::size_t display_cap) {
+    return downsample_impl(PointColumns{ts, values}, count, pixel_width, display_cap);
+}
+
+MinMaxPyramid::MinMaxPyramid(const std::vector<SeriesPoint>& points) {
+    auto ts = std::make_shared<std::vector<int64_t>>();
+    ts->reserve(points.size());
+    values_.reserve(points.size());
+    for (const SeriesPoint& point : points) {
+        ts->push_back(point.ts);
+        values_.push_back(point.value);
     }
+    ts_ = std::move(ts);
+    build_levels();
+}
+
+MinMaxPyramid::MinMaxPyramid(std::shared_ptr<const std::vector<int64_t>> ts, std::vector<double> values)
+    : ts_(std::move(ts)), values_(std::move(values)) {
+    build_levels();
+}
 
+void MinMaxPyramid::build_levels() {
+    std::size_t count = values_.size();
+    while (count > 1) {
+        const Level* below = levels_.empty() ? nullptr : &levels_.back();
+        Level level;
+        const std::size_t nodes = (count + kFanout - 1) / kFanout;
+        level.min_index.resize(nodes);
+        level.max_index.resize(nodes);
+        for (std::size_t node = 0; node < nodes; ++node) {
+            const std::size_t first = node * kFanout;
+            const std::size_t last = std::min(first + kFanout, count);
+            std::size_t min_idx = below ? below->min_index[first] : first;
+            std::size_t max_idx = below ? below->max_index[first] : first;
+            for (std::size_t child = first + 1; child < last; ++child) {
+                const std::size_t child_min = below ? below->min_index[child] : child;
+                const std::size_t child_max = below ? below->max_index[child] : child;
+                if (values_[child_min] < values_[min_idx]) {
+                    min_idx = child_min;
+                }
+                if (values_[child_max] > values_[max_idx]) {
+                    max_idx = child_max;
+                }
+            }
+            level.min_index[node] = min_idx;
+            level.max_index[node] = max_idx;
+        }
+        levels_.push_back(std::move(level));
+        count = nodes;
+    }
+}
+
+BucketMinMax MinMaxPyramid::range_min_max(std::size_t begin, std::size_t end) const {
+    std::size_t min_idx = begin;
+    std::size_t max_idx = begin;
+    auto take = [&](std::size_t level, std::size_t node) {
+        const std::size_t node_min = (level == 0) ? node : levels_[level - 1].min_index[node];
+        const std::size_t node_max = (level == 0) ? node : levels_[level - 1].max_index[node];
+        const double min_value = values_[node_min];
+        const double max_value = values_[node_max];
+        if (min_value < values_[min_idx] || (min_value == values_[min_idx] && node_min < min_idx)) {
+            min_idx = node_min;
+        }
+        if (max_value > values_[max_idx] || (max_value == values_[max_idx] && node_max < max_idx)) {
+            max_idx = node_max;
+        }
+    };
+
+    // Peel unaligned nodes off both ends, then continue one level up.
+    std::size_t lo = begin;
+    std::size_t hi = end;
+    for (std::size_t level = 0; lo < hi; ++level) {
+        while (lo < hi && lo % kFanout != 0) {
+            take(level, lo++);
+        }
+        while (lo < hi && hi % kFanout != 0) {
+            take(level, --hi);
+        }
+        lo /= kFanout;
+        hi /= kFanout;
+    }
+    return {ts(min_idx), values_[min_idx], ts(max_idx), values_[max_idx]};
+}
+
+std::vector<BucketMinMax> MinMaxPyramid::query(int64_t t0,
+                                               int64_t t1,
+                                               std::size_t pixel_width,
+                                               std::size_t display_cap) const {
+    if (values_.empty() || pixel_width == 0) {
+        return {};
+    }
+    const int64_t* ts_begin = ts_->data();
+    const int64_t* ts_end = ts_begin + values_.size();
+    const int64_t* first = std::lower_bound(ts_begin, ts_end, t0);
+    const int64_t* last = std::upper_bound(first, ts_end, t1);
+    const std::size_t begin = static_cast<std::size_t>(first - ts_begin);
+    const std::size_t count = static_cast<std::size_t>(last - first);
+    if (count == 0) {
+        return {};
+    }
+
+    std::vector<BucketMinMax> out;
+    if (count <= display_cap) {
+        out.reserve(count);
+        for (std::size_t i = begin; i < begin + count; ++i) {
+            out.push_back({ts(i), values_[i], ts(i), values_[i]});
+        }
+        return out;
+    }
+
+    const std::size_t bucket_count = std::max<std::size_t>(1, std::min(pixel_width, display_cap / 2));
+    out.reserve(bucket_count);
+    for (std::size_t b = 0; b < bucket_count; ++b) {
+        const std::size_t start = (b * count) / bucket_count;
+        const std::size_t end = ((b + 1) * count) / bucket_count;
+        if (start < end) {
+            out.push_back(range_min_max(begin + start, begin + end));
+        }
+    }
     return out;
 }
 
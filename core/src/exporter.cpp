@@ -1,20 +1,242 @@
 #include "backtest/exporter.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <deque>
 #include <fstream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
+#include <string_view>
+#include <vector>
 
+#include "backtest/mapped_file.hpp"
 #include "backtest/time_utils.hpp"
+#include "columnar_file.hpp"
 
 namespace stockbt {
 namespace {
 
 const char* kDisclaimer = "Educational tool. Not investment advice. No live trading.";
 
+// Formats CSV rows into a reusable block and writes it out whole. Numbers match
+// std::fixed << std::setprecision(10) output and timestamps match
+// format_timestamp_utc_iso8601, so files are byte-identical to stream formatting.
+class BlockWriter {
+public:
+    explicit BlockWriter(std::ofstream& out) : out_(out), buffer_(kBlockSize) {}
+
+    void put(char ch) {
+        reserve(1);
+        buffer_[used_++] = ch;
+    }
+    void put(std::string_view text) {
+        reserve(text.size());
+        std::copy(text.begin(), text.end(), buffer_.data() + used_);
+        used_ += text.size();
+    }
+    void put_fixed(double value) {
+        reserve(kMaxNumber);
+        char* begin = buffer_.data() + used_;
+        const char* end = std::to_chars(begin, begin + kMaxNumber, value, std::chars_format::fixed, 10).ptr;
+        used_ += static_cast<std::size_t>(end - begin);
+    }
+    void put_int(int value) {
+        reserve(kMaxNumber);
+        char* begin = buffer_.data() + used_;
+        used_ += static_cast<std::size_t>(std::to_chars(begin, begin + kMaxNumber, value).ptr - begin);
+    }
+    void put_timestamp(int64_t ts) {
+        reserve(TimestampFormatter::kMaxLength);
+        char* begin = buffer_.data() + used_;
+        used_ += static_cast<std::size_t>(timestamps_.format_iso8601(ts, begin) - begin);
+    }
+
+    // Writes the remaining block; false when any write failed.
+    bool finish() {
+        flush();
+        out_.flush();
+        return static_cast<bool>(out_);
+    }
+
+private:
+    static constexpr std::size_t kBlockSize = std::size_t(1) << 20;
+    // Longest %.10f rendering of a double: sign, 309 integer digits, point, 10 decimals.
+    static constexpr std::size_t kMaxNumber = 328;
+
+    void reserve(std::size_t bytes) {
+        if (buffer_.size() - used_ < bytes) {
+            flush();
+            if (buffer_.size() < bytes) {
+                buffer_.resize(bytes);
+            }
+        }
+    }
+    void flush() {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+
+    std::ofstream& out_;
+    std::vector<char> buffer_;
+    std::size_t used_{0};
+    TimestampFormatter timestamps_;
+};
+
+bool finish_block(BlockWriter& writer, const char* what, const std::string& output_path, std::string* error) {
+    if (writer.finish()) {
+        return true;
+    }
+    if (error != nullptr) {
+        *error = std::string("Failed to write ") + what + " output path: " + output_path;
+    }
+    return false;
+}
+
+void put_equity_row(BlockWriter& writer, int64_t ts, double equity) {
+    writer.put_timestamp(ts);
+    writer.put(',');
+    writer.put_fixed(equity);
+    writer.put('\n');
+}
+
+void put_trade_row(BlockWriter& writer, const Trade& trade) {
+    writer.put_timestamp(trade.entry_time);
+    writer.put(',');
+    writer.put_fixed(trade.entry_price);
+    writer.put(',');
+    writer.put_timestamp(trade.exit_time);
+    writer.put(',');
+    writer.put_fixed(trade.exit_price);
+    writer.put(',');
+    writer.put_int(trade.qty);
+    writer.put(',');
+    writer.put_fixed(trade.pnl);
+    writer.put(',');
+    writer.put_fixed(trade.return_pct);
+    writer.put('\n');
+}
+
+const char* const kEquityHeader = "timestamp,equity\n";
+const char* const kTradesHeader = "entry_time,entry_price,exit_time,exit_price,qty,pnl,return_pct\n";
+
+// Bump whenever the columns or metadata of a binary export change. Version 2 added
+// the sweep cell, pruning columns and report info.
+constexpr uint32_t kBinaryExportVersion = 2;
+
+// Columns of one binary export, owned until written.
+class BinaryTable {
+public:
+    explicit BinaryTable(std::size_t rows) : rows_(rows) { meta_.put<uint32_t>(kBinaryExportVersion); }
+
+    // Export-specific metadata after the version.
+    columnar::ByteWriter& meta() { return meta_; }
+
+    std::vector<int64_t>& ints(const char* name) {
+        order_.push_back({name, columnar::ColumnType::Int64, ints_.size()});
+        ints_.emplace_back(rows_);
+        return ints_.back();
+    }
+    std::vector<double>& doubles(const char* name) {
+        order_.push_back({name, columnar::ColumnType::Float64, doubles_.size()});
+        doubles_.emplace_back(rows_);
+        return doubles_.back();
+    }
+
+    bool write(const std::string& path,
+               columnar::FileKind kind,
+               const BinaryExportOptions& options,
+               std::string* error) const {
+        std::vector<columnar::ColumnSource> columns;
+        for (const Column& column : order_) {
+            const bool is_int = column.type == columnar::ColumnType::Int64;
+            const void* data = is_int ? static_cast<const void*>(ints_[column.index].data())
+                                      : static_cast<const void*>(doubles_[column.index].data());
+            columns.push_back({column.name,
+                               column.type,
+                               data,
+                               rows_ * 8,
+                               options.compress ? columnar::Encoding::Varint : columnar::Encoding::Raw});
+        }
+        return columnar::write_file(path, kind, rows_, meta_.data(), columns, error);
+    }
+
+private:
+    struct Column {
+        const char* name;
+        columnar::ColumnType type;
+        std::size_t index;
+    };
+
+    std::size_t rows_;
+    columnar::ByteWriter meta_;
+    std::vector<Column> order_;
+    std::deque<std::vector<int64_t>> ints_;
+    std::deque<std::vector<double>> doubles_;
+};
+
+// Maps a binary export and checks its kind and layout version.
+class BinaryTableReader {
+public:
+    bool open(const std::string& path, columnar::FileKind kind, std::string* error) {
+        if (!file_.open(path, error)) {
+            return false;
+        }
+        std::string reader_error;
+        if (!reader_.open(file_.data(), file_.size(), kind, &reader_error)) {
+            return fail(reader_error, path, error);
+        }
+        meta_ = reader_.meta();
+        uint32_t version = 0;
+        if (!meta_.get(&version) || version != kBinaryExportVersion) {
+            return fail("Unsupported export version", path, error);
+        }
+        return true;
+    }
+
+    // Export-specific metadata after the version.
+    columnar::ByteReader& meta() { return meta_; }
+
+    std::size_t rows() const { return static_cast<std::size_t>(reader_.row_count()); }
+
+    template <typename T>
+    bool read(const char* name, std::vector<T>* values) {
+        ok_ = ok_ && reader_.read_column(name, values);
+        return ok_;
+    }
+
+    // False when any read failed.
+    bool finish(const std::string& path, std::string* error) const {
+        if (!ok_) {
+            return fail("Missing or corrupt export column", path, error);
+        }
+        return true;
+    }
+
+private:
+    static bool fail(const std::string& message, const std::string& path, std::string* error) {
+        if (error != nullptr) {
+            *error = message + ": " + path;
+        }
+        return false;
+    }
+
+    MappedFile file_;
+    columnar::Reader reader_;
+    columnar::ByteReader meta_{nullptr, 0};
+    bool ok_{true};
+};
+
+const char* const kMetricColumns[2][6] = {
+    {"train_return_pct", "train_total_pnl", "train_trades", "train_win_rate_pct", "train_avg_trade_pct",
+     "train_max_dd_pct"},
+    {"test_return_pct", "test_total_pnl", "test_trades", "test_win_rate_pct", "test_avg_trade_pct", "test_max_dd_pct"},
+};
+
 } // namespace
 
 bool export_equity_csv(const std::string& output_path,
-                       const Series& candles,
+                       CandleView candles,
                        const BacktestResult& result,
                        std::string* error) {
     std::ofstream out(output_path);
@@ -25,13 +247,13 @@ bool export_equity_csv(const std::string& output_path,
         return false;
     }
 
-    out << "timestamp,equity\n";
+    BlockWriter writer(out);
+    writer.put(kEquityHeader);
     const std::size_t count = std::min(candles.size(), result.equity.size());
-    out << std::fixed << std::setprecision(10);
     for (std::size_t i = 0; i < count; ++i) {
-        out << format_timestamp_utc_iso8601(candles[i].ts) << ',' << result.equity[i] << '\n';
+        put_equity_row(writer, candles[i].ts, result.equity[i]);
     }
-    return true;
+    return finish_block(writer, "equity", output_path, error);
 }
 
 bool export_trades_csv(const std::string& output_path,
@@ -45,16 +267,90 @@ bool export_trades_csv(const std::string& output_path,
         return false;
     }
 
-    out << "entry_time,entry_price,exit_time,exit_price,qty,pnl,return_pct\n";
-    out << std::fixed << std::setprecision(10);
+    BlockWriter writer(out);
+    writer.put(kTradesHeader);
     for (const Trade& trade : result.trades) {
-        out << format_timestamp_utc_iso8601(trade.entry_time) << ',' << trade.entry_price << ','
-            << format_timestamp_utc_iso8601(trade.exit_time) << ',' << trade.exit_price << ',' << trade.qty << ','
-            << trade.pnl << ',' << trade.return_pct << '\n';
+        put_trade_row(writer, trade);
     }
+    return finish_block(writer, "trades", output_path, error);
+}
+
+struct StreamingCsvExporter::Files {
+    std::string equity_path;
+    std::string trades_path;
+    std::ofstream equity_out;
+    std::ofstream trades_out;
+    std::unique_ptr<BlockWriter> equity;
+    std::unique_ptr<BlockWriter> trades;
+};
+
+StreamingCsvExporter::StreamingCsvExporter() = default;
+StreamingCsvExporter::~StreamingCsvExporter() = default;
+
+bool StreamingCsvExporter::open(const std::string& equity_path, const std::string& trades_path, std::string* error) {
+    auto files = std::make_unique<Files>();
+    files->equity_path = equity_path;
+    files->trades_path = trades_path;
+    if (!equity_path.empty()) {
+        files->equity_out.open(equity_path);
+        if (!files->equity_out.is_open()) {
+            if (error != nullptr) {
+                *error = "Failed to open equity output path: " + equity_path;
+            }
+            return false;
+        }
+        files->equity = std::make_unique<BlockWriter>(files->equity_out);
+        files->equity->put(kEquityHeader);
+    }
+    if (!trades_path.empty()) {
+        files->trades_out.open(trades_path);
+        if (!files->trades_out.is_open()) {
+            if (error != nullptr) {
+                *error = "Failed to open trades output path: " + trades_path;
+            }
+            return false;
+        }
+        files->trades = std::make_unique<BlockWriter>(files->trades_out);
+        files->trades->put(kTradesHeader);
+    }
+    files_ = std::move(files);
+    has_pending_ = false;
     return true;
 }
 
+void StreamingCsvExporter::trade(const Trade& trade) {
+    if (files_ && files_->trades) {
+        put_trade_row(*files_->trades, trade);
+    }
+}
+
+void StreamingCsvExporter::equity(int64_t ts, double value) {
+    if (has_pending_ && files_ && files_->equity) {
+        put_equity_row(*files_->equity, pending_ts_, pending_equity_);
+    }
+    pending_ts_ = ts;
+    pending_equity_ = value;
+    has_pending_ = true;
+}
+
+void StreamingCsvExporter::replace_last_equity(double value) {
+    pending_equity_ = value;
+}
+
+bool StreamingCsvExporter::finish(std::string* error) {
+    if (!files_) {
+        return true;
+    }
+    if (has_pending_ && files_->equity) {
+        put_equity_row(*files_->equity, pending_ts_, pending_equity_);
+    }
+    has_pending_ = false;
+    const bool equity_ok = !files_->equity || finish_block(*files_->equity, "equity", files_->equity_path, error);
+    const bool trades_ok = !files_->trades || finish_block(*files_->trades, "trades", files_->trades_path, error);
+    files_.reset();
+    return equity_ok && trades_ok;
+}
+
 bool export_metrics_json(const std::string& output_path,
                          const DatasetMetadata& dataset,
                          const SmaParams& params,
@@ -95,4 +391,234 @@ bool export_metrics_json(const std::string& output_path,
     return true;
 }
 
+bool export_equity_binary(const std::string& output_path,
+                          CandleView candles,
+                          const BacktestResult& result,
+                          const BinaryExportOptions& options,
+                          std::string* error) {
+    const std::size_t count = std::min({candles.size(), result.equity.size(), result.drawdown.size()});
+    BinaryTable table(count);
+    std::vector<int64_t>& ts = table.ints("ts");
+    for (std::size_t i = 0; i < count; ++i) {
+        ts[i] = candles[i].ts;
+    }
+    std::copy_n(result.equity.begin(), count, table.doubles("equity").begin());
+    std::copy_n(result.drawdown.begin(), count, table.doubles("drawdown").begin());
+    return table.write(output_path, columnar::FileKind::EquityCurve, options, error);
+}
+
+bool load_equity_binary(const std::string& path, EquityTable* table, std::string* error) {
+    BinaryTableReader reader;
+    if (!reader.open(path, columnar::FileKind::EquityCurve, error)) {
+        return false;
+    }
+    reader.read("ts", &table->ts);
+    reader.read("equity", &table->equity);
+    reader.read("drawdown", &table->drawdown);
+    return reader.finish(path, error);
+}
+
+bool export_trades_binary(const std::string& output_path,
+                          const BacktestResult& result,
+                          const BinaryExportOptions& options,
+                          std::string* error) {
+    const std::vector<Trade>& trades = result.trades;
+    BinaryTable table(trades.size());
+    std::vector<int64_t>& entry_time = table.ints("entry_time");
+    std::vector<double>& entry_price = table.doubles("entry_price");
+    std::vector<int64_t>& exit_time = table.ints("exit_time");
+    std::vector<double>& exit_price = table.doubles("exit_price");
+    std::vector<int64_t>& qty = table.ints("qty");
+    std::vector<double>& pnl = table.doubles("pnl");
+    std::vector<double>& return_pct = table.doubles("return_pct");
+    for (std::size_t i = 0; i < trades.size(); ++i) {
+        entry_time[i] = trades[i].entry_time;
+        entry_price[i] = trades[i].entry_price;
+        exit_time[i] = trades[i].exit_time;
+        exit_price[i] = trades[i].exit_price;
+        qty[i] = trades[i].qty;
+        pnl[i] = trades[i].pnl;
+        return_pct[i] = trades[i].return_pct;
+    }
+    return table.write(output_path, columnar::FileKind::TradeList, options, error);
+}
+
+bool load_trades_binary(const std::string& path, std::vector<Trade>* trades, std::string* error) {
+    BinaryTableReader reader;
+    if (!reader.open(path, columnar::FileKind::TradeList, error)) {
+        return false;
+    }
+    std::vector<int64_t> entry_time;
+    std::vector<double> entry_price;
+    std::vector<int64_t> exit_time;
+    std::vector<double> exit_price;
+    std::vector<int64_t> qty;
+    std::vector<double> pnl;
+    std::vector<double> return_pct;
+    reader.read("entry_time", &entry_time);
+    reader.read("entry_price", &entry_price);
+    reader.read("exit_time", &exit_time);
+    reader.read("exit_price", &exit_price);
+    reader.read("qty", &qty);
+    reader.read("pnl", &pnl);
+    reader.read("return_pct", &return_pct);
+    if (!reader.finish(path, error)) {
+        return false;
+    }
+    trades->resize(reader.rows());
+    for (std::size_t i = 0; i < trades->size(); ++i) {
+        Trade& trade = (*trades)[i];
+        trade.entry_time = entry_time[i];
+        trade.entry_price = entry_price[i];
+        trade.exit_time = exit_time[i];
+        trade.exit_price = exit_price[i];
+        trade.qty = static_cast<int>(qty[i]);
+        trade.pnl = pnl[i];
+        trade.return_pct = return_pct[i];
+    }
+    return true;
+}
+
+bool export_sweep_binary(const std::string& output_path,
+                         const std::vector<SweepRow>& rows,
+                         const BinaryExportOptions& options,
+                         std::string* error) {
+    SweepReportInfo info;
+    info.total_cells = rows.size();
+    return export_sweep_binary(output_path, rows, info, options, error);
+}
+
+bool export_sweep_binary(const std::string& output_path,
+                         const std::vector<SweepRow>& rows,
+                         const SweepReportInfo& info,
+                         const BinaryExportOptions& options,
+                         std::string* error) {
+    BinaryTable table(rows.size());
+    table.meta().put<uint64_t>(info.shard.index);
+    table.meta().put<uint64_t>(info.shard.count);
+    table.meta().put<uint64_t>(info.total_cells);
+    table.meta().put<uint8_t>(info.risk_axes ? 1 : 0);
+    table.meta().put<uint8_t>(info.pruning ? 1 : 0);
+    std::vector<int64_t>& cell = table.ints("cell");
+    std::vector<int64_t>& fast = table.ints("fast");
+    std::vector<int64_t>& slow = table.ints("slow");
+    std::vector<double>& stop_loss = table.doubles("stop_loss_pct");
+    std::vector<double>& take_profit = table.doubles("take_profit_pct");
+    std::vector<int64_t>& pruned = table.ints("pruned");
+    std::vector<int64_t>& pruned_at_bar = table.ints("pruned_at_bar");
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        cell[i] = static_cast<int64_t>(rows[i].cell);
+        fast[i] = static_cast<int64_t>(rows[i].fast);
+        slow[i] = static_cast<int64_t>(rows[i].slow);
+        stop_loss[i] = rows[i].stop_loss_pct;
+        take_profit[i] = rows[i].take_profit_pct;
+        pruned[i] = static_cast<int64_t>(rows[i].pruned);
+        pruned_at_bar[i] = static_cast<int64_t>(rows[i].pruned_at_bar);
+    }
+    for (int side = 0; side < 2; ++side) {
+        const char* const* names = kMetricColumns[side];
+        std::vector<double>& total_return = table.doubles(names[0]);
+        std::vector<double>& total_pnl = table.doubles(names[1]);
+        std::vector<int64_t>& trades = table.ints(names[2]);
+        std::vector<double>& win_rate = table.doubles(names[3]);
+        std::vector<double>& avg_trade = table.doubles(names[4]);
+        std::vector<double>& max_dd = table.doubles(names[5]);
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const Metrics& metrics = (side == 0) ? rows[i].train : rows[i].test;
+            total_return[i] = metrics.total_return_pct;
+            total_pnl[i] = metrics.total_pnl;
+            trades[i] = metrics.trades;
+            win_rate[i] = metrics.win_rate_pct;
+            avg_trade[i] = metrics.avg_trade_return_pct;
+            max_dd[i] = metrics.max_drawdown_pct;
+        }
+    }
+    return table.write(output_path, columnar::FileKind::SweepReport, options, error);
+}
+
+bool load_sweep_binary(const std::string& path, std::vector<SweepRow>* rows, std::string* error) {
+    SweepReportInfo info;
+    return load_sweep_binary(path, rows, &info, error);
+}
+
+bool load_sweep_binary(const std::string& path,
+                       std::vector<SweepRow>* rows,
+                       SweepReportInfo* info,
+                       std::string* error) {
+    BinaryTableReader reader;
+    if (!reader.open(path, columnar::FileKind::SweepReport, error)) {
+        return false;
+    }
+    uint64_t shard_index = 0;
+    uint64_t shard_count = 0;
+    uint64_t total_cells = 0;
+    uint8_t risk_axes = 0;
+    uint8_t pruning = 0;
+    columnar::ByteReader& meta = reader.meta();
+    if (!meta.get(&shard_index) || !meta.get(&shard_count) || !meta.get(&total_cells) || !meta.get(&risk_axes) ||
+        !meta.get(&pruning) || shard_count == 0 || shard_index >= shard_count) {
+        if (error != nullptr) {
+            *error = "Corrupt sweep report metadata: " + path;
+        }
+        return false;
+    }
+    std::vector<int64_t> cell;
+    std::vector<int64_t> pruned;
+    std::vector<int64_t> pruned_at_bar;
+    reader.read("cell", &cell);
+    reader.read("pruned", &pruned);
+    reader.read("pruned_at_bar", &pruned_at_bar);
+    std::vector<int64_t> fast;
+    std::vector<int64_t> slow;
+    std::vector<double> stop_loss;
+    std::vector<double> take_profit;
+    reader.read("fast", &fast);
+    reader.read("slow", &slow);
+    reader.read("stop_loss_pct", &stop_loss);
+    reader.read("take_profit_pct", &take_profit);
+    std::vector<double> doubles[2][5];
+    std::vector<int64_t> trades[2];
+    for (int side = 0; side < 2; ++side) {
+        const char* const* names = kMetricColumns[side];
+        reader.read(names[0], &doubles[side][0]);
+        reader.read(names[1], &doubles[side][1]);
+        reader.read(names[2], &trades[side]);
+        reader.read(names[3], &doubles[side][2]);
+        reader.read(names[4], &doubles[side][3]);
+        reader.read(names[5], &doubles[side][4]);
+    }
+    if (!reader.finish(path, error)) {
+        return false;
+    }
+
+    rows->resize(reader.rows());
+    for (std::size_t i = 0; i < rows->size(); ++i) {
+        SweepRow& row = (*rows)[i];
+        row.cell = static_cast<std::size_t>(cell[i]);
+        row.fast = static_cast<std::size_t>(fast[i]);
+        row.slow = static_cast<std::size_t>(slow[i]);
+        row.stop_loss_pct = stop_loss[i];
+        row.take_profit_pct = take_profit[i];
+        row.pruned = (pruned[i] >= 0 && pruned[i] <= static_cast<int64_t>(SweepPruneReason::Halving))
+                         ? static_cast<SweepPruneReason>(pruned[i])
+                         : SweepPruneReason::None;
+        row.pruned_at_bar = static_cast<std::size_t>(pruned_at_bar[i]);
+        for (int side = 0; side < 2; ++side) {
+            Metrics& metrics = (side == 0) ? row.train : row.test;
+            metrics.total_return_pct = doubles[side][0][i];
+            metrics.total_pnl = doubles[side][1][i];
+            metrics.trades = static_cast<int>(trades[side][i]);
+            metrics.win_rate_pct = doubles[side][2][i];
+            metrics.avg_trade_return_pct = doubles[side][3][i];
+            metrics.max_drawdown_pct = doubles[side][4][i];
+        }
+    }
+    info->shard.index = static_cast<std::size_t>(shard_index);
+    info->shard.count = static_cast<std::size_t>(shard_count);
+    info->total_cells = static_cast<std::size_t>(total_cells);
+    info->risk_axes = risk_axes != 0;
+    info->pruning = pruning != 0;
+    return true;
+}
+
 } // namespace stockbt
@@ -0,0 +1,294 @@
+#include "backtest/incremental_backtest.hpp"
+
+#include <utility>
+
+#include "backtest/mapped_file.hpp"
+#include "columnar_file.hpp"
+#include "sma_cross.hpp"
+
+namespace stockbt {
+
+namespace {
+
+// Bump whenever the metadata layout below changes.
+constexpr uint32_t kStateVersion = 1;
+
+// RollingSma over a ring of the last slow_window closes instead of the whole series.
+// Same additions and subtractions in the same order, so the averages are bit-identical.
+class RingSma {
+public:
+    RingSma(const SmaParams& params, double close, double* fast_sum, double* slow_sum, std::vector<double>* ring)
+        : params_(params), close_(close), fast_sum_(fast_sum), slow_sum_(slow_sum), ring_(*ring) {}
+
+    void advance(std::size_t i) {
+        const std::size_t slot = i % params_.slow_window;
+        *fast_sum_ += close_;
+        *slow_sum_ += close_;
+        if (i >= params_.fast_window) {
+            *fast_sum_ -= ring_[(i - params_.fast_window) % params_.slow_window];
+        }
+        if (i >= params_.slow_window) {
+            *slow_sum_ -= ring_[slot];
+        }
+        ring_[slot] = close_;
+    }
+
+    double fast() const { return *fast_sum_ / static_cast<double>(params_.fast_window); }
+    double slow() const { return *slow_sum_ / static_cast<double>(params_.slow_window); }
+
+private:
+    const SmaParams& params_;
+    double close_;
+    double* fast_sum_;
+    double* slow_sum_;
+    std::vector<double>& ring_;
+};
+
+// MetricsRecorder that also forwards trades and equity to an optional observer.
+class ObservedRecorder {
+public:
+    ObservedRecorder(MetricsRecorder& metrics, BacktestObserver* observer, int64_t ts)
+        : metrics_(metrics), observer_(observer), ts_(ts) {}
+
+    void begin(std::size_t, double) {}
+    void warn(const char*) {}
+    void trade(const Trade& trade) {
+        metrics_.trade(trade);
+        if (observer_ != nullptr) {
+            observer_->trade(trade);
+        }
+    }
+    void equity(std::size_t i, double value) {
+        metrics_.equity(i, value);
+        if (observer_ != nullptr) {
+            observer_->equity(ts_, value);
+        }
+    }
+    void replace_last_equity(double value) {
+        metrics_.replace_last_equity(value);
+        if (observer_ != nullptr) {
+            observer_->replace_last_equity(value);
+        }
+    }
+    void finish(const BacktestSettings& settings) { metrics_.finish(settings); }
+
+private:
+    MetricsRecorder& metrics_;
+    BacktestObserver* observer_;
+    int64_t ts_;
+};
+
+} // namespace
+
+IncrementalSmaBacktest::IncrementalSmaBacktest(const SmaParams& params, const BacktestSettings& settings)
+    : params_(params), settings_(settings), execution_(ExecutionCore<MetricsRecorder>::initial_state(settings)) {
+    if (params_.is_valid()) {
+        ring_.assign(params_.slow_window, 0.0);
+    }
+}
+
+bool IncrementalSmaBacktest::check_order(int64_t ts, int64_t prev_ts, std::size_t offset, std::string* error) const {
+    if (bars_ + offset == 0 || ts > prev_ts) {
+        return true;
+    }
+    if (error != nullptr) {
+        *error = "Appended bar " + std::to_string(offset) + " is not after the previous bar";
+    }
+    return false;
+}
+
+void IncrementalSmaBacktest::consume(int64_t ts, double open, double close) {
+    if (params_.is_valid()) {
+        Metrics unused;
+        MetricsRecorder metrics(&unused, recorder_);
+        ObservedRecorder recorder(metrics, observer_, ts);
+        ExecutionCore<ObservedRecorder> core(settings_, recorder, execution_);
+        RingSma sma(params_, close, &fast_sum_, &slow_sum_, &ring_);
+        SmaCrossStrategy<RingSma> strategy(sma, params_, SmaCrossState{prev_fast_, prev_slow_, prev_valid_});
+
+        core.fill_pending(ts, open);
+        core.on_signal(strategy.on_bar(bars_), true);
+        core.close_bar(bars_, close, true);
+
+        const SmaCrossState& cross = strategy.state();
+        prev_fast_ = cross.prev_fast;
+        prev_slow_ = cross.prev_slow;
+        prev_valid_ = cross.prev_valid;
+        execution_ = core.state();
+        recorder_ = metrics.state();
+    }
+    ++bars_;
+    last_ts_ = ts;
+    last_close_ = close;
+}
+
+bool IncrementalSmaBacktest::append(const Candle& bar, std::string* error) {
+    if (!check_order(bar.ts, last_ts_, 0, error)) {
+        return false;
+    }
+    consume(bar.ts, bar.o, bar.c);
+    return true;
+}
+
+bool IncrementalSmaBacktest::append(CandleView bars, std::string* error) {
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        if (!check_order(bars[i].ts, (i == 0) ? last_ts_ : bars[i - 1].ts, i, error)) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        consume(bars[i].ts, bars[i].o, bars[i].c);
+    }
+    return true;
+}
+
+bool IncrementalSmaBacktest::append(ColumnsView bars, std::string* error) {
+    const int64_t* ts = bars.ts();
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        if (!check_order(ts[i], (i == 0) ? last_ts_ : ts[i - 1], i, error)) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        consume(ts[i], bars.o()[i], bars.c()[i]);
+    }
+    return true;
+}
+
+bool IncrementalSmaBacktest::extend(ColumnsView series, std::string* error) {
+    if (series.size() < bars_ || (bars_ > 0 && series.ts()[bars_ - 1] != last_ts_)) {
+        if (error != nullptr) {
+            *error = "Series does not continue the consumed bars";
+        }
+        return false;
+    }
+    return append(series.subview(bars_, series.size() - bars_), error);
+}
+
+Metrics IncrementalSmaBacktest::metrics() const {
+    return close_out(nullptr);
+}
+
+Metrics IncrementalSmaBacktest::finish() const {
+    return close_out(observer_);
+}
+
+Metrics IncrementalSmaBacktest::close_out(BacktestObserver* observer) const {
+    Metrics metrics;
+    if (bars_ == 0 || !params_.is_valid()) {
+        return metrics;
+    }
+    MetricsRecorder state(&metrics, recorder_);
+    ObservedRecorder recorder(state, observer, last_ts_);
+    ExecutionCore<ObservedRecorder> core(settings_, recorder, execution_);
+    core.finish(last_ts_, last_close_);
+    recorder.finish(settings_);
+    return metrics;
+}
+
+bool IncrementalSmaBacktest::save(const std::string& path, std::string* error) const {
+    columnar::ByteWriter meta;
+    meta.put<uint32_t>(kStateVersion);
+    meta.put<uint64_t>(params_.fast_window);
+    meta.put<uint64_t>(params_.slow_window);
+    meta.put<double>(settings_.starting_cash);
+    meta.put<double>(settings_.commission_pct);
+    meta.put<double>(settings_.position_size_pct);
+    meta.put<double>(settings_.stop_loss_pct);
+    meta.put<double>(settings_.take_profit_pct);
+    meta.put<uint64_t>(bars_);
+    meta.put<int64_t>(last_ts_);
+    meta.put<double>(last_close_);
+    meta.put<double>(fast_sum_);
+    meta.put<double>(slow_sum_);
+    meta.put<double>(prev_fast_);
+    meta.put<double>(prev_slow_);
+    meta.put<uint8_t>(prev_valid_ ? 1 : 0);
+    meta.put<double>(execution_.cash);
+    meta.put<int32_t>(execution_.qty);
+    meta.put<int64_t>(execution_.entry_time);
+    meta.put<double>(execution_.entry_price);
+    meta.put<uint8_t>(static_cast<uint8_t>(execution_.pending));
+    meta.put<int32_t>(recorder_.tally.trades);
+    meta.put<int32_t>(recorder_.tally.wins);
+    meta.put<double>(recorder_.tally.sum_returns);
+    meta.put<double>(recorder_.peak);
+    meta.put<double>(recorder_.min_dd);
+    meta.put<double>(recorder_.last);
+    meta.put<uint8_t>(recorder_.has_last ? 1 : 0);
+
+    std::vector<columnar::ColumnSource> columns;
+    columns.push_back({"closes", columnar::ColumnType::Float64, ring_.data(), ring_.size() * sizeof(double)});
+    return columnar::write_file(path, columnar::FileKind::BacktestState, ring_.size(), meta.data(), columns, error);
+}
+
+bool IncrementalSmaBacktest::load(const std::string& path, std::string* error) {
+    MappedFile file;
+    if (!file.open(path, error)) {
+        return false;
+    }
+    auto fail = [&](const std::string& message) {
+        if (error != nullptr) {
+            *error = message + ": " + path;
+        }
+        return false;
+    };
+
+    columnar::Reader reader;
+    std::string reader_error;
+    if (!reader.open(file.data(), file.size(), columnar::FileKind::BacktestState, &reader_error)) {
+        return fail(reader_error);
+    }
+
+    IncrementalSmaBacktest loaded;
+    columnar::ByteReader meta = reader.meta();
+    uint32_t version = 0;
+    uint64_t fast = 0;
+    uint64_t slow = 0;
+    uint64_t bars = 0;
+    uint8_t prev_valid = 0;
+    int32_t qty = 0;
+    uint8_t pending = 0;
+    int32_t trades = 0;
+    int32_t wins = 0;
+    uint8_t has_last = 0;
+    if (!meta.get(&version) || !meta.get(&fast) || !meta.get(&slow) || !meta.get(&loaded.settings_.starting_cash) ||
+        !meta.get(&loaded.settings_.commission_pct) || !meta.get(&loaded.settings_.position_size_pct) ||
+        !meta.get(&loaded.settings_.stop_loss_pct) || !meta.get(&loaded.settings_.take_profit_pct) ||
+        !meta.get(&bars) || !meta.get(&loaded.last_ts_) || !meta.get(&loaded.last_close_) ||
+        !meta.get(&loaded.fast_sum_) || !meta.get(&loaded.slow_sum_) || !meta.get(&loaded.prev_fast_) ||
+        !meta.get(&loaded.prev_slow_) || !meta.get(&prev_valid) || !meta.get(&loaded.execution_.cash) ||
+        !meta.get(&qty) || !meta.get(&loaded.execution_.entry_time) || !meta.get(&loaded.execution_.entry_price) ||
+        !meta.get(&pending) || !meta.get(&trades) || !meta.get(&wins) ||
+        !meta.get(&loaded.recorder_.tally.sum_returns) || !meta.get(&loaded.recorder_.peak) ||
+        !meta.get(&loaded.recorder_.min_dd) || !meta.get(&loaded.recorder_.last) || !meta.get(&has_last)) {
+        return fail("Corrupt backtest state metadata");
+    }
+    if (version != kStateVersion) {
+        return fail("Unsupported backtest state version");
+    }
+    loaded.params_.fast_window = static_cast<std::size_t>(fast);
+    loaded.params_.slow_window = static_cast<std::size_t>(slow);
+    const std::size_t ring_size = loaded.params_.is_valid() ? loaded.params_.slow_window : 0;
+    if (reader.row_count() != ring_size || pending > static_cast<uint8_t>(PendingOrder::Sell)) {
+        return fail("Corrupt backtest state metadata");
+    }
+    const auto* closes = static_cast<const double*>(reader.raw_column("closes", columnar::ColumnType::Float64));
+    if (closes == nullptr && ring_size > 0) {
+        return fail("Missing backtest state column");
+    }
+
+    loaded.ring_.assign(closes, closes + ring_size);
+    loaded.bars_ = static_cast<std::size_t>(bars);
+    loaded.prev_valid_ = prev_valid != 0;
+    loaded.execution_.qty = qty;
+    loaded.execution_.pending = static_cast<PendingOrder>(pending);
+    loaded.recorder_.tally.trades = trades;
+    loaded.recorder_.tally.wins = wins;
+    loaded.recorder_.has_last = has_last != 0;
+    loaded.observer_ = observer_;
+    *this = std::move(loaded);
+    return true;
+}
+
+} // namespace stockbt
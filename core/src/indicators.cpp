@@ -0,0 +1,580 @@
+#include "backtest/indicators.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STOCKBT_INDICATORS_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define STOCKBT_INDICATORS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace stockbt {
+namespace {
+
+constexpr std::size_t kMaxLanes = 4;
+
+// Up to kMaxLanes windows processed together. Lanes past `active` repeat window 0
+// and are never stored.
+struct LaneGroup {
+    std::size_t active{0};
+    std::size_t windows[kMaxLanes]{};
+    double* out[kMaxLanes]{};
+};
+
+// ---- Scalar reference -------------------------------------------------------
+
+void sma_scalar(const double* x, std::size_t n, std::size_t w, double* out) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += x[i];
+        if (i >= w) {
+            sum -= x[i - w];
+        }
+        out[i] = (i + 1 >= w) ? sum / static_cast<double>(w) : 0.0;
+    }
+}
+
+double ema_alpha(std::size_t period) {
+    return 2.0 / (static_cast<double>(period) + 1.0);
+}
+
+void ema_scalar(const double* x, std::size_t n, std::size_t period, double* out) {
+    if (n == 0) {
+        return;
+    }
+    const double alpha = ema_alpha(period);
+    double e = x[0];
+    out[0] = e;
+    for (std::size_t i = 1; i < n; ++i) {
+        e = e + alpha * (x[i] - e);
+        out[i] = e;
+    }
+}
+
+double stddev_from_m2(double m2, double w) {
+    double var = m2 / w;
+    if (var < 0.0) {
+        var = 0.0;
+    }
+    return std::sqrt(var);
+}
+
+// Welford update while the window fills, then a sliding update replacing x[i - w]:
+//   mean' = mean + (x - y) / w,  M2' = M2 + (x - y) * ((x - mean') + (y - mean)).
+void stddev_scalar(const double* x, std::size_t n, std::size_t w, double* out) {
+    double mean = 0.0;
+    double m2 = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i < w) {
+            const double delta = x[i] - mean;
+            const double next_mean = mean + delta / static_cast<double>(i + 1);
+            m2 = m2 + delta * (x[i] - next_mean);
+            mean = next_mean;
+        } else {
+            const double leaving = x[i - w];
+            const double delta = x[i] - leaving;
+            const double next_mean = mean + delta / static_cast<double>(w);
+            m2 = m2 + delta * ((x[i] - next_mean) + (leaving - mean));
+            mean = next_mean;
+        }
+        out[i] = (i + 1 >= w) ? stddev_from_m2(m2, static_cast<double>(w)) : 0.0;
+    }
+}
+
+// out[i] = pick(h[i - w + 1], g[i]) for i >= w - 1.
+void combine_min_scalar(const double* h, const double* g, std::size_t count, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = (g[i] < h[i]) ? g[i] : h[i];
+    }
+}
+
+void combine_max_scalar(const double* h, const double* g, std::size_t count, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = (g[i] > h[i]) ? g[i] : h[i];
+    }
+}
+
+// ---- AVX2 -------------------------------------------------------------------
+
+#if defined(STOCKBT_INDICATORS_AVX2)
+
+__attribute__((target("avx2"))) void store_lanes(__m256d value, const LaneGroup& group, std::size_t i) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, value);
+    for (std::size_t lane = 0; lane < group.active; ++lane) {
+        group.out[lane][i] = lanes[lane];
+    }
+}
+
+__attribute__((target("avx2"))) __m256d window_vector(const LaneGroup& group) {
+    return _mm256_set_pd(static_cast<double>(group.windows[3]),
+                         static_cast<double>(group.windows[2]),
+                         static_cast<double>(group.windows[1]),
+                         static_cast<double>(group.windows[0]));
+}
+
+// idx = i - window per lane, starting at i = 0.
+__attribute__((target("avx2"))) __m256i leaving_index(const LaneGroup& group) {
+    return _mm256_set_epi64x(-static_cast<int64_t>(group.windows[3]),
+                             -static_cast<int64_t>(group.windows[2]),
+                             -static_cast<int64_t>(group.windows[1]),
+                             -static_cast<int64_t>(group.windows[0]));
+}
+
+__attribute__((target("avx2"))) void sma_avx2(const double* x, std::size_t n, const LaneGroup& group) {
+    const __m256d w = window_vector(group);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i minus_one = _mm256_set1_epi64x(-1);
+    const __m256i minus_two = _mm256_set1_epi64x(-2);
+    __m256i idx = leaving_index(group);
+    __m256d sum = zero;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum = _mm256_add_pd(sum, _mm256_set1_pd(x[i]));
+        // Lanes with i < window subtract +0.0, which leaves the sum unchanged.
+        const __m256d leaving_mask = _mm256_castsi256_pd(_mm256_cmpgt_epi64(idx, minus_one));
+        const __m256d leaving = _mm256_mask_i64gather_pd(zero, x, idx, leaving_mask, 8);
+        sum = _mm256_sub_pd(sum, leaving);
+        const __m256d ready = _mm256_castsi256_pd(_mm256_cmpgt_epi64(idx, minus_two));
+        store_lanes(_mm256_and_pd(_mm256_div_pd(sum, w), ready), group, i);
+        idx = _mm256_add_epi64(idx, one);
+    }
+}
+
+__attribute__((target("avx2"))) void ema_avx2(const double* x, std::size_t n, const LaneGroup& group) {
+    if (n == 0) {
+        return;
+    }
+    const __m256d alpha = _mm256_set_pd(ema_alpha(group.windows[3]),
+                                        ema_alpha(group.windows[2]),
+                                        ema_alpha(group.windows[1]),
+                                        ema_alpha(group.windows[0]));
+    __m256d e = _mm256_set1_pd(x[0]);
+    store_lanes(e, group, 0);
+    for (std::size_t i = 1; i < n; ++i) {
+        const __m256d diff = _mm256_sub_pd(_mm256_set1_pd(x[i]), e);
+        e = _mm256_add_pd(e, _mm256_mul_pd(alpha, diff));
+        store_lanes(e, group, i);
+    }
+}
+
+__attribute__((target("avx2"))) void stddev_avx2(const double* x, std::size_t n, const LaneGroup& group) {
+    const __m256d w = window_vector(group);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i minus_one = _mm256_set1_epi64x(-1);
+    const __m256i minus_two = _mm256_set1_epi64x(-2);
+    __m256i idx = leaving_index(group);
+    __m256d mean = zero;
+    __m256d m2 = zero;
+    for (std::size_t i = 0; i < n; ++i) {
+        const __m256d value = _mm256_set1_pd(x[i]);
+        const __m256d sliding_mask = _mm256_castsi256_pd(_mm256_cmpgt_epi64(idx, minus_one));
+
+        // Both updates are evaluated; each lane keeps the one the scalar reference takes.
+        const __m256d grow_delta = _mm256_sub_pd(value, mean);
+        const __m256d count = _mm256_set1_pd(static_cast<double>(i + 1));
+        const __m256d grow_mean = _mm256_add_pd(mean, _mm256_div_pd(grow_delta, count));
+        const __m256d grow_m2 = _mm256_add_pd(m2, _mm256_mul_pd(grow_delta, _mm256_sub_pd(value, grow_mean)));
+
+        const __m256d leaving = _mm256_mask_i64gather_pd(zero, x, idx, sliding_mask, 8);
+        const __m256d slide_delta = _mm256_sub_pd(value, leaving);
+        const __m256d slide_mean = _mm256_add_pd(mean, _mm256_div_pd(slide_delta, w));
+        const __m256d slide_m2 = _mm256_add_pd(
+            m2,
+            _mm256_mul_pd(slide_delta,
+                          _mm256_add_pd(_mm256_sub_pd(value, slide_mean), _mm256_sub_pd(leaving, mean))));
+
+        mean = _mm256_blendv_pd(grow_mean, slide_mean, sliding_mask);
+        m2 = _mm256_blendv_pd(grow_m2, slide_m2, sliding_mask);
+
+        __m256d var = _mm256_div_pd(m2, w);
+        var = _mm256_blendv_pd(var, zero, _mm256_cmp_pd(var, zero, _CMP_LT_OQ));
+        const __m256d ready = _mm256_castsi256_pd(_mm256_cmpgt_epi64(idx, minus_two));
+        store_lanes(_mm256_and_pd(_mm256_sqrt_pd(var), ready), group, i);
+        idx = _mm256_add_epi64(idx, one);
+    }
+}
+
+// _mm256_min_pd(a, b) is a < b ? a : b, matching the scalar combine.
+__attribute__((target("avx2"))) void combine_min_avx2(const double* h,
+                                                      const double* g,
+                                                      std::size_t count,
+                                                      double* out) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_min_pd(_mm256_loadu_pd(g + i), _mm256_loadu_pd(h + i)));
+    }
+    combine_min_scalar(h + i, g + i, count - i, out + i);
+}
+
+__attribute__((target("avx2"))) void combine_max_avx2(const double* h,
+                                                      const double* g,
+                                                      std::size_t count,
+                                                      double* out) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_max_pd(_mm256_loadu_pd(g + i), _mm256_loadu_pd(h + i)));
+    }
+    combine_max_scalar(h + i, g + i, count - i, out + i);
+}
+
+#endif
+
+// ---- NEON -------------------------------------------------------------------
+
+#if defined(STOCKBT_INDICATORS_NEON)
+
+void store_lanes(float64x2_t value, const LaneGroup& group, std::size_t i) {
+    group.out[0][i] = vgetq_lane_f64(value, 0);
+    if (group.active > 1) {
+        group.out[1][i] = vgetq_lane_f64(value, 1);
+    }
+}
+
+float64x2_t pair(double a, double b) {
+    return vsetq_lane_f64(b, vdupq_n_f64(a), 1);
+}
+
+// Lanes whose window is not full yet read +0.0, which leaves a sum unchanged.
+float64x2_t leaving_pair(const double* x, std::size_t i, const LaneGroup& group) {
+    const std::size_t w0 = group.windows[0];
+    const std::size_t w1 = group.windows[1];
+    return pair(i >= w0 ? x[i - w0] : 0.0, i >= w1 ? x[i - w1] : 0.0);
+}
+
+uint64x2_t ready_pair(std::size_t i, const LaneGroup& group) {
+    const uint64_t r0 = (i + 1 >= group.windows[0]) ? ~uint64_t{0} : 0;
+    const uint64_t r1 = (i + 1 >= group.windows[1]) ? ~uint64_t{0} : 0;
+    return vsetq_lane_u64(r1, vdupq_n_u64(r0), 1);
+}
+
+float64x2_t mask_pair(float64x2_t value, uint64x2_t mask) {
+    return vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(value), mask));
+}
+
+void sma_neon(const double* x, std::size_t n, const LaneGroup& group) {
+    const float64x2_t w = pair(static_cast<double>(group.windows[0]), static_cast<double>(group.windows[1]));
+    float64x2_t sum = vdupq_n_f64(0.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        sum = vaddq_f64(sum, vdupq_n_f64(x[i]));
+        sum = vsubq_f64(sum, leaving_pair(x, i, group));
+        store_lanes(mask_pair(vdivq_f64(sum, w), ready_pair(i, group)), group, i);
+    }
+}
+
+void ema_neon(const double* x, std::size_t n, const LaneGroup& group) {
+    if (n == 0) {
+        return;
+    }
+    const float64x2_t alpha = pair(ema_alpha(group.windows[0]), ema_alpha(group.windows[1]));
+    float64x2_t e = vdupq_n_f64(x[0]);
+    store_lanes(e, group, 0);
+    for (std::size_t i = 1; i < n; ++i) {
+        const float64x2_t diff = vsubq_f64(vdupq_n_f64(x[i]), e);
+        e = vaddq_f64(e, vmulq_f64(alpha, diff));
+        store_lanes(e, group, i);
+    }
+}
+
+void stddev_neon(const double* x, std::size_t n, const LaneGroup& group) {
+    const float64x2_t w = pair(static_cast<double>(group.windows[0]), static_cast<double>(group.windows[1]));
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    float64x2_t mean = zero;
+    float64x2_t m2 = zero;
+    for (std::size_t i = 0; i < n; ++i) {
+        const float64x2_t value = vdupq_n_f64(x[i]);
+        const uint64_t s0 = (i >= group.windows[0]) ? ~uint64_t{0} : 0;
+        const uint64_t s1 = (i >= group.windows[1]) ? ~uint64_t{0} : 0;
+        const uint64x2_t sliding_mask = vsetq_lane_u64(s1, vdupq_n_u64(s0), 1);
+
+        // Both updates are evaluated; each lane keeps the one the scalar reference takes.
+        const float64x2_t grow_delta = vsubq_f64(value, mean);
+        const float64x2_t count = vdupq_n_f64(static_cast<double>(i + 1));
+        const float64x2_t grow_mean = vaddq_f64(mean, vdivq_f64(grow_delta, count));
+        const float64x2_t grow_m2 = vaddq_f64(m2, vmulq_f64(grow_delta, vsubq_f64(value, grow_mean)));
+
+        const float64x2_t leaving = leaving_pair(x, i, group);
+        const float64x2_t slide_delta = vsubq_f64(value, leaving);
+        const float64x2_t slide_mean = vaddq_f64(mean, vdivq_f64(slide_delta, w));
+        const float64x2_t slide_m2 = vaddq_f64(
+            m2, vmulq_f64(slide_delta, vaddq_f64(vsubq_f64(value, slide_mean), vsubq_f64(leaving, mean))));
+
+        mean = vbslq_f64(sliding_mask, slide_mean, grow_mean);
+        m2 = vbslq_f64(sliding_mask, slide_m2, grow_m2);
+
+        float64x2_t var = vdivq_f64(m2, w);
+        var = vbslq_f64(vcltq_f64(var, zero), zero, var);
+        store_lanes(mask_pair(vsqrtq_f64(var), ready_pair(i, group)), group, i);
+    }
+}
+
+// vminq/vmaxq order signed zeros; select explicitly to match the scalar combine.
+void combine_min_neon(const double* h, const double* g, std::size_t count, double* out) {
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const float64x2_t gv = vld1q_f64(g + i);
+        const float64x2_t hv = vld1q_f64(h + i);
+        vst1q_f64(out + i, vbslq_f64(vcltq_f64(gv, hv), gv, hv));
+    }
+    combine_min_scalar(h + i, g + i, count - i, out + i);
+}
+
+void combine_max_neon(const double* h, const double* g, std::size_t count, double* out) {
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const float64x2_t gv = vld1q_f64(g + i);
+        const float64x2_t hv = vld1q_f64(h + i);
+        vst1q_f64(out + i, vbslq_f64(vcgtq_f64(gv, hv), gv, hv));
+    }
+    combine_max_scalar(h + i, g + i, count - i, out + i);
+}
+
+#endif
+
+// ---- Dispatch ---------------------------------------------------------------
+
+SimdLevel detect() {
+#if defined(STOCKBT_INDICATORS_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+#endif
+#if defined(STOCKBT_INDICATORS_NEON)
+    return SimdLevel::Neon;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel resolve(SimdLevel requested) {
+    return (requested == detected_simd_level()) ? requested : SimdLevel::Scalar;
+}
+
+std::size_t lane_count(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2:
+        return 4;
+    case SimdLevel::Neon:
+        return 2;
+    case SimdLevel::Scalar:
+        break;
+    }
+    return 1;
+}
+
+using ScalarKernel = void (*)(const double*, std::size_t, std::size_t, double*);
+using LaneKernel = void (*)(const double*, std::size_t, const LaneGroup&);
+
+// Runs every non-zero window through the vector kernel in groups of lane_count(level);
+// window 0 yields zeros.
+void run_batch(const double* x,
+               std::size_t n,
+               const std::size_t* windows,
+               std::size_t count,
+               double* const* out,
+               SimdLevel level,
+               ScalarKernel scalar,
+               LaneKernel vector) {
+    level = resolve(level);
+    const std::size_t lanes = lane_count(level);
+    LaneGroup group;
+    auto flush = [&]() {
+        if (group.active == 0) {
+            return;
+        }
+        if (vector == nullptr || group.active == 1) {
+            for (std::size_t lane = 0; lane < group.active; ++lane) {
+                scalar(x, n, group.windows[lane], group.out[lane]);
+            }
+        } else {
+            for (std::size_t lane = group.active; lane < kMaxLanes; ++lane) {
+                group.windows[lane] = group.windows[0];
+            }
+            vector(x, n, group);
+        }
+        group = LaneGroup();
+    };
+
+    for (std::size_t k = 0; k < count; ++k) {
+        if (windows[k] == 0) {
+            std::fill(out[k], out[k] + n, 0.0);
+            continue;
+        }
+        group.windows[group.active] = windows[k];
+        group.out[group.active] = out[k];
+        if (++group.active == lanes) {
+            flush();
+        }
+    }
+    flush();
+}
+
+LaneKernel sma_kernel(SimdLevel level) {
+    switch (resolve(level)) {
+#if defined(STOCKBT_INDICATORS_AVX2)
+    case SimdLevel::Avx2:
+        return sma_avx2;
+#endif
+#if defined(STOCKBT_INDICATORS_NEON)
+    case SimdLevel::Neon:
+        return sma_neon;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+LaneKernel ema_kernel(SimdLevel level) {
+    switch (resolve(level)) {
+#if defined(STOCKBT_INDICATORS_AVX2)
+    case SimdLevel::Avx2:
+        return ema_avx2;
+#endif
+#if defined(STOCKBT_INDICATORS_NEON)
+    case SimdLevel::Neon:
+        return ema_neon;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+LaneKernel stddev_kernel(SimdLevel level) {
+    switch (resolve(level)) {
+#if defined(STOCKBT_INDICATORS_AVX2)
+    case SimdLevel::Avx2:
+        return stddev_avx2;
+#endif
+#if defined(STOCKBT_INDICATORS_NEON)
+    case SimdLevel::Neon:
+        return stddev_neon;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+using CombineKernel = void (*)(const double*, const double*, std::size_t, double*);
+
+template <bool kMax>
+void rolling_extreme(const double* x, std::size_t n, std::size_t w, double* out, SimdLevel level) {
+    std::fill(out, out + n, 0.0);
+    if (w == 0 || w > n) {
+        return;
+    }
+    const auto better = [](double a, double b) { return kMax ? (a > b) : (a < b); };
+
+    // g: running extreme from each block start; h: running extreme to each block end.
+    std::vector<double> g(n);
+    std::vector<double> h(n);
+    for (std::size_t start = 0; start < n; start += w) {
+        const std::size_t end = std::min(start + w, n);
+        g[start] = x[start];
+        for (std::size_t i = start + 1; i < end; ++i) {
+            g[i] = better(x[i], g[i - 1]) ? x[i] : g[i - 1];
+        }
+        h[end - 1] = x[end - 1];
+        for (std::size_t i = end - 1; i > start; --i) {
+            h[i - 1] = better(x[i - 1], h[i]) ? x[i - 1] : h[i];
+        }
+    }
+
+    // Window [i - w + 1, i] is the suffix of one block plus the prefix of the next.
+    CombineKernel combine = kMax ? combine_max_scalar : combine_min_scalar;
+    switch (resolve(level)) {
+#if defined(STOCKBT_INDICATORS_AVX2)
+    case SimdLevel::Avx2:
+        combine = kMax ? combine_max_avx2 : combine_min_avx2;
+        break;
+#endif
+#if defined(STOCKBT_INDICATORS_NEON)
+    case SimdLevel::Neon:
+        combine = kMax ? combine_max_neon : combine_min_neon;
+        break;
+#endif
+    default:
+        break;
+    }
+    combine(h.data(), g.data() + (w - 1), n - w + 1, out + (w - 1));
+}
+
+} // namespace
+
+SimdLevel detected_simd_level() {
+    static const SimdLevel level = detect();
+    return level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Neon:
+        return "neon";
+    }
+    return "scalar";
+}
+
+SimdLevel indicator_kernel_level(std::size_t windows, SimdLevel level) {
+    // Mirrors run_batch, which runs a group of one window through the scalar kernel.
+    return (windows < 2) ? SimdLevel::Scalar : resolve(level);
+}
+
+void rolling_sma(const double* values, std::size_t n, std::size_t window, double* out, SimdLevel level) {
+    rolling_sma_batch(values, n, &window, 1, &out, level);
+}
+
+void rolling_sma_batch(const double* values,
+                       std::size_t n,
+                       const std::size_t* windows,
+                       std::size_t count,
+                       double* const* out,
+                       SimdLevel level) {
+    run_batch(values, n, windows, count, out, level, sma_scalar, sma_kernel(level));
+}
+
+void ema(const double* values, std::size_t n, std::size_t period, double* out, SimdLevel level) {
+    ema_batch(values, n, &period, 1, &out, level);
+}
+
+void ema_batch(const double* values,
+               std::size_t n,
+               const std::size_t* periods,
+               std::size_t count,
+               double* const* out,
+               SimdLevel level) {
+    run_batch(values, n, periods, count, out, level, ema_scalar, ema_kernel(level));
+}
+
+void rolling_stddev(const double* values, std::size_t n, std::size_t window, double* out, SimdLevel level) {
+    rolling_stddev_batch(values, n, &window, 1, &out, level);
+}
+
+void rolling_stddev_batch(const double* values,
+                          std::size_t n,
+                          const std::size_t* windows,
+                          std::size_t count,
+                          double* const* out,
+                          SimdLevel level) {
+    run_batch(values, n, windows, count, out, level, stddev_scalar, stddev_kernel(level));
+}
+
+void rolling_min(const double* values, std::size_t n, std::size_t window, double* out, SimdLevel level) {
+    rolling_extreme<false>(values, n, window, out, level);
+}
+
+void rolling_max(const double* values, std::size_t n, std::size_t window, double* out, SimdLevel level) {
+    rolling_extreme<true>(values, n, window, out, level);
+}
+
+} // namespace stockbt
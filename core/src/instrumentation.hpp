@@ -0,0 +1,44 @@
+#pragma once
+
+// Scoped timers and counters behind ImportStats/BacktestStats. Configure with
+// -DSTOCKBT_INSTRUMENTATION=OFF to compile every use out of the hot paths.
+
+#include <chrono>
+
+#ifndef STOCKBT_INSTRUMENTATION
+#define STOCKBT_INSTRUMENTATION 1
+#endif
+
+namespace stockbt {
+
+// Adds the lifetime of the scope, in milliseconds, to *total_ms.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(double* total_ms) : total_ms_(total_ms), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        *total_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    double* total_ms_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace stockbt
+
+#define STOCKBT_STATS_JOIN_(a, b) a##b
+#define STOCKBT_STATS_JOIN(a, b) STOCKBT_STATS_JOIN_(a, b)
+
+#if STOCKBT_INSTRUMENTATION
+// Times the rest of the enclosing scope into a double.
+#define STOCKBT_TIME_SCOPE(total_ms) ::stockbt::ScopedTimer STOCKBT_STATS_JOIN(stockbt_timer_, __LINE__)(total_ms)
+// Runs a counter update only in instrumented builds.
+#define STOCKBT_STATS(statement) statement
+#else
+// Unevaluated, so nothing runs, but the operands still count as used.
+#define STOCKBT_TIME_SCOPE(total_ms) static_cast<void>(sizeof(total_ms))
+#define STOCKBT_STATS(statement) static_cast<void>(sizeof((statement), 0))
+#endif
@@ -0,0 +1,181 @@
+#include "backtest/mapped_file.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stockbt {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+#if defined(_WIN32)
+        file_handle_ = std::exchange(other.file_handle_, nullptr);
+        mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path, std::string* error) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error != nullptr) {
+            *error = "Unable to open file: " + path;
+        }
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        if (error != nullptr) {
+            *error = "Unable to stat file: " + path;
+        }
+        return false;
+    }
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        open_ = true;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        if (error != nullptr) {
+            *error = "Unable to map file: " + path;
+        }
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        if (error != nullptr) {
+            *error = "Unable to map file: " + path;
+        }
+        return false;
+    }
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+    open_ = true;
+    return true;
+}
+
+void MappedFile::release(std::size_t, std::size_t) const {}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+    file_handle_ = nullptr;
+    mapping_handle_ = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, std::string* error) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (error != nullptr) {
+            *error = "Unable to open file: " + path;
+        }
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        if (error != nullptr) {
+            *error = "Not a regular file: " + path;
+        }
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        open_ = true;
+        return true;
+    }
+    void* addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        if (error != nullptr) {
+            *error = "Unable to map file: " + path;
+        }
+        return false;
+    }
+#if defined(MADV_SEQUENTIAL)
+    ::madvise(addr, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+    data_ = static_cast<const char*>(addr);
+    size_ = static_cast<std::size_t>(st.st_size);
+    open_ = true;
+    return true;
+}
+
+void MappedFile::release(std::size_t offset, std::size_t bytes) const {
+#if defined(MADV_DONTNEED)
+    if (data_ == nullptr || offset >= size_) {
+        return;
+    }
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t begin = (offset + page - 1) / page * page;
+    const std::size_t end = std::min(size_, offset + bytes) / page * page;
+    if (begin < end) {
+        // The mapping is private and never written, so dropped pages reload unchanged.
+        ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+    (void)bytes;
+#endif
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+#endif
+
+} // namespace stockbt
@@ -0,0 +1,171 @@
+#include "backtest/multi_symbol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include "backtest/backtester.hpp"
+#include "backtest/csv_importer.hpp"
+#include "backtest/thread_pool.hpp"
+
+namespace stockbt {
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string trim(const std::string& text) {
+    const std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    const std::size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+void raise_to(std::atomic<std::size_t>* peak, std::size_t value) {
+    std::size_t current = peak->load();
+    while (current < value && !peak->compare_exchange_weak(current, value)) {
+    }
+}
+
+bool list_directory(const std::filesystem::path& dir, std::vector<SymbolSource>* sources, std::string* error) {
+    std::map<std::string, std::filesystem::path> by_stem;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        const std::filesystem::path& path = it->path();
+        const std::string extension = path.extension().string();
+        if (extension != ".csv" && extension != ".sbt") {
+            continue;
+        }
+        auto found = by_stem.find(path.stem().string());
+        if (found == by_stem.end()) {
+            by_stem.emplace(path.stem().string(), path);
+        } else if (extension == ".csv") {
+            found->second = path;
+        }
+    }
+    if (ec) {
+        if (error != nullptr) {
+            *error = "Failed to list directory: " + dir.string();
+        }
+        return false;
+    }
+    for (const auto& entry : by_stem) {
+        sources->push_back(SymbolSource{entry.first, entry.second.string()});
+    }
+    return true;
+}
+
+bool read_manifest(const std::filesystem::path& manifest, std::vector<SymbolSource>* sources, std::string* error) {
+    std::ifstream in(manifest);
+    if (!in.is_open()) {
+        if (error != nullptr) {
+            *error = "Failed to open manifest: " + manifest.string();
+        }
+        return false;
+    }
+    const std::filesystem::path base = manifest.parent_path();
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        SymbolSource source;
+        const std::size_t comma = line.find(',');
+        std::filesystem::path path(trim(comma == std::string::npos ? line : line.substr(comma + 1)));
+        if (path.is_relative()) {
+            path = base / path;
+        }
+        source.symbol = (comma == std::string::npos) ? path.stem().string() : trim(line.substr(0, comma));
+        source.path = path.string();
+        sources->push_back(source);
+    }
+    return true;
+}
+
+} // namespace
+
+bool list_symbol_sources(const std::string& path, std::vector<SymbolSource>* sources, std::string* error) {
+    sources->clear();
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        return list_directory(path, sources, error);
+    }
+    return read_manifest(path, sources, error);
+}
+
+double SymbolResult::rows_per_second() const {
+    const double ms = import_ms + backtest_ms;
+    return (ms > 0.0) ? static_cast<double>(rows) * 1000.0 / ms : 0.0;
+}
+
+std::vector<SymbolResult> run_multi_symbol_backtest(const std::vector<SymbolSource>& sources,
+                                                    const SmaParams& params,
+                                                    const BacktestSettings& settings,
+                                                    const MultiSymbolOptions& options,
+                                                    MultiSymbolSummary* summary) {
+    const auto wall_start = std::chrono::steady_clock::now();
+    std::vector<SymbolResult> results(sources.size());
+
+    ImportOptions import_options;
+    import_options.threads = 1; // parallelism is across symbols
+    import_options.binary_cache = options.binary_cache;
+    import_options.layout = SeriesLayout::Columns;
+
+    std::atomic<std::size_t> live_datasets{0};
+    std::atomic<std::size_t> live_rows{0};
+    std::atomic<std::size_t> peak_datasets{0};
+    std::atomic<std::size_t> peak_rows{0};
+
+    WorkStealingPool pool(options.threads);
+    pool.parallel_for(sources.size(), [&](std::size_t index, std::size_t) {
+        SymbolResult& result = results[index];
+        result.symbol = sources[index].symbol;
+        result.path = sources[index].path;
+
+        const auto import_start = std::chrono::steady_clock::now();
+        ImportResult imported = import_ohlcv_csv(sources[index].path, options.date_format, import_options);
+        result.import_ms = elapsed_ms(import_start);
+        if (!imported.success) {
+            result.error = imported.errors.empty() ? "Import failed." : imported.errors.front().message;
+            return;
+        }
+
+        result.rows = imported.columns.size();
+        raise_to(&peak_datasets, live_datasets.fetch_add(1) + 1);
+        raise_to(&peak_rows, live_rows.fetch_add(result.rows) + result.rows);
+
+        const auto backtest_start = std::chrono::steady_clock::now();
+        result.metrics = run_sma_backtest_metrics(ColumnsView(imported.columns), params, settings);
+        result.backtest_ms = elapsed_ms(backtest_start);
+        result.success = true;
+
+        imported = ImportResult{};
+        live_rows.fetch_sub(result.rows);
+        live_datasets.fetch_sub(1);
+    });
+
+    if (summary != nullptr) {
+        *summary = MultiSymbolSummary{};
+        summary->symbols = results.size();
+        for (const SymbolResult& result : results) {
+            summary->failed += result.success ? 0 : 1;
+            summary->total_rows += result.rows;
+        }
+        summary->wall_ms = elapsed_ms(wall_start);
+        summary->peak_datasets = peak_datasets.load();
+        summary->peak_rows = peak_rows.load();
+    }
+    return results;
+}
+
+} // namespace stockbt
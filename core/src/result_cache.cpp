@@ -0,0 +1,274 @@
+#include "backtest/result_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "backtest/mapped_file.hpp"
+#include "columnar_file.hpp"
+
+namespace stockbt {
+namespace {
+
+// Layout of the cache file; the engine version that produced the entries is stored
+// next to it.
+constexpr uint32_t kCacheVersion = 1;
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t bits_of(double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double double_of(uint64_t bits) {
+    double value = 0.0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// FNV-1a over 64-bit words rather than bytes, one word per field.
+void mix(uint64_t* hash, uint64_t word) {
+    *hash = (*hash ^ word) * kFnvPrime;
+}
+
+template <typename Bars>
+uint64_t hash_rows(const Bars& bars, std::size_t n) {
+    uint64_t hash = kFnvOffset;
+    for (std::size_t i = 0; i < n; ++i) {
+        mix(&hash, static_cast<uint64_t>(bars.ts(i)));
+        mix(&hash, bits_of(bars.open(i)));
+        mix(&hash, bits_of(bars.close(i)));
+    }
+    mix(&hash, static_cast<uint64_t>(n));
+    return hash;
+}
+
+struct CandleFields {
+    CandleView candles;
+    int64_t ts(std::size_t i) const { return candles[i].ts; }
+    double open(std::size_t i) const { return candles[i].o; }
+    double close(std::size_t i) const { return candles[i].c; }
+};
+
+struct ColumnFields {
+    ColumnsView columns;
+    int64_t ts(std::size_t i) const { return columns.ts()[i]; }
+    double open(std::size_t i) const { return columns.o()[i]; }
+    double close(std::size_t i) const { return columns.c()[i]; }
+};
+
+constexpr const char* kSettingColumns[5] = {
+    "starting_cash", "commission_pct", "position_size_pct", "stop_loss_pct", "take_profit_pct"};
+
+} // namespace
+
+uint64_t hash_series(CandleView candles) {
+    return hash_rows(CandleFields{candles}, candles.size());
+}
+
+uint64_t hash_series(ColumnsView columns) {
+    return hash_rows(ColumnFields{columns}, columns.size());
+}
+
+bool MetricsCache::Key::operator==(const Key& other) const {
+    return dataset == other.dataset && fast == other.fast && slow == other.slow &&
+           std::equal(settings, settings + 5, other.settings);
+}
+
+std::size_t MetricsCache::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = kFnvOffset;
+    mix(&hash, key.dataset);
+    mix(&hash, key.fast);
+    mix(&hash, key.slow);
+    for (uint64_t bits : key.settings) {
+        mix(&hash, bits);
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+MetricsCache::Key MetricsCache::make_key(uint64_t dataset, const SmaParams& params, const BacktestSettings& settings) {
+    return Key{dataset,
+               params.fast_window,
+               params.slow_window,
+               {bits_of(settings.starting_cash),
+                bits_of(settings.commission_pct),
+                bits_of(settings.position_size_pct),
+                bits_of(settings.stop_loss_pct),
+                bits_of(settings.take_profit_pct)}};
+}
+
+const Metrics* MetricsCache::find(uint64_t dataset, const SmaParams& params, const BacktestSettings& settings) {
+    const auto it = entries_.find(make_key(dataset, params, settings));
+    if (it == entries_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    return &it->second;
+}
+
+void MetricsCache::insert(uint64_t dataset,
+                          const SmaParams& params,
+                          const BacktestSettings& settings,
+                          const Metrics& metrics) {
+    entries_[make_key(dataset, params, settings)] = metrics;
+}
+
+bool MetricsCache::save(const std::string& path, std::string* error) const {
+    // Sorted so the same entries always produce the same file.
+    std::vector<std::pair<Key, Metrics>> sorted(entries_.begin(), entries_.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        const Key& x = a.first;
+        const Key& y = b.first;
+        if (x.dataset != y.dataset) {
+            return x.dataset < y.dataset;
+        }
+        if (x.fast != y.fast) {
+            return x.fast < y.fast;
+        }
+        if (x.slow != y.slow) {
+            return x.slow < y.slow;
+        }
+        return std::lexicographical_compare(x.settings, x.settings + 5, y.settings, y.settings + 5);
+    });
+
+    const std::size_t rows = sorted.size();
+    std::vector<int64_t> dataset(rows);
+    std::vector<int64_t> fast(rows);
+    std::vector<int64_t> slow(rows);
+    std::vector<double> setting[5];
+    std::vector<double> total_return(rows);
+    std::vector<double> total_pnl(rows);
+    std::vector<int64_t> trades(rows);
+    std::vector<double> win_rate(rows);
+    std::vector<double> avg_trade(rows);
+    std::vector<double> max_dd(rows);
+    for (std::vector<double>& column : setting) {
+        column.resize(rows);
+    }
+    for (std::size_t i = 0; i < rows; ++i) {
+        const Key& key = sorted[i].first;
+        const Metrics& metrics = sorted[i].second;
+        dataset[i] = static_cast<int64_t>(key.dataset);
+        fast[i] = static_cast<int64_t>(key.fast);
+        slow[i] = static_cast<int64_t>(key.slow);
+        for (int k = 0; k < 5; ++k) {
+            setting[k][i] = double_of(key.settings[k]);
+        }
+        total_return[i] = metrics.total_return_pct;
+        total_pnl[i] = metrics.total_pnl;
+        trades[i] = metrics.trades;
+        win_rate[i] = metrics.win_rate_pct;
+        avg_trade[i] = metrics.avg_trade_return_pct;
+        max_dd[i] = metrics.max_drawdown_pct;
+    }
+
+    columnar::ByteWriter meta;
+    meta.put<uint32_t>(kCacheVersion);
+    meta.put<uint32_t>(kEngineVersion);
+    const std::size_t bytes = rows * 8;
+    const columnar::Encoding varint = columnar::Encoding::Varint;
+    std::vector<columnar::ColumnSource> columns = {
+        {"dataset", columnar::ColumnType::Int64, dataset.data(), bytes, varint},
+        {"fast", columnar::ColumnType::Int64, fast.data(), bytes, varint},
+        {"slow", columnar::ColumnType::Int64, slow.data(), bytes, varint},
+    };
+    for (int k = 0; k < 5; ++k) {
+        columns.push_back({kSettingColumns[k], columnar::ColumnType::Float64, setting[k].data(), bytes, varint});
+    }
+    columns.push_back({"total_return_pct", columnar::ColumnType::Float64, total_return.data(), bytes, varint});
+    columns.push_back({"total_pnl", columnar::ColumnType::Float64, total_pnl.data(), bytes, varint});
+    columns.push_back({"trades", columnar::ColumnType::Int64, trades.data(), bytes, varint});
+    columns.push_back({"win_rate_pct", columnar::ColumnType::Float64, win_rate.data(), bytes, varint});
+    columns.push_back({"avg_trade_return_pct", columnar::ColumnType::Float64, avg_trade.data(), bytes, varint});
+    columns.push_back({"max_drawdown_pct", columnar::ColumnType::Float64, max_dd.data(), bytes, varint});
+    return columnar::write_file(path, columnar::FileKind::MetricsCache, rows, meta.data(), columns, error);
+}
+
+bool MetricsCache::load(const std::string& path, std::string* error) {
+    entries_.clear();
+    discarded_ = 0;
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return true;
+    }
+    MappedFile file;
+    if (!file.open(path, error)) {
+        return false;
+    }
+    auto fail = [&](const std::string& message) {
+        if (error != nullptr) {
+            *error = message + ": " + path;
+        }
+        return false;
+    };
+
+    columnar::Reader reader;
+    std::string reader_error;
+    if (!reader.open(file.data(), file.size(), columnar::FileKind::MetricsCache, &reader_error)) {
+        return fail(reader_error);
+    }
+    columnar::ByteReader meta = reader.meta();
+    uint32_t version = 0;
+    uint32_t engine_version = 0;
+    if (!meta.get(&version) || !meta.get(&engine_version)) {
+        return fail("Corrupt result cache metadata");
+    }
+    if (version != kCacheVersion) {
+        return fail("Unsupported result cache version");
+    }
+    if (engine_version != kEngineVersion) {
+        discarded_ = static_cast<std::size_t>(reader.row_count());
+        return true;
+    }
+
+    std::vector<int64_t> dataset;
+    std::vector<int64_t> fast;
+    std::vector<int64_t> slow;
+    std::vector<double> setting[5];
+    std::vector<double> total_return;
+    std::vector<double> total_pnl;
+    std::vector<int64_t> trades;
+    std::vector<double> win_rate;
+    std::vector<double> avg_trade;
+    std::vector<double> max_dd;
+    bool ok = reader.read_column("dataset", &dataset) && reader.read_column("fast", &fast) &&
+              reader.read_column("slow", &slow) && reader.read_column("total_return_pct", &total_return) &&
+              reader.read_column("total_pnl", &total_pnl) && reader.read_column("trades", &trades) &&
+              reader.read_column("win_rate_pct", &win_rate) &&
+              reader.read_column("avg_trade_return_pct", &avg_trade) &&
+              reader.read_column("max_drawdown_pct", &max_dd);
+    for (int k = 0; k < 5 && ok; ++k) {
+        ok = reader.read_column(kSettingColumns[k], &setting[k]);
+    }
+    if (!ok) {
+        return fail("Missing or corrupt result cache column");
+    }
+
+    const std::size_t rows = static_cast<std::size_t>(reader.row_count());
+    entries_.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        Key key;
+        key.dataset = static_cast<uint64_t>(dataset[i]);
+        key.fast = static_cast<uint64_t>(fast[i]);
+        key.slow = static_cast<uint64_t>(slow[i]);
+        for (int k = 0; k < 5; ++k) {
+            key.settings[k] = bits_of(setting[k][i]);
+        }
+        Metrics& metrics = entries_[key];
+        metrics.total_return_pct = total_return[i];
+        metrics.total_pnl = total_pnl[i];
+        metrics.trades = static_cast<int>(trades[i]);
+        metrics.win_rate_pct = win_rate[i];
+        metrics.avg_trade_return_pct = avg_trade[i];
+        metrics.max_drawdown_pct = max_dd[i];
+    }
+    return true;
+}
+
+} // namespace stockbt
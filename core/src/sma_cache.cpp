@@ -0,0 +1,68 @@
+#include "backtest/sma_cache.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "backtest/indicators.hpp"
+#include "backtest/thread_pool.hpp"
+
+namespace stockbt {
+namespace {
+
+// Windows handed to one rolling_sma_batch call, enough to fill an AVX2 register.
+constexpr std::size_t kWindowsPerTask = 4;
+
+} // namespace
+
+SmaCache::SmaCache(CandleView candles, std::vector<std::size_t> windows, WorkStealingPool* pool)
+    : rows_(candles.size()) {
+    std::vector<double> closes(rows_);
+    for (std::size_t i = 0; i < rows_; ++i) {
+        closes[i] = candles[i].c;
+    }
+    build(closes.data(), std::move(windows), pool);
+}
+
+SmaCache::SmaCache(ColumnsView columns, std::vector<std::size_t> windows, WorkStealingPool* pool)
+    : rows_(columns.size()) {
+    build(columns.c(), std::move(windows), pool);
+}
+
+void SmaCache::build(const double* closes, std::vector<std::size_t> windows, WorkStealingPool* pool) {
+    windows_ = std::move(windows);
+    std::sort(windows_.begin(), windows_.end());
+    windows_.erase(std::unique(windows_.begin(), windows_.end()), windows_.end());
+    windows_.erase(std::remove(windows_.begin(), windows_.end(), std::size_t{0}), windows_.end());
+    values_.resize(windows_.size());
+    for (std::vector<double>& values : values_) {
+        values.resize(rows_);
+    }
+
+    const std::size_t tasks = (windows_.size() + kWindowsPerTask - 1) / kWindowsPerTask;
+    const auto compute = [&](std::size_t task, std::size_t) {
+        const std::size_t first = task * kWindowsPerTask;
+        const std::size_t count = std::min(kWindowsPerTask, windows_.size() - first);
+        double* out[kWindowsPerTask];
+        for (std::size_t k = 0; k < count; ++k) {
+            out[k] = values_[first + k].data();
+        }
+        rolling_sma_batch(closes, rows_, windows_.data() + first, count, out);
+    };
+    if (pool != nullptr) {
+        pool->parallel_for(tasks, compute);
+    } else {
+        for (std::size_t task = 0; task < tasks; ++task) {
+            compute(task, 0);
+        }
+    }
+}
+
+const double* SmaCache::find(std::size_t window) const {
+    const auto it = std::lower_bound(windows_.begin(), windows_.end(), window);
+    if (it == windows_.end() || *it != window) {
+        return nullptr;
+    }
+    return values_[static_cast<std::size_t>(it - windows_.begin())].data();
+}
+
+} // namespace stockbt
@@ -0,0 +1,84 @@
+#pragma once
+
+// SMA crossover strategy shared by the backtest entry points, pruned sweeps and
+// IncrementalSmaBacktest. Internal to core.
+
+#include <cstddef>
+
+#include "backtest/engine.hpp"
+#include "backtest/types.hpp"
+
+namespace stockbt {
+
+// Averages of the last bar that had both windows filled.
+struct SmaCrossState {
+    double prev_fast{0.0};
+    double prev_slow{0.0};
+    bool prev_valid{false};
+};
+
+// Reads precomputed averages, e.g. from an SmaCache.
+class CachedSma {
+public:
+    CachedSma(const double* fast, const double* slow) : fast_(fast), slow_(slow) {}
+
+    void advance(std::size_t i) { i_ = i; }
+
+    double fast() const { return fast_[i_]; }
+    double slow() const { return slow_[i_]; }
+
+private:
+    const double* fast_;
+    const double* slow_;
+    std::size_t i_{0};
+};
+
+// SMA crossover: enter when the fast average crosses above the slow one, exit on the
+// cross below. Sma provides advance(i), called once per bar in order, then fast() and
+// slow() for that bar.
+template <typename Sma>
+class SmaCrossStrategy {
+public:
+    SmaCrossStrategy(Sma& sma, const SmaParams& params, const SmaCrossState& state = SmaCrossState{})
+        : sma_(sma), params_(params), state_(state) {}
+
+    const SmaCrossState& state() const { return state_; }
+
+    const char* invalid_reason() const {
+        return params_.is_valid() ? nullptr
+                                  : "Backtest skipped: invalid SMA parameters (require fast < slow and > 0).";
+    }
+    std::size_t warmup_bars() const { return params_.slow_window; }
+    const char* short_data_warning() const {
+        return "Dataset length is below slow_window. No signals/trades generated.";
+    }
+
+    Signal on_bar(std::size_t i) {
+        sma_.advance(i);
+        if (i + 1 < params_.fast_window || i + 1 < params_.slow_window) {
+            return Signal::None;
+        }
+
+        const double fast = sma_.fast();
+        const double slow = sma_.slow();
+        Signal signal = Signal::None;
+        if (state_.prev_valid) {
+            if (state_.prev_fast <= state_.prev_slow && fast > slow) {
+                signal = Signal::Enter;
+            } else if (state_.prev_fast >= state_.prev_slow && fast < slow) {
+                signal = Signal::Exit;
+            }
+        }
+        state_.prev_fast = fast;
+        state_.prev_slow = slow;
+        state_.prev_valid = true;
+        return signal;
+    }
+
+private:
+    Sma& sma_;
+    const SmaParams& params_;
+    SmaCrossState state_;
+};
+
+} // namespace stockbt
@@ -0,0 +1,70 @@
+#include "backtest/stats.hpp"
+
+#include <cstdio>
+
+namespace stockbt {
+
+namespace {
+
+std::string format_ms(double ms) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.1f ms", ms);
+    return buffer;
+}
+
+} // namespace
+
+const char* row_drop_reason_name(RowDropReason reason) {
+    switch (reason) {
+    case RowDropReason::MissingFields:
+        return "missing fields";
+    case RowDropReason::InvalidTimestamp:
+        return "invalid timestamp";
+    case RowDropReason::InvalidNumber:
+        return "invalid number";
+    case RowDropReason::NonPositivePrice:
+        return "non-positive price";
+    case RowDropReason::NegativeVolume:
+        return "negative volume";
+    }
+    return "unknown";
+}
+
+std::string format_import_stats(const ImportStats& stats) {
+    if (!stats.collected) {
+        return std::string();
+    }
+    if (stats.from_cache) {
+        return "Import: loaded from binary cache in " + format_ms(stats.total_ms);
+    }
+
+    std::string line = "Import: " + std::to_string(stats.rows_parsed) + " rows parsed in " + format_ms(stats.parse_ms);
+    std::size_t dropped = 0;
+    std::string reasons;
+    for (std::size_t i = 0; i < kRowDropReasons; ++i) {
+        if (stats.dropped_by_reason[i] == 0) {
+            continue;
+        }
+        reasons += reasons.empty() ? " (" : ", ";
+        reasons += row_drop_reason_name(static_cast<RowDropReason>(i));
+        reasons += ": " + std::to_string(stats.dropped_by_reason[i]);
+        dropped += stats.dropped_by_reason[i];
+    }
+    line += ", " + std::to_string(dropped) + " dropped" + (reasons.empty() ? "" : reasons + ")");
+    line += ", sort/dedupe " + format_ms(stats.sort_ms) + (stats.sorted ? " (unsorted input, " : " (already sorted, ");
+    line += std::to_string(stats.duplicates_removed) + " duplicates)";
+    line += ", total " + format_ms(stats.total_ms);
+    return line;
+}
+
+std::string format_backtest_stats(const BacktestStats& stats) {
+    if (!stats.collected) {
+        return std::string();
+    }
+    char rate[32];
+    std::snprintf(rate, sizeof(rate), "%.2fM", stats.bars_per_sec() / 1e6);
+    return "Backtest: " + std::to_string(stats.bars) + " bars in " + format_ms(stats.elapsed_ms) + " (" + rate +
+           " bars/s), " + std::to_string(stats.trades) + " trades";
+}
+
+} // namespace stockbt
@@ -0,0 +1,42 @@
+#include "backtest/streaming.hpp"
+
+#include "backtest/exporter.hpp"
+#include "backtest/incremental_backtest.hpp"
+
+namespace stockbt {
+
+StreamingBacktestResult run_streaming_sma_backtest(const std::string& path,
+                                                   DateFormat date_format,
+                                                   const SmaParams& params,
+                                                   const BacktestSettings& settings,
+                                                   const StreamingBacktestOptions& options) {
+    StreamingBacktestResult result;
+    if (!params.is_valid()) {
+        result.error = "Backtest skipped: invalid SMA parameters (require fast < slow and > 0).";
+        return result;
+    }
+
+    StreamingCsvExporter exporter;
+    if (!exporter.open(options.equity_csv, options.trades_csv, &result.error)) {
+        return result;
+    }
+    IncrementalSmaBacktest backtest(params, settings);
+    backtest.set_observer(&exporter);
+
+    result.input = stream_ohlcv(path, date_format, options.input, [&](ColumnsView chunk, std::string* error) {
+        return backtest.append(chunk, error);
+    });
+    if (!result.input.success) {
+        result.error = result.input.errors.empty() ? "Import failed." : result.input.errors.front().message;
+        return result;
+    }
+
+    result.metrics = backtest.finish();
+    if (!exporter.finish(&result.error)) {
+        return result;
+    }
+    result.success = true;
+    return result;
+}
+
+} // namespace stockbt
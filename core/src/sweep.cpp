@@ -0,0 +1,522 @@
+#include "backtest/sweep.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <utility>
+
+#include "backtest/backtester.hpp"
+#include "backtest/engine.hpp"
+#include "backtest/progress.hpp"
+#include "backtest/result_cache.hpp"
+#include "backtest/sma_cache.hpp"
+#include "backtest/thread_pool.hpp"
+#include "sma_cross.hpp"
+
+namespace stockbt {
+
+std::vector<SmaParams> enumerate_sweep_cells(const SweepGrid& grid, std::size_t train_rows, std::size_t test_rows) {
+    std::vector<SmaParams> cells;
+    if (grid.step == 0) {
+        return cells;
+    }
+    for (std::size_t fast = grid.fast_min; fast <= grid.fast_max; fast += grid.step) {
+        for (std::size_t slow = grid.slow_min; slow <= grid.slow_max; slow += grid.step) {
+            SmaParams params;
+            params.fast_window = fast;
+            params.slow_window = slow;
+            if (!params.is_valid()) {
+                continue;
+            }
+            if (train_rows < params.slow_window || test_rows < params.slow_window) {
+                continue;
+            }
+            cells.push_back(params);
+        }
+    }
+    return cells;
+}
+
+std::vector<BatchConfig> enumerate_sweep_configs(const SweepGrid& grid,
+                                                 const BacktestSettings& settings,
+                                                 std::size_t train_rows,
+                                                 std::size_t test_rows) {
+    const std::vector<double> stops =
+        grid.stop_loss_pcts.empty() ? std::vector<double>{settings.stop_loss_pct} : grid.stop_loss_pcts;
+    const std::vector<double> takes =
+        grid.take_profit_pcts.empty() ? std::vector<double>{settings.take_profit_pct} : grid.take_profit_pcts;
+
+    std::vector<BatchConfig> configs;
+    for (const SmaParams& params : enumerate_sweep_cells(grid, train_rows, test_rows)) {
+        for (double stop : stops) {
+            for (double take : takes) {
+                BatchConfig config;
+                config.params = params;
+                config.stop_loss_pct = stop;
+                config.take_profit_pct = take;
+                configs.push_back(config);
+            }
+        }
+    }
+    return configs;
+}
+
+namespace {
+
+void fill_row_keys(const std::vector<BatchConfig>& configs,
+                   const std::vector<std::size_t>& cells,
+                   std::vector<SweepRow>* rows) {
+    for (std::size_t index = 0; index < configs.size(); ++index) {
+        SweepRow& row = (*rows)[index];
+        row.cell = cells[index];
+        row.fast = configs[index].params.fast_window;
+        row.slow = configs[index].params.slow_window;
+        row.stop_loss_pct = configs[index].stop_loss_pct;
+        row.take_profit_pct = configs[index].take_profit_pct;
+    }
+}
+
+BacktestSettings cell_settings(const BacktestSettings& settings, const BatchConfig& config) {
+    BacktestSettings result = settings;
+    result.stop_loss_pct = config.stop_loss_pct;
+    result.take_profit_pct = config.take_profit_pct;
+    return result;
+}
+
+std::vector<std::size_t> config_windows(const std::vector<BatchConfig>& configs) {
+    std::vector<std::size_t> windows;
+    windows.reserve(configs.size() * 2);
+    for (const BatchConfig& config : configs) {
+        windows.push_back(config.params.fast_window);
+        windows.push_back(config.params.slow_window);
+    }
+    return windows;
+}
+
+RowBars bars_of(CandleView candles) { return RowBars(candles); }
+ColumnBars bars_of(ColumnsView columns) { return ColumnBars(columns); }
+
+// Input of the batch engine, which reads only ts, open and close; for row storage those
+// three are copied into *storage.
+ColumnsView batch_columns(CandleView candles, SeriesColumns* storage) {
+    storage->ts.resize(candles.size());
+    storage->o.resize(candles.size());
+    storage->c.resize(candles.size());
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        storage->ts[i] = candles[i].ts;
+        storage->o[i] = candles[i].o;
+        storage->c[i] = candles[i].c;
+    }
+    return ColumnsView(storage->ts.data(), storage->o.data(), nullptr, nullptr, storage->c.data(), nullptr,
+                       candles.size());
+}
+
+ColumnsView batch_columns(ColumnsView columns, SeriesColumns*) { return columns; }
+
+// Train run of one cell in a pruned sweep, resumable between bar ranges like
+// IncrementalSmaBacktest.
+struct CellRun {
+    BacktestSettings settings;
+    ExecutionState execution;
+    MetricsState recorder;
+    SmaCrossState cross;
+    std::size_t bars{0}; // bars consumed
+    SweepPruneReason pruned{SweepPruneReason::None};
+};
+
+SweepPruneReason threshold_breach(const SweepPruning& pruning, const MetricsState& state) {
+    const double peak = std::max(state.peak, state.last);
+    const double dd = (peak > 0.0) ? (state.last - peak) / peak : 0.0;
+    if (pruning.max_drawdown_pct > 0.0 && std::min(state.min_dd, dd) * 100.0 < -pruning.max_drawdown_pct) {
+        return SweepPruneReason::Drawdown;
+    }
+    if (pruning.min_equity > 0.0 && state.last < pruning.min_equity) {
+        return SweepPruneReason::Equity;
+    }
+    return SweepPruneReason::None;
+}
+
+// Consumes bars [run->bars, end) with the same per-bar steps as run_strategy, stopping
+// after the bar that breaches a threshold. The last bar is never pruned.
+template <typename Bars>
+void advance_cell(const Bars& bars,
+                  const SmaParams& params,
+                  const SmaCache& cache,
+                  const SweepPruning& pruning,
+                  std::size_t end,
+                  CellRun* run) {
+    Metrics unused;
+    MetricsRecorder recorder(&unused, run->recorder);
+    ExecutionCore<MetricsRecorder> core(run->settings, recorder, run->execution);
+    CachedSma sma(cache.find(params.fast_window), cache.find(params.slow_window));
+    SmaCrossStrategy<CachedSma> strategy(sma, params, run->cross);
+    const std::size_t n = bars.size();
+    std::size_t i = run->bars;
+    while (i < end) {
+        const bool has_next = i + 1 < n;
+        core.fill_pending(bars.ts(i), bars.open(i));
+        core.on_signal(strategy.on_bar(i), has_next);
+        core.close_bar(i, bars.close(i), has_next);
+        ++i;
+        if (has_next) {
+            run->pruned = threshold_breach(pruning, recorder.state());
+            if (run->pruned != SweepPruneReason::None) {
+                break;
+            }
+        }
+    }
+    run->bars = i;
+    run->execution = core.state();
+    run->recorder = recorder.state();
+    run->cross = strategy.state();
+}
+
+// Metrics over the bars consumed so far, closing an open position at the last of them.
+template <typename Bars>
+Metrics cell_metrics(const Bars& bars, const CellRun& run) {
+    Metrics metrics;
+    if (run.bars == 0) {
+        return metrics;
+    }
+    MetricsRecorder recorder(&metrics, run.recorder);
+    ExecutionCore<MetricsRecorder> core(run.settings, recorder, run.execution);
+    core.finish(bars.ts(run.bars - 1), bars.close(run.bars - 1));
+    recorder.finish(run.settings);
+    return metrics;
+}
+
+// Successive halving rung ends: n / 2^(rungs - 1), ..., n / 2, then n. Prefixes that do
+// not cover every slow window would rank cells on warmup bars only and are skipped.
+std::vector<std::size_t> rung_ends(std::size_t n,
+                                   const SweepPruning& pruning,
+                                   const std::vector<BatchConfig>& configs) {
+    std::size_t longest = 0;
+    for (const BatchConfig& config : configs) {
+        longest = std::max(longest, config.params.slow_window);
+    }
+    std::vector<std::size_t> ends;
+    for (std::size_t rung = pruning.rungs; pruning.keep_top > 0 && rung > 1; --rung) {
+        const std::size_t end = (rung - 1 < 64) ? n >> (rung - 1) : 0;
+        if (end >= longest && end > 0 && (ends.empty() || end > ends.back())) {
+            ends.push_back(end);
+        }
+    }
+    ends.push_back(n);
+    return ends;
+}
+
+template <typename View>
+void run_pruned_sweep(View train,
+                      View test,
+                      const std::vector<BatchConfig>& configs,
+                      const BacktestSettings& settings,
+                      const SweepOptions& options,
+                      WorkStealingPool* pool,
+                      std::vector<SweepRow>* rows) {
+    const SweepPruning& pruning = options.pruning;
+    const SmaCache train_cache(train, config_windows(configs), pool);
+    const auto bars = bars_of(train);
+
+    std::vector<CellRun> runs(configs.size());
+    for (std::size_t index = 0; index < configs.size(); ++index) {
+        runs[index].settings = cell_settings(settings, configs[index]);
+        runs[index].execution = ExecutionCore<MetricsRecorder>::initial_state(runs[index].settings);
+    }
+
+    std::vector<std::size_t> active(configs.size());
+    std::iota(active.begin(), active.end(), std::size_t{0});
+    const std::vector<std::size_t> ends = rung_ends(train.size(), pruning, configs);
+    for (std::size_t rung = 0; rung < ends.size() && !active.empty(); ++rung) {
+        pool->parallel_for(active.size(), [&](std::size_t k, std::size_t) {
+            if (is_cancelled(options.progress)) {
+                return;
+            }
+            const std::size_t index = active[k];
+            advance_cell(bars, configs[index].params, train_cache, pruning, ends[rung], &runs[index]);
+        });
+        if (is_cancelled(options.progress)) {
+            return;
+        }
+        report_progress(options.progress, rung + 1, ends.size() + 1);
+
+        std::vector<std::size_t> survivors;
+        for (std::size_t index : active) {
+            if (runs[index].pruned == SweepPruneReason::None) {
+                survivors.push_back(index);
+            }
+        }
+        const std::size_t keep = std::max(pruning.keep_top, (survivors.size() + 1) / 2);
+        if (ends[rung] < train.size() && survivors.size() > keep) {
+            std::vector<Metrics> prefix(configs.size());
+            for (std::size_t index : survivors) {
+                prefix[index] = cell_metrics(bars, runs[index]);
+            }
+            std::stable_sort(survivors.begin(), survivors.end(), [&](std::size_t a, std::size_t b) {
+                return ranks_above(prefix[a], prefix[b]);
+            });
+            for (std::size_t k = keep; k < survivors.size(); ++k) {
+                runs[survivors[k]].pruned = SweepPruneReason::Halving;
+            }
+            survivors.resize(keep);
+            std::sort(survivors.begin(), survivors.end());
+        }
+        active = std::move(survivors);
+    }
+
+    std::vector<BatchConfig> kept;
+    for (std::size_t index = 0; index < configs.size(); ++index) {
+        SweepRow& row = (*rows)[index];
+        row.train = cell_metrics(bars, runs[index]);
+        row.pruned = runs[index].pruned;
+        if (row.pruned != SweepPruneReason::None) {
+            row.pruned_at_bar = runs[index].bars;
+        } else {
+            kept.push_back(configs[index]);
+        }
+    }
+
+    std::vector<Metrics> test_metrics;
+    if (options.batch) {
+        SeriesColumns test_storage;
+        run_sma_backtest_batches({BatchJob{batch_columns(test, &test_storage), &kept, &test_metrics}}, settings, pool);
+    } else {
+        const SmaCache test_cache(test, config_windows(kept), pool);
+        BacktestContext test_context;
+        test_context.sma_cache = &test_cache;
+        test_metrics.resize(kept.size());
+        pool->parallel_for(kept.size(), [&](std::size_t k, std::size_t) {
+            test_metrics[k] =
+                run_sma_backtest_metrics(test, kept[k].params, cell_settings(settings, kept[k]), test_context);
+        });
+    }
+    std::size_t next = 0;
+    for (SweepRow& row : *rows) {
+        if (row.pruned == SweepPruneReason::None) {
+            row.test = test_metrics[next++];
+        }
+    }
+}
+
+// Train and test metrics of every config without pruning.
+template <typename View>
+void run_cells(View train,
+               View test,
+               const std::vector<BatchConfig>& configs,
+               const BacktestSettings& settings,
+               const SweepOptions& options,
+               WorkStealingPool* pool,
+               std::vector<Metrics>* train_metrics,
+               std::vector<Metrics>* test_metrics) {
+    if (options.batch) {
+        SeriesColumns train_storage;
+        SeriesColumns test_storage;
+        run_sma_backtest_batches({BatchJob{batch_columns(train, &train_storage), &configs, train_metrics},
+                                  BatchJob{batch_columns(test, &test_storage), &configs, test_metrics}},
+                                 settings,
+                                 pool,
+                                 options.progress);
+        return;
+    }
+
+    const std::vector<std::size_t> windows = config_windows(configs);
+    const SmaCache train_cache(train, windows, pool);
+    const SmaCache test_cache(test, windows, pool);
+
+    BacktestContext train_context;
+    train_context.sma_cache = &train_cache;
+    BacktestContext test_context;
+    test_context.sma_cache = &test_cache;
+
+    // Cells run the metrics-only engine on the shared caches, which keeps no per-bar
+    // curves or trade lists, so unlike full backtests they need no per-worker workspace.
+    train_metrics->assign(configs.size(), Metrics{});
+    test_metrics->assign(configs.size(), Metrics{});
+    std::atomic<std::size_t> finished{0};
+    pool->parallel_for(configs.size(), [&](std::size_t index, std::size_t) {
+        if (is_cancelled(options.progress)) {
+            return;
+        }
+        const BatchConfig& config = configs[index];
+        const BacktestSettings run_settings = cell_settings(settings, config);
+        (*train_metrics)[index] = run_sma_backtest_metrics(train, config.params, run_settings, train_context);
+        (*test_metrics)[index] = run_sma_backtest_metrics(test, config.params, run_settings, test_context);
+        report_progress(options.progress, finished.fetch_add(1) + 1, configs.size());
+    });
+}
+
+template <typename View>
+std::vector<SweepRow> sweep(View train,
+                            View test,
+                            const SweepGrid& grid,
+                            const BacktestSettings& settings,
+                            const SweepOptions& options) {
+    if (!check_sweep_options(options, nullptr)) {
+        return {};
+    }
+    std::vector<BatchConfig> configs;
+    std::vector<std::size_t> cells;
+    const std::vector<BatchConfig> grid_configs = enumerate_sweep_configs(grid, settings, train.size(), test.size());
+    for (std::size_t cell = 0; cell < grid_configs.size(); ++cell) {
+        if (options.shard.contains(cell)) {
+            configs.push_back(grid_configs[cell]);
+            cells.push_back(cell);
+        }
+    }
+    std::vector<SweepRow> rows(configs.size());
+    fill_row_keys(configs, cells, &rows);
+
+    WorkStealingPool pool(options.threads);
+
+    if (options.pruning.enabled()) {
+        run_pruned_sweep(train, test, configs, settings, options, &pool, &rows);
+        return rows;
+    }
+
+    if (options.cache == nullptr) {
+        std::vector<Metrics> train_metrics;
+        std::vector<Metrics> test_metrics;
+        run_cells(train, test, configs, settings, options, &pool, &train_metrics, &test_metrics);
+        for (std::size_t index = 0; index < rows.size(); ++index) {
+            rows[index].train = train_metrics[index];
+            rows[index].test = test_metrics[index];
+        }
+        return rows;
+    }
+
+    // Cells cached on both windows are filled in; only the rest run.
+    MetricsCache& cache = *options.cache;
+    const uint64_t train_hash = hash_series(train);
+    const uint64_t test_hash = hash_series(test);
+    std::vector<std::size_t> missing;
+    std::vector<BatchConfig> missing_configs;
+    for (std::size_t index = 0; index < configs.size(); ++index) {
+        const BacktestSettings run_settings = cell_settings(settings, configs[index]);
+        const Metrics* train_hit = cache.find(train_hash, configs[index].params, run_settings);
+        const Metrics* test_hit = cache.find(test_hash, configs[index].params, run_settings);
+        if (train_hit != nullptr && test_hit != nullptr) {
+            rows[index].train = *train_hit;
+            rows[index].test = *test_hit;
+        } else {
+            missing.push_back(index);
+            missing_configs.push_back(configs[index]);
+        }
+    }
+    if (missing.empty()) {
+        return rows;
+    }
+    std::vector<Metrics> train_metrics;
+    std::vector<Metrics> test_metrics;
+    run_cells(train, test, missing_configs, settings, options, &pool, &train_metrics, &test_metrics);
+    const bool complete = !is_cancelled(options.progress);
+    for (std::size_t k = 0; k < missing.size(); ++k) {
+        SweepRow& row = rows[missing[k]];
+        row.train = train_metrics[k];
+        row.test = test_metrics[k];
+        if (complete) {
+            const BacktestSettings run_settings = cell_settings(settings, missing_configs[k]);
+            cache.insert(train_hash, missing_configs[k].params, run_settings, row.train);
+            cache.insert(test_hash, missing_configs[k].params, run_settings, row.test);
+        }
+    }
+    return rows;
+}
+
+} // namespace
+
+const char* sweep_prune_reason_name(SweepPruneReason reason) {
+    switch (reason) {
+    case SweepPruneReason::None:
+        return "";
+    case SweepPruneReason::Drawdown:
+        return "drawdown";
+    case SweepPruneReason::Equity:
+        return "equity";
+    case SweepPruneReason::Halving:
+        return "halving";
+    }
+    return "";
+}
+
+bool check_sweep_options(const SweepOptions& options, std::string* error) {
+    if (options.shard.count > 1 && options.pruning.keep_top > 0) {
+        if (error != nullptr) {
+            *error = "Successive halving ranks the whole grid and cannot be combined with sharding";
+        }
+        return false;
+    }
+    return true;
+}
+
+std::vector<SweepRow> run_parameter_sweep(CandleView train,
+                                          CandleView test,
+                                          const SweepGrid& grid,
+                                          const BacktestSettings& settings,
+                                          const SweepOptions& options) {
+    return sweep(train, test, grid, settings, options);
+}
+
+std::vector<SweepRow> run_parameter_sweep(ColumnsView train,
+                                          ColumnsView test,
+                                          const SweepGrid& grid,
+                                          const BacktestSettings& settings,
+                                          const SweepOptions& options) {
+    return sweep(train, test, grid, settings, options);
+}
+
+bool merge_sweep_shards(const std::vector<std::vector<SweepRow>>& shards,
+                        std::size_t total_cells,
+                        std::vector<SweepRow>* rows,
+                        std::string* error) {
+    auto fail = [&](const std::string& message) {
+        if (error != nullptr) {
+            *error = message;
+        }
+        return false;
+    };
+
+    std::vector<SweepRow> merged(total_cells);
+    std::vector<bool> seen(total_cells, false);
+    std::size_t filled = 0;
+    for (const std::vector<SweepRow>& shard : shards) {
+        for (const SweepRow& row : shard) {
+            if (row.cell >= total_cells) {
+                return fail("Sweep cell " + std::to_string(row.cell) + " is outside the grid");
+            }
+            if (seen[row.cell]) {
+                return fail("Sweep cell " + std::to_string(row.cell) + " appears in more than one shard");
+            }
+            if (shards.size() > 1 && row.pruned == SweepPruneReason::Halving) {
+                return fail("Sweep cell " + std::to_string(row.cell) +
+                            " was pruned by successive halving, which cannot be sharded");
+            }
+            seen[row.cell] = true;
+            merged[row.cell] = row;
+            ++filled;
+        }
+    }
+    if (filled != total_cells) {
+        return fail("Sweep shards cover " + std::to_string(filled) + " of " + std::to_string(total_cells) + " cells");
+    }
+    *rows = std::move(merged);
+    return true;
+}
+
+bool ranks_above(const Metrics& a, const Metrics& b) {
+    if (a.total_return_pct != b.total_return_pct) {
+        return a.total_return_pct > b.total_return_pct;
+    }
+    return a.max_drawdown_pct > b.max_drawdown_pct;
+}
+
+void sort_sweep_rows(std::vector<SweepRow>* rows) {
+    std::sort(rows->begin(), rows->end(), [](const SweepRow& a, const SweepRow& b) {
+        const bool a_kept = a.pruned == SweepPruneReason::None;
+        const bool b_kept = b.pruned == SweepPruneReason::None;
+        if (a_kept != b_kept) {
+            return a_kept;
+        }
+        return ranks_above(a.train, b.train);
+    });
+}
+
+} // namespace stockbt
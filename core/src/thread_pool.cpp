@@ -0,0 +1,155 @@
+#include "backtest/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace stockbt {
+
+WorkStealingPool::WorkStealingPool(std::size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<Slice>());
+    }
+
+    threads_.reserve(thread_count - 1);
+    for (std::size_t worker = 1; worker < thread_count; ++worker) {
+        threads_.emplace_back([this, worker]() { worker_loop(worker); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (threads_.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // A worker that woke up late for the previous range may still be scanning
+        // the (empty) queues; wait for it so it cannot pick up new work with a stale body.
+        done_cv_.wait(lock, [this]() { return busy_workers_ == 0; });
+
+        const std::size_t workers = queues_.size();
+        for (std::size_t w = 0; w < workers; ++w) {
+            std::lock_guard<std::mutex> slice_lock(queues_[w]->mutex);
+            queues_[w]->begin = (w * count) / workers;
+            queues_[w]->end = ((w + 1) * count) / workers;
+        }
+        body_ = &body;
+        remaining_ = count;
+        ++generation_;
+    }
+    wake_cv_.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return remaining_ == 0 && busy_workers_ == 0; });
+    body_ = nullptr;
+}
+
+void WorkStealingPool::worker_loop(std::size_t worker) {
+    std::size_t seen_generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_cv_.wait(lock, [&]() { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+            ++busy_workers_;
+        }
+
+        drain(worker);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --busy_workers_;
+        if (busy_workers_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::drain(std::size_t worker) {
+    const std::function<void(std::size_t, std::size_t)>* body = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body = body_;
+    }
+    if (body == nullptr) {
+        return;
+    }
+
+    std::size_t index = 0;
+    for (;;) {
+        if (pop_local(worker, &index)) {
+            (*body)(index, worker);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--remaining_ == 0) {
+                done_cv_.notify_all();
+            }
+            continue;
+        }
+        if (!steal(worker)) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::pop_local(std::size_t worker, std::size_t* index) {
+    Slice& own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin >= own.end) {
+        return false;
+    }
+    *index = own.begin++;
+    return true;
+}
+
+bool WorkStealingPool::steal(std::size_t worker) {
+    const std::size_t workers = queues_.size();
+    for (std::size_t offset = 1; offset < workers; ++offset) {
+        Slice& victim = *queues_[(worker + offset) % workers];
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin >= victim.end) {
+                continue;
+            }
+            const std::size_t mid = victim.begin + (victim.end - victim.begin) / 2;
+            begin = mid;
+            end = victim.end;
+            victim.end = mid;
+        }
+
+        Slice& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+} // namespace stockbt
@@ -1,12 +1,23 @@
 #include "backtest/time_utils.hpp"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 
 namespace stockbt {
 namespace {
 
-bool parse_iso(const std::string& text, std::tm* out_tm) {
+struct CivilTime {
+    int year{0};
+    int month{0};
+    int day{0};
+    int hour{0};
+    int minute{0};
+    int second{0};
+};
+
+bool parse_iso(const std::string& text, CivilTime* out) {
     int year = 0;
     int month = 0;
     int day = 0;
@@ -15,23 +26,32 @@ bool parse_iso(const std::string& text, std::tm* out_tm) {
     int second = 0;
 
     int parsed = std::sscanf(text.c_str(), "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second);
-    if (parsed < 3) {
-        parsed = std::sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
-    }
     if (parsed < 3) {
         return false;
     }
+    if (parsed < 6) {
+        // The space-separated pattern stops at 'T'; pick up the time from the ISO 'T' form.
+        int t_hour = 0;
+        int t_minute = 0;
+        int t_second = 0;
+        if (std::sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d", &year, &month, &day, &t_hour, &t_minute, &t_second) == 6) {
+            hour = t_hour;
+            minute = t_minute;
+            second = t_second;
+            parsed = 6;
+        }
+    }
 
-    out_tm->tm_year = year - 1900;
-    out_tm->tm_mon = month - 1;
-    out_tm->tm_mday = day;
-    out_tm->tm_hour = (parsed >= 6) ? hour : 0;
-    out_tm->tm_min = (parsed >= 6) ? minute : 0;
-    out_tm->tm_sec = (parsed >= 6) ? second : 0;
+    out->year = year;
+    out->month = month;
+    out->day = day;
+    out->hour = (parsed >= 6) ? hour : 0;
+    out->minute = (parsed >= 6) ? minute : 0;
+    out->second = (parsed >= 6) ? second : 0;
     return true;
 }
 
-bool parse_slash(const std::string& text, bool month_first, std::tm* out_tm) {
+bool parse_slash(const std::string& text, bool month_first, CivilTime* out) {
     int a = 0;
     int b = 0;
     int year = 0;
@@ -44,19 +64,16 @@ bool parse_slash(const std::string& text, bool month_first, std::tm* out_tm) {
         return false;
     }
 
-    const int month = month_first ? a : b;
-    const int day = month_first ? b : a;
-
-    out_tm->tm_year = year - 1900;
-    out_tm->tm_mon = month - 1;
-    out_tm->tm_mday = day;
-    out_tm->tm_hour = (parsed >= 6) ? hour : 0;
-    out_tm->tm_min = (parsed >= 6) ? minute : 0;
-    out_tm->tm_sec = (parsed >= 6) ? second : 0;
+    out->year = year;
+    out->month = month_first ? a : b;
+    out->day = month_first ? b : a;
+    out->hour = (parsed >= 6) ? hour : 0;
+    out->minute = (parsed >= 6) ? minute : 0;
+    out->second = (parsed >= 6) ? second : 0;
     return true;
 }
 
-bool parse_date_time_compact(const std::string& date_text, const std::string& time_text, std::tm* out_tm) {
+bool parse_date_time_compact(const std::string& date_text, const std::string& time_text, CivilTime* out) {
     int year = 0;
     int month = 0;
     int day = 0;
@@ -97,67 +114,272 @@ bool parse_date_time_compact(const std::string& date_text, const std::string& ti
         }
     }
 
-    out_tm->tm_year = year - 1900;
-    out_tm->tm_mon = month - 1;
-    out_tm->tm_mday = day;
-    out_tm->tm_hour = hour;
-    out_tm->tm_min = minute;
-    out_tm->tm_sec = second;
+    out->year = year;
+    out->month = month;
+    out->day = day;
+    out->hour = hour;
+    out->minute = minute;
+    out->second = second;
     return true;
 }
 
-bool is_tm_in_range(const std::tm& tm_value) {
-    return tm_value.tm_mon >= 0 && tm_value.tm_mon <= 11 && tm_value.tm_mday >= 1 && tm_value.tm_mday <= 31 &&
-           tm_value.tm_hour >= 0 && tm_value.tm_hour <= 23 && tm_value.tm_min >= 0 && tm_value.tm_min <= 59 &&
-           tm_value.tm_sec >= 0 && tm_value.tm_sec <= 60;
+bool is_in_range(const CivilTime& t) {
+    return t.month >= 1 && t.month <= 12 && t.day >= 1 && t.day <= 31 && t.hour >= 0 && t.hour <= 23 &&
+           t.minute >= 0 && t.minute <= 59 && t.second >= 0 && t.second <= 60;
 }
 
-std::optional<int64_t> tm_to_epoch_utc(std::tm tm_value) {
-    if (!is_tm_in_range(tm_value)) {
+std::optional<int64_t> civil_to_epoch_utc(const CivilTime& t) {
+    if (!is_in_range(t)) {
         return std::nullopt;
     }
-    tm_value.tm_isdst = -1;
-
-#if defined(_WIN32)
-    const std::time_t t = _mkgmtime(&tm_value);
-#else
-    const std::time_t t = timegm(&tm_value);
-#endif
-    if (t == static_cast<std::time_t>(-1)) {
+    const int64_t epoch = epoch_from_civil_utc(t.year, t.month, t.day, t.hour, t.minute, t.second);
+    // timegm's error value; kept so 1969-12-31T23:59:59 is rejected exactly as before.
+    if (epoch == -1) {
         return std::nullopt;
     }
-    return static_cast<int64_t>(t);
+    return epoch;
 }
 
-} // namespace
+// Fixed layouts read by offset. A TimestampParser keeps the layout of the first value that parses.
+enum Layout : int {
+    kGeneric = 0,
+    kIsoDate,          // YYYY-MM-DD
+    kIsoDateTime,      // YYYY-MM-DD HH:MM:SS / YYYY-MM-DDTHH:MM:SS
+    kIsoDateTimeZulu,  // YYYY-MM-DDTHH:MM:SSZ
+    kSlashDate,        // NN/NN/YYYY
+    kSlashDateTime,    // NN/NN/YYYY HH:MM:SS
+    kCompactDate,      // YYYYMMDD
+    kTimeEmpty,        //
+    kTimeHhmmss,       // HHMMSS
+    kTimeColonHms,     // HH:MM:SS
+    kTimeHhmm,         // HHMM
+    kTimeColonHm,      // HH:MM
+};
+
+bool is_digit(char ch) {
+    return static_cast<unsigned>(ch - '0') < 10u;
+}
+
+bool all_digits(std::string_view text, std::size_t pos, std::size_t count) {
+    for (std::size_t i = pos; i < pos + count; ++i) {
+        if (!is_digit(text[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int read2(std::string_view text, std::size_t pos) {
+    return (text[pos] - '0') * 10 + (text[pos + 1] - '0');
+}
+
+int read4(std::string_view text, std::size_t pos) {
+    return read2(text, pos) * 100 + read2(text, pos + 2);
+}
+
+bool matches_iso_date(std::string_view t) {
+    return all_digits(t, 0, 4) && t[4] == '-' && all_digits(t, 5, 2) && t[7] == '-' && all_digits(t, 8, 2);
+}
+
+bool matches_clock(std::string_view t, std::size_t pos) {
+    return all_digits(t, pos, 2) && t[pos + 2] == ':' && all_digits(t, pos + 3, 2) && t[pos + 5] == ':' &&
+           all_digits(t, pos + 6, 2);
+}
+
+bool matches_slash_date(std::string_view t) {
+    return all_digits(t, 0, 2) && t[2] == '/' && all_digits(t, 3, 2) && t[5] == '/' && all_digits(t, 6, 4);
+}
+
+bool matches_layout(std::string_view t, int layout) {
+    switch (layout) {
+        case kIsoDate:
+            return t.size() == 10 && matches_iso_date(t);
+        case kIsoDateTime:
+            return t.size() == 19 && matches_iso_date(t) && (t[10] == ' ' || t[10] == 'T') && matches_clock(t, 11);
+        case kIsoDateTimeZulu:
+            return t.size() == 20 && matches_iso_date(t) && t[10] == 'T' && matches_clock(t, 11) && t[19] == 'Z';
+        case kSlashDate:
+            return t.size() == 10 && matches_slash_date(t);
+        case kSlashDateTime:
+            return t.size() == 19 && matches_slash_date(t) && t[10] == ' ' && matches_clock(t, 11);
+        case kCompactDate:
+            return t.size() == 8 && all_digits(t, 0, 8);
+        case kTimeEmpty:
+            return t.empty();
+        case kTimeHhmmss:
+            return t.size() == 6 && all_digits(t, 0, 6);
+        case kTimeColonHms:
+            return t.size() == 8 && matches_clock(t, 0);
+        case kTimeHhmm:
+            return t.size() == 4 && all_digits(t, 0, 4);
+        case kTimeColonHm:
+            return t.size() == 5 && all_digits(t, 0, 2) && t[2] == ':' && all_digits(t, 3, 2);
+        default:
+            return false;
+    }
+}
+
+int detect_layout(std::string_view t, std::initializer_list<int> candidates) {
+    for (const int layout : candidates) {
+        if (matches_layout(t, layout)) {
+            return layout;
+        }
+    }
+    return kGeneric;
+}
+
+int detect_timestamp_layout(std::string_view t, DateFormat fmt) {
+    if (fmt == DateFormat::Iso) {
+        return detect_layout(t, {kIsoDate, kIsoDateTime, kIsoDateTimeZulu});
+    }
+    return detect_layout(t, {kSlashDate, kSlashDateTime});
+}
+
+int detect_time_layout(std::string_view t) {
+    return detect_layout(t, {kTimeHhmmss, kTimeColonHms, kTimeEmpty, kTimeHhmm, kTimeColonHm});
+}
 
-std::optional<int64_t> parse_timestamp_utc(const std::string& text, DateFormat fmt) {
-    std::tm tm_value{};
+// Reads a value already known to match layout.
+void read_fixed(std::string_view t, int layout, DateFormat fmt, CivilTime* out) {
+    switch (layout) {
+        case kIsoDate:
+        case kIsoDateTime:
+        case kIsoDateTimeZulu:
+            out->year = read4(t, 0);
+            out->month = read2(t, 5);
+            out->day = read2(t, 8);
+            break;
+        case kSlashDate:
+        case kSlashDateTime: {
+            const int a = read2(t, 0);
+            const int b = read2(t, 3);
+            out->year = read4(t, 6);
+            out->month = (fmt == DateFormat::Mdy) ? a : b;
+            out->day = (fmt == DateFormat::Mdy) ? b : a;
+            break;
+        }
+        case kCompactDate:
+            out->year = read4(t, 0);
+            out->month = read2(t, 4);
+            out->day = read2(t, 6);
+            break;
+        case kTimeHhmmss:
+            out->hour = read2(t, 0);
+            out->minute = read2(t, 2);
+            out->second = read2(t, 4);
+            break;
+        case kTimeColonHms:
+            out->hour = read2(t, 0);
+            out->minute = read2(t, 3);
+            out->second = read2(t, 6);
+            break;
+        case kTimeHhmm:
+            out->hour = read2(t, 0);
+            out->minute = read2(t, 2);
+            break;
+        case kTimeColonHm:
+            out->hour = read2(t, 0);
+            out->minute = read2(t, 3);
+            break;
+        default:
+            break;
+    }
+    if (layout == kIsoDateTime || layout == kIsoDateTimeZulu || layout == kSlashDateTime) {
+        out->hour = read2(t, 11);
+        out->minute = read2(t, 14);
+        out->second = read2(t, 17);
+    }
+}
+
+std::optional<int64_t> parse_timestamp_generic(std::string_view text, DateFormat fmt) {
+    const std::string owned(text);
+    CivilTime value;
     bool ok = false;
     switch (fmt) {
         case DateFormat::Iso:
-            ok = parse_iso(text, &tm_value);
+            ok = parse_iso(owned, &value);
             break;
         case DateFormat::Mdy:
-            ok = parse_slash(text, true, &tm_value);
+            ok = parse_slash(owned, true, &value);
             break;
         case DateFormat::Dmy:
-            ok = parse_slash(text, false, &tm_value);
+            ok = parse_slash(owned, false, &value);
             break;
     }
     if (!ok) {
         return std::nullopt;
     }
-    return tm_to_epoch_utc(tm_value);
+    return civil_to_epoch_utc(value);
 }
 
-std::optional<int64_t> parse_date_time_utc_yyyymmdd_hhmmss(const std::string& date_text,
-                                                           const std::string& time_text) {
-    std::tm tm_value{};
-    if (!parse_date_time_compact(date_text, time_text, &tm_value)) {
+std::optional<int64_t> parse_date_time_generic(std::string_view date_text, std::string_view time_text) {
+    CivilTime value;
+    if (!parse_date_time_compact(std::string(date_text), std::string(time_text), &value)) {
         return std::nullopt;
     }
-    return tm_to_epoch_utc(tm_value);
+    return civil_to_epoch_utc(value);
+}
+
+} // namespace
+
+int64_t epoch_from_civil_utc(int64_t year, int month, int day, int hour, int minute, int second) {
+    // Howard Hinnant's days_from_civil; linear in day, so overflowing days roll forward.
+    year -= (month <= 2) ? 1 : 0;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t yoe = year - era * 400;
+    const int64_t mp = (month > 2) ? month - 3 : month + 9;
+    const int64_t doy = (153 * mp + 2) / 5 + day - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    const int64_t days = era * 146097 + doe - 719468;
+    return days * 86400 + static_cast<int64_t>(hour) * 3600 + static_cast<int64_t>(minute) * 60 + second;
+}
+
+std::optional<int64_t> TimestampParser::parse(std::string_view text) {
+    // The first value that parses decides the layout, kGeneric included, so malformed
+    // leading values leave it open and a file in no fixed layout is detected only once.
+    if (layout_ < 0) {
+        const int detected = detect_timestamp_layout(text, fmt_);
+        const std::optional<int64_t> ts = parse_timestamp_generic(text, fmt_);
+        if (ts.has_value()) {
+            layout_ = detected;
+        }
+        return ts;
+    }
+    if (layout_ == kGeneric || !matches_layout(text, layout_)) {
+        return parse_timestamp_generic(text, fmt_);
+    }
+    CivilTime value;
+    read_fixed(text, layout_, fmt_, &value);
+    return civil_to_epoch_utc(value);
+}
+
+std::optional<int64_t> TimestampParser::parse_date_time(std::string_view date_text, std::string_view time_text) {
+    if (date_layout_ < 0) {
+        const int date_layout = detect_layout(date_text, {kCompactDate});
+        const int time_layout = detect_time_layout(time_text);
+        const std::optional<int64_t> ts = parse_date_time_generic(date_text, time_text);
+        if (ts.has_value()) {
+            date_layout_ = date_layout;
+            time_layout_ = time_layout;
+        }
+        return ts;
+    }
+    if (date_layout_ == kGeneric || time_layout_ == kGeneric || !matches_layout(date_text, date_layout_) ||
+        !matches_layout(time_text, time_layout_)) {
+        return parse_date_time_generic(date_text, time_text);
+    }
+    CivilTime value;
+    read_fixed(date_text, date_layout_, fmt_, &value);
+    read_fixed(time_text, time_layout_, fmt_, &value);
+    return civil_to_epoch_utc(value);
+}
+
+std::optional<int64_t> parse_timestamp_utc(std::string_view text, DateFormat fmt) {
+    return TimestampParser(fmt).parse(text);
+}
+
+std::optional<int64_t> parse_date_time_utc_yyyymmdd_hhmmss(std::string_view date_text, std::string_view time_text) {
+    return TimestampParser(DateFormat::Iso).parse_date_time(date_text, time_text);
 }
 
 std::string format_timestamp_utc_iso8601(int64_t ts) {
@@ -183,4 +405,50 @@ std::string format_timestamp_utc_iso8601(int64_t ts) {
     return std::string(buffer);
 }
 
+char* TimestampFormatter::format_iso8601(int64_t ts, char* out) {
+    const int64_t day = (ts >= 0 ? ts : ts - 86399) / 86400;
+    if (!has_day_ || day != day_) {
+        // Howard Hinnant's civil_from_days.
+        const int64_t z = day + 719468;
+        const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const int64_t doe = z - era * 146097;
+        const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int64_t mp = (5 * doy + 2) / 153;
+        const int64_t mday = doy - (153 * mp + 2) / 5 + 1;
+        const int64_t month = (mp < 10) ? mp + 3 : mp - 9;
+        const int64_t year = yoe + era * 400 + ((month <= 2) ? 1 : 0);
+
+        day_ = day;
+        has_day_ = true;
+        day_in_range_ = year >= 0 && year <= 9999;
+        if (day_in_range_) {
+            std::snprintf(prefix_,
+                          sizeof(prefix_),
+                          "%04d-%02d-%02d",
+                          static_cast<int>(year),
+                          static_cast<int>(month),
+                          static_cast<int>(mday));
+            prefix_[10] = 'T';
+        }
+    }
+    if (!day_in_range_) {
+        const std::string text = format_timestamp_utc_iso8601(ts);
+        const std::size_t length = std::min(text.size(), kMaxLength);
+        std::memcpy(out, text.data(), length);
+        return out + length;
+    }
+
+    const int seconds = static_cast<int>(ts - day * 86400);
+    const int fields[3] = {seconds / 3600, (seconds / 60) % 60, seconds % 60};
+    std::memcpy(out, prefix_, sizeof(prefix_));
+    char* pos = out + sizeof(prefix_);
+    for (int k = 0; k < 3; ++k) {
+        *pos++ = static_cast<char>('0' + fields[k] / 10);
+        *pos++ = static_cast<char>('0' + fields[k] % 10);
+        *pos++ = (k < 2) ? ':' : 'Z';
+    }
+    return pos;
+}
+
 } // namespace stockbt
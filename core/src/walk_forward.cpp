@@ -0,0 +1,198 @@
+#include "backtest/walk_forward.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "backtest/backtester.hpp"
+#include "backtest/engine.hpp"
+#include "backtest/result_cache.hpp"
+#include "backtest/thread_pool.hpp"
+
+namespace stockbt {
+namespace {
+
+std::size_t segment_end(const std::vector<WalkForwardFold>& folds, std::size_t index) {
+    const WalkForwardFold& fold = folds[index];
+    if (index + 1 == folds.size()) {
+        return fold.test_end;
+    }
+    return std::min(fold.test_end, folds[index + 1].test_begin);
+}
+
+BacktestSettings settings_for(const BacktestSettings& settings, const BatchConfig& config) {
+    BacktestSettings adjusted = settings;
+    adjusted.stop_loss_pct = config.stop_loss_pct;
+    adjusted.take_profit_pct = config.take_profit_pct;
+    return adjusted;
+}
+
+} // namespace
+
+std::vector<WalkForwardFold> enumerate_walk_forward_folds(std::size_t rows, const WalkForwardOptions& options) {
+    std::vector<WalkForwardFold> folds;
+    if (options.train_bars == 0 || options.test_bars == 0) {
+        return folds;
+    }
+    const std::size_t step = (options.step_bars == 0) ? options.test_bars : options.step_bars;
+    for (std::size_t test_begin = options.train_bars;
+         test_begin <= rows && rows - test_begin >= options.test_bars;
+         test_begin += step) {
+        WalkForwardFold fold;
+        fold.train_begin = (options.mode == WalkForwardMode::Anchored) ? 0 : test_begin - options.train_bars;
+        fold.train_end = test_begin;
+        fold.test_begin = test_begin;
+        fold.test_end = test_begin + options.test_bars;
+        folds.push_back(fold);
+    }
+    return folds;
+}
+
+WalkForwardResult run_walk_forward(ColumnsView data,
+                                   const SweepGrid& grid,
+                                   const BacktestSettings& settings,
+                                   const WalkForwardOptions& options) {
+    WalkForwardResult result;
+    const std::vector<WalkForwardFold> folds = enumerate_walk_forward_folds(data.size(), options);
+    result.folds.resize(folds.size());
+    if (folds.empty()) {
+        result.oos = finalize_metrics(settings.starting_cash, 0.0, TradeTally{}, settings);
+        return result;
+    }
+
+    // Train metrics found in options.cache are filled in up front; the batch jobs only
+    // run the missing configs of each fold.
+    std::vector<std::vector<BatchConfig>> configs(folds.size());
+    std::vector<std::vector<Metrics>> train_metrics(folds.size());
+    std::vector<uint64_t> train_hashes(folds.size(), 0);
+    std::vector<std::vector<std::size_t>> missing(folds.size());
+    std::vector<std::vector<BatchConfig>> missing_configs(folds.size());
+    std::vector<std::vector<Metrics>> computed(folds.size());
+    std::vector<BatchJob> jobs;
+    jobs.reserve(folds.size());
+    for (std::size_t index = 0; index < folds.size(); ++index) {
+        const WalkForwardFold& fold = folds[index];
+        configs[index] = enumerate_sweep_configs(grid,
+                                                 settings,
+                                                 fold.train_end - fold.train_begin,
+                                                 fold.test_end - fold.test_begin);
+        const ColumnsView train = data.subview(fold.train_begin, fold.train_end - fold.train_begin);
+        train_metrics[index].resize(configs[index].size());
+        if (options.cache != nullptr) {
+            train_hashes[index] = hash_series(train);
+        }
+        for (std::size_t cell = 0; cell < configs[index].size(); ++cell) {
+            const BatchConfig& config = configs[index][cell];
+            const Metrics* hit = (options.cache != nullptr)
+                                     ? options.cache->find(train_hashes[index],
+                                                           config.params,
+                                                           settings_for(settings, config))
+                                     : nullptr;
+            if (hit != nullptr) {
+                train_metrics[index][cell] = *hit;
+            } else {
+                missing[index].push_back(cell);
+                missing_configs[index].push_back(config);
+            }
+        }
+        BatchJob job;
+        job.columns = train;
+        job.configs = &missing_configs[index];
+        job.results = &computed[index];
+        jobs.push_back(job);
+    }
+
+    WorkStealingPool pool(options.threads);
+    run_sma_backtest_batches(jobs, settings, &pool);
+
+    for (std::size_t index = 0; index < folds.size(); ++index) {
+        for (std::size_t k = 0; k < missing[index].size(); ++k) {
+            train_metrics[index][missing[index][k]] = computed[index][k];
+            if (options.cache != nullptr) {
+                const BatchConfig& config = missing_configs[index][k];
+                options.cache->insert(train_hashes[index],
+                                      config.params,
+                                      settings_for(settings, config),
+                                      computed[index][k]);
+            }
+        }
+    }
+
+    for (std::size_t index = 0; index < folds.size(); ++index) {
+        WalkForwardFoldResult& fold_result = result.folds[index];
+        fold_result.fold = folds[index];
+        const std::vector<Metrics>& metrics = train_metrics[index];
+        for (std::size_t cell = 0; cell < metrics.size(); ++cell) {
+            if (!fold_result.has_best || ranks_above(metrics[cell], fold_result.train)) {
+                fold_result.has_best = true;
+                fold_result.best = configs[index][cell];
+                fold_result.train = metrics[cell];
+            }
+        }
+    }
+
+    // Out-of-sample runs of the chosen configs, one task per fold, on per-worker
+    // workspaces. Each fold keeps a copy of the equity and trades the stitching needs, so
+    // the workspace buffers stay with the worker.
+    struct Segment {
+        std::vector<double> equity;
+        std::vector<Trade> trades;
+    };
+    std::vector<Segment> segments(folds.size());
+    std::vector<BacktestWorkspace> workspaces(pool.thread_count());
+    pool.parallel_for(folds.size(), [&](std::size_t index, std::size_t worker) {
+        WalkForwardFoldResult& fold_result = result.folds[index];
+        if (!fold_result.has_best) {
+            return;
+        }
+        const WalkForwardFold& fold = folds[index];
+        const BacktestSettings fold_settings = settings_for(settings, fold_result.best);
+        const std::size_t end = segment_end(folds, index);
+        BacktestWorkspace& workspace = workspaces[worker];
+        const BacktestResult& run = run_sma_backtest(data.subview(fold.test_begin, end - fold.test_begin),
+                                                     fold_result.best.params,
+                                                     fold_settings,
+                                                     BacktestContext{},
+                                                     &workspace);
+        segments[index].equity = run.equity;
+        segments[index].trades = run.trades;
+        if (end == fold.test_end) {
+            fold_result.test = run.metrics;
+        } else {
+            fold_result.test =
+                run_sma_backtest_metrics(data.subview(fold.test_begin, fold.test_end - fold.test_begin),
+                                         fold_result.best.params,
+                                         fold_settings);
+        }
+    });
+
+    double carried = settings.starting_cash;
+    double peak = -std::numeric_limits<double>::infinity();
+    double min_dd = 0.0;
+    TradeTally tally;
+    for (std::size_t index = 0; index < folds.size(); ++index) {
+        const std::size_t begin = folds[index].test_begin;
+        const std::size_t end = segment_end(folds, index);
+        const Segment& segment = segments[index];
+        const bool traded = result.folds[index].has_best && !segment.equity.empty();
+        const double scale = (settings.starting_cash != 0.0) ? carried / settings.starting_cash : 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+            const double value = traded ? segment.equity[i - begin] * scale : carried;
+            result.oos_ts.push_back(data.ts()[i]);
+            result.oos_equity.push_back(value);
+            peak = std::max(peak, value);
+            const double dd = (peak > 0.0) ? (value - peak) / peak : 0.0;
+            min_dd = std::min(min_dd, dd);
+        }
+        if (traded) {
+            for (const Trade& trade : segment.trades) {
+                tally.add(trade);
+            }
+            carried = segment.equity.back() * scale;
+        }
+    }
+    result.oos = finalize_metrics(carried, min_dd, tally, settings);
+    return result;
+}
+
+} // namespace stockbt
@@ -1,15 +1,37 @@
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "backtest/backtester.hpp"
+#include "backtest/batch_backtester.hpp"
 #include "backtest/csv_importer.hpp"
+#include "backtest/dataset_cache.hpp"
+#include "backtest/downsampling.hpp"
+#include "backtest/engine.hpp"
 #include "backtest/exporter.hpp"
+#include "backtest/incremental_backtest.hpp"
+#include "backtest/indicators.hpp"
+#include "backtest/multi_symbol.hpp"
+#include "backtest/progress.hpp"
+#include "backtest/result_cache.hpp"
+#include "backtest/sma_cache.hpp"
+#include "backtest/stats.hpp"
+#include "backtest/streaming.hpp"
+#include "backtest/sweep.hpp"
+#include "backtest/thread_pool.hpp"
 #include "backtest/time_utils.hpp"
+#include "backtest/walk_forward.hpp"
 
 namespace {
 
@@ -48,6 +70,64 @@ bool contains_warning(const std::vector<std::string>& warnings, const std::strin
     });
 }
 
+stockbt::Series make_synthetic_series(std::size_t rows) {
+    stockbt::Series s;
+    s.reserve(rows);
+    const int64_t start = stockbt::parse_timestamp_utc("2020-01-01", stockbt::DateFormat::Iso).value_or(0);
+    double price = 100.0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        const double drift = std::sin(static_cast<double>(i) * 0.07) * 1.5 + ((static_cast<int>(i % 13) - 6) * 0.05);
+        const double open = price;
+        const double close = std::max(1.0, open + drift);
+        s.push_back({start + static_cast<int64_t>(i) * 3600, open, std::max(open, close) + 0.2,
+                     std::min(open, close) - 0.2, close, 1000.0});
+        price = close;
+    }
+    return s;
+}
+
+// "YYYY-MM-DD HH:MM:SS", the ISO layout whose time the importer reads.
+std::string csv_date_time(int64_t ts) {
+    std::string text = stockbt::format_timestamp_utc_iso8601(ts);
+    text[10] = ' ';
+    text.pop_back();
+    return text;
+}
+
+bool same_metrics(const stockbt::Metrics& a, const stockbt::Metrics& b) {
+    return a.total_return_pct == b.total_return_pct && a.total_pnl == b.total_pnl && a.trades == b.trades &&
+           a.win_rate_pct == b.win_rate_pct && a.avg_trade_return_pct == b.avg_trade_return_pct &&
+           a.max_drawdown_pct == b.max_drawdown_pct;
+}
+
+bool same_candles(const stockbt::Series& a, const stockbt::Series& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const stockbt::Candle& x, const stockbt::Candle& y) {
+               return x.ts == y.ts && x.o == y.o && x.h == y.h && x.l == y.l && x.c == y.c && x.v == y.v;
+           });
+}
+
+bool same_issues(const std::vector<stockbt::ImportIssue>& a, const std::vector<stockbt::ImportIssue>& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](const stockbt::ImportIssue& x, const stockbt::ImportIssue& y) {
+               return x.line == y.line && x.message == y.message;
+           });
+}
+
+bool same_import(const stockbt::ImportResult& a, const stockbt::ImportResult& b) {
+    return a.success == b.success && a.partial_success == b.partial_success && a.dropped_rows == b.dropped_rows &&
+           same_candles(a.candles, b.candles) && same_issues(a.warnings, b.warnings) && same_issues(a.errors, b.errors) &&
+           a.row_issues.counts == b.row_issues.counts && a.row_issues.sample_lines == b.row_issues.sample_lines;
+}
+
+std::filesystem::path write_tmp_file(const std::string& name, const std::string& content) {
+    const std::filesystem::path tmp_dir = src_path("tests/tmp");
+    std::filesystem::create_directories(tmp_dir);
+    const std::filesystem::path path = tmp_dir / name;
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+    return path;
+}
+
 void test_timestamp_format() {
     const auto ts = stockbt::parse_timestamp_utc("2024-01-05", stockbt::DateFormat::Iso);
     check_true(ts.has_value(), "ISO timestamp should parse");
@@ -63,6 +143,106 @@ void test_timestamp_format() {
                "DMY parsing should succeed");
 }
 
+std::string iso_or_null(const std::optional<int64_t>& ts) {
+    return ts.has_value() ? stockbt::format_timestamp_utc_iso8601(*ts) : "null";
+}
+
+void test_iso_t_separator_keeps_time() {
+    using stockbt::DateFormat;
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2024-01-05T10:20:30", DateFormat::Iso)) == "2024-01-05T10:20:30Z",
+               "ISO date-time with T should keep its time");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2024-01-05T10:20:30Z", DateFormat::Iso)) == "2024-01-05T10:20:30Z",
+               "ISO date-time with Z suffix should keep its time");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2024-1-5T7:05:00", DateFormat::Iso)) == "2024-01-05T07:05:00Z",
+               "unpadded ISO date-time with T should keep its time");
+
+    const stockbt::Series series = make_synthetic_series(48);
+    std::ostringstream csv;
+    csv << "Date,Open,High,Low,Close,Volume\n" << std::setprecision(17);
+    for (const stockbt::Candle& c : series) {
+        csv << stockbt::format_timestamp_utc_iso8601(c.ts) << ',' << c.o << ',' << c.h << ',' << c.l << ',' << c.c
+            << ',' << c.v << '\n';
+    }
+    const auto path = write_tmp_file("iso_t_hourly.csv", csv.str());
+    const auto imported = stockbt::import_ohlcv_csv(path.string(), DateFormat::Iso);
+    check_true(imported.success && same_candles(imported.candles, series),
+               "hourly bars with T timestamps should import as distinct bars");
+}
+
+void test_fast_timestamp_layouts() {
+    using stockbt::DateFormat;
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2024-01-05 10:20:30", DateFormat::Iso)) == "2024-01-05T10:20:30Z",
+               "ISO date-time with space should parse");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2024-1-5", DateFormat::Iso)) == "2024-01-05T00:00:00Z",
+               "non-padded ISO date should fall back to the general parser");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2023-02-30", DateFormat::Iso)) == "2023-03-02T00:00:00Z",
+               "out-of-month day should roll forward like timegm");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("2024-13-01", DateFormat::Iso)) == "null", "month 13 should be rejected");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("12/31/2023 23:59:59", DateFormat::Mdy)) == "2023-12-31T23:59:59Z",
+               "MDY date-time should parse");
+    check_true(iso_or_null(stockbt::parse_timestamp_utc("31/12/2023", DateFormat::Dmy)) == "2023-12-31T00:00:00Z",
+               "DMY date should parse");
+
+    check_true(iso_or_null(stockbt::parse_date_time_utc_yyyymmdd_hhmmss("20240102", "013000")) == "2024-01-02T01:30:00Z",
+               "compact HHMMSS time should parse");
+    check_true(iso_or_null(stockbt::parse_date_time_utc_yyyymmdd_hhmmss("20240102", "01:30:15")) == "2024-01-02T01:30:15Z",
+               "colon HH:MM:SS time should parse");
+    check_true(iso_or_null(stockbt::parse_date_time_utc_yyyymmdd_hhmmss("20240102", "0130")) == "2024-01-02T01:30:00Z",
+               "compact HHMM time should parse");
+    check_true(iso_or_null(stockbt::parse_date_time_utc_yyyymmdd_hhmmss("20240102", "930")) == "2024-01-02T09:30:00Z",
+               "short compact time should fall back to the general parser");
+    check_true(iso_or_null(stockbt::parse_date_time_utc_yyyymmdd_hhmmss("20240102", "")) == "2024-01-02T00:00:00Z",
+               "empty time should mean midnight");
+
+    stockbt::TimestampParser parser(DateFormat::Iso);
+    check_true(iso_or_null(parser.parse("2024-03-01")) == "2024-03-01T00:00:00Z", "parser should detect date layout");
+    check_true(iso_or_null(parser.parse("2024-03-02 12:00:00")) == "2024-03-02T12:00:00Z",
+               "parser should still accept other layouts after detection");
+    stockbt::TimestampParser late_parser(DateFormat::Iso);
+    check_true(!late_parser.parse("not a date").has_value() &&
+                   iso_or_null(late_parser.parse("2024-03-01 09:30:00")) == "2024-03-01T09:30:00Z" &&
+                   iso_or_null(late_parser.parse("2024-03-01 09:31:00")) == "2024-03-01T09:31:00Z",
+               "a malformed first value should not fix the parser layout");
+    stockbt::TimestampParser late_pair_parser(DateFormat::Iso);
+    check_true(!late_pair_parser.parse_date_time("2024-01", "0930").has_value() &&
+                   iso_or_null(late_pair_parser.parse_date_time("20240102", "093000")) == "2024-01-02T09:30:00Z",
+               "a malformed first date should not fix the date layout");
+    stockbt::TimestampParser generic_parser(DateFormat::Iso);
+    check_true(iso_or_null(generic_parser.parse("2024-3-1")) == "2024-03-01T00:00:00Z" &&
+                   iso_or_null(generic_parser.parse("2024-3-2 7:05:00")) == "2024-03-02T07:05:00Z" &&
+                   iso_or_null(generic_parser.parse("2024-03-03")) == "2024-03-03T00:00:00Z",
+               "a parser settled on the generic layout should keep parsing every value");
+
+    int64_t expected_days = 0;
+    bool civil_ok = true;
+    const int month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    for (int year = 1970; year < 2101; ++year) {
+        for (int month = 1; month <= 12; ++month) {
+            const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+            civil_ok = civil_ok && stockbt::epoch_from_civil_utc(year, month, 1, 0, 0, 0) == expected_days * 86400;
+            expected_days += month_days[month - 1] + ((month == 2 && leap) ? 1 : 0);
+        }
+    }
+    check_true(civil_ok, "epoch_from_civil_utc should match day counting from 1970");
+    check_true(stockbt::epoch_from_civil_utc(1969, 12, 31, 0, 0, 0) == -86400, "pre-epoch dates should be negative");
+
+    stockbt::TimestampFormatter formatter;
+    bool format_ok = true;
+    const int64_t probes[] = {0, -1, -86400, -86401, 951782400, 4102444799, 253402300799, 253402300800, -62167219200,
+                              -62167219201};
+    for (int64_t ts : probes) {
+        char text[stockbt::TimestampFormatter::kMaxLength];
+        format_ok = format_ok && std::string(text, formatter.format_iso8601(ts, text)) ==
+                                     stockbt::format_timestamp_utc_iso8601(ts);
+    }
+    for (int64_t ts = -3 * 86400; ts < 60LL * 86400 * 366; ts += 86400 / 3 + 7) {
+        char text[stockbt::TimestampFormatter::kMaxLength];
+        format_ok = format_ok && std::string(text, formatter.format_iso8601(ts, text)) ==
+                                     stockbt::format_timestamp_utc_iso8601(ts);
+    }
+    check_true(format_ok, "cached timestamp formatter should match format_timestamp_utc_iso8601");
+}
+
 void test_import_filtering_sort_and_duplicates() {
     const auto import = stockbt::import_ohlcv_csv(src_path("data/sample_mixed_invalid.csv").string(), stockbt::DateFormat::Iso);
     check_true(import.success, "mixed-invalid sample should import successfully");
@@ -304,10 +484,1622 @@ void test_regression_goldens() {
     check_true(expected_metrics == actual_metrics, "metrics.json should match golden output");
 }
 
+void test_work_stealing_pool_covers_range() {
+    stockbt::WorkStealingPool pool(4);
+    check_true(pool.thread_count() == 4, "pool should report requested thread count");
+
+    for (std::size_t count : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{1000}}) {
+        std::vector<std::atomic<int>> hits(count);
+        std::atomic<bool> bad_worker{false};
+        pool.parallel_for(count, [&](std::size_t index, std::size_t worker) {
+            if (worker >= pool.thread_count()) {
+                bad_worker = true;
+            }
+            hits[index].fetch_add(1);
+        });
+        const bool all_once = std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h == 1; });
+        check_true(all_once, "parallel_for should run every index exactly once");
+        check_true(!bad_worker, "parallel_for worker index should be below thread_count");
+    }
+}
+
+void test_parallel_sweep_matches_serial() {
+    const stockbt::Series series = make_synthetic_series(600);
+    const stockbt::CandleView train = stockbt::CandleView(series).subview(0, 400);
+    const stockbt::CandleView test = stockbt::CandleView(series).subview(400);
+
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 20;
+    grid.slow_min = 5;
+    grid.slow_max = 60;
+    grid.step = 3;
+    stockbt::BacktestSettings settings;
+    settings.stop_loss_pct = 0.03;
+
+    stockbt::SweepOptions serial;
+    serial.threads = 1;
+    stockbt::SweepOptions parallel;
+    parallel.threads = 4;
+
+    const auto serial_rows = stockbt::run_parameter_sweep(train, test, grid, settings, serial);
+    const auto parallel_rows = stockbt::run_parameter_sweep(train, test, grid, settings, parallel);
+    check_true(!serial_rows.empty(), "sweep should produce rows");
+    check_true(serial_rows.size() == parallel_rows.size(), "parallel sweep should produce the same row count");
+    if (serial_rows.size() != parallel_rows.size()) {
+        return;
+    }
+
+    bool identical = true;
+    for (std::size_t i = 0; i < serial_rows.size(); ++i) {
+        const auto& a = serial_rows[i];
+        const auto& b = parallel_rows[i];
+        identical = identical && a.fast == b.fast && a.slow == b.slow && same_metrics(a.train, b.train) &&
+                    same_metrics(a.test, b.test);
+    }
+    check_true(identical, "parallel sweep rows should match serial rows exactly and in order");
+
+    stockbt::SmaParams params;
+    params.fast_window = serial_rows.front().fast;
+    params.slow_window = serial_rows.front().slow;
+    check_true(same_metrics(serial_rows.front().train, stockbt::run_sma_backtest(train, params, settings).metrics),
+               "sweep train metrics should match a direct backtest");
+}
+
+void test_batch_backtest_matches_single_runs() {
+    const stockbt::Series series = make_synthetic_series(700);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+
+    std::vector<stockbt::BatchConfig> configs;
+    const double stops[] = {0.0, 0.02};
+    const double takes[] = {0.0, 0.015};
+    for (std::size_t fast = 1; fast <= 13; fast += 4) {
+        for (std::size_t slow = 3; slow <= 40; slow += 9) {
+            for (double stop : stops) {
+                for (double take : takes) {
+                    stockbt::BatchConfig config;
+                    config.params.fast_window = fast;
+                    config.params.slow_window = slow;
+                    config.stop_loss_pct = stop;
+                    config.take_profit_pct = take;
+                    configs.push_back(config);
+                }
+            }
+        }
+    }
+    stockbt::BatchConfig too_long;
+    too_long.params.fast_window = 10;
+    too_long.params.slow_window = 900;
+    configs.push_back(too_long);
+    stockbt::BatchConfig invalid;
+    invalid.params.fast_window = 0;
+    configs.push_back(invalid);
+    check_true(configs.size() % stockbt::kBatchLanes != 0, "batch test should leave a partial lane block");
+
+    stockbt::BacktestSettings settings;
+    settings.position_size_pct = 0.8;
+    stockbt::WorkStealingPool pool(3);
+    const std::vector<stockbt::Metrics> batched = stockbt::run_sma_backtest_batch(series, configs, settings, &pool);
+    const std::vector<stockbt::Metrics> serial =
+        stockbt::run_sma_backtest_batch(stockbt::ColumnsView(columns), configs, settings);
+    check_true(batched.size() == configs.size() && serial.size() == configs.size(),
+               "batch backtest should return one result per config");
+    if (batched.size() != configs.size() || serial.size() != configs.size()) {
+        return;
+    }
+
+    bool identical = true;
+    for (std::size_t i = 0; i < configs.size(); ++i) {
+        stockbt::BacktestSettings single = settings;
+        single.stop_loss_pct = configs[i].stop_loss_pct;
+        single.take_profit_pct = configs[i].take_profit_pct;
+        const stockbt::Metrics expected =
+            stockbt::run_sma_backtest_metrics(series, configs[i].params, single, stockbt::BacktestContext{});
+        identical = identical && same_metrics(batched[i], expected) && same_metrics(serial[i], expected);
+    }
+    check_true(identical, "batch backtest lanes should match single-config runs exactly");
+    check_true(same_metrics(batched.back(), stockbt::Metrics{}), "invalid batch config should yield default metrics");
+    check_true(stockbt::run_sma_backtest_batch(stockbt::CandleView(), configs, settings).front().trades == 0,
+               "empty dataset should yield default batch metrics");
+
+    const stockbt::CandleView train = stockbt::CandleView(series).subview(0, 450);
+    const stockbt::CandleView test = stockbt::CandleView(series).subview(450);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 14;
+    grid.slow_min = 6;
+    grid.slow_max = 40;
+    grid.step = 4;
+    grid.stop_loss_pcts = {0.01, 0.03};
+    grid.take_profit_pcts = {0.0, 0.02, 0.05};
+    stockbt::SweepOptions batch_options;
+    stockbt::SweepOptions cell_options;
+    cell_options.batch = false;
+    const auto batch_rows = stockbt::run_parameter_sweep(train, test, grid, settings, batch_options);
+    const auto cell_rows = stockbt::run_parameter_sweep(train, test, grid, settings, cell_options);
+    check_true(!batch_rows.empty() && batch_rows.size() == cell_rows.size(),
+               "batched sweep should produce the per-cell row count");
+    bool sweep_identical = batch_rows.size() == cell_rows.size();
+    for (std::size_t i = 0; sweep_identical && i < batch_rows.size(); ++i) {
+        const auto& a = batch_rows[i];
+        const auto& b = cell_rows[i];
+        sweep_identical = a.fast == b.fast && a.slow == b.slow && a.stop_loss_pct == b.stop_loss_pct &&
+                          a.take_profit_pct == b.take_profit_pct && same_metrics(a.train, b.train) &&
+                          same_metrics(a.test, b.test);
+    }
+    check_true(sweep_identical, "batched sweep rows should match per-cell rows exactly and in order");
+}
+
+void test_walk_forward() {
+    stockbt::WalkForwardOptions options;
+    options.train_bars = 300;
+    options.test_bars = 100;
+    const auto rolling = stockbt::enumerate_walk_forward_folds(760, options);
+    check_true(rolling.size() == 4, "rolling walk-forward should fit four complete folds");
+    check_true(!rolling.empty() && rolling.back().train_begin == 300 && rolling.back().test_end == 700,
+               "rolling folds should move the train window with the test window");
+    options.mode = stockbt::WalkForwardMode::Anchored;
+    options.step_bars = 50;
+    const auto anchored = stockbt::enumerate_walk_forward_folds(760, options);
+    check_true(anchored.size() == 8, "anchored walk-forward should honour step_bars");
+    check_true(!anchored.empty() && anchored.back().train_begin == 0 && anchored.back().train_end == 650,
+               "anchored folds should grow the train window from bar 0");
+
+    const stockbt::Series series = make_synthetic_series(900);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+    const stockbt::ColumnsView data(columns);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 14;
+    grid.slow_min = 6;
+    grid.slow_max = 40;
+    grid.step = 4;
+    grid.stop_loss_pcts = {0.0, 0.02};
+    stockbt::BacktestSettings settings;
+
+    options = stockbt::WalkForwardOptions{};
+    options.train_bars = 300;
+    options.test_bars = 150;
+    options.threads = 1;
+    const stockbt::WalkForwardResult serial = stockbt::run_walk_forward(data, grid, settings, options);
+    options.threads = 3;
+    const stockbt::WalkForwardResult parallel = stockbt::run_walk_forward(data, grid, settings, options);
+    check_true(serial.folds.size() == 4 && parallel.folds.size() == 4, "walk-forward should run every fold");
+    check_true(same_metrics(serial.oos, parallel.oos) && serial.oos_equity == parallel.oos_equity,
+               "walk-forward result should not depend on thread count");
+    check_true(serial.oos_equity.size() == 600 && serial.oos_ts.size() == 600,
+               "back-to-back test windows should stitch into one curve");
+    if (serial.folds.size() != 4) {
+        return;
+    }
+
+    const stockbt::WalkForwardFoldResult& first = serial.folds.front();
+    const std::vector<stockbt::BatchConfig> configs = stockbt::enumerate_sweep_configs(grid, settings, 300, 150);
+    bool best_is_max = first.has_best;
+    for (const stockbt::BatchConfig& config : configs) {
+        stockbt::BacktestSettings cell = settings;
+        cell.stop_loss_pct = config.stop_loss_pct;
+        const stockbt::Metrics train = stockbt::run_sma_backtest_metrics(data.subview(0, 300), config.params, cell);
+        best_is_max = best_is_max && !stockbt::ranks_above(train, first.train);
+    }
+    check_true(best_is_max, "walk-forward should pick the top-ranked train config");
+
+    stockbt::BacktestSettings first_settings = settings;
+    first_settings.stop_loss_pct = first.best.stop_loss_pct;
+    check_true(same_metrics(first.test,
+                            stockbt::run_sma_backtest_metrics(data.subview(300, 150), first.best.params, first_settings)),
+               "fold test metrics should match a direct run on the test window");
+
+    double compounded = 1.0;
+    int trades = 0;
+    for (const stockbt::WalkForwardFoldResult& fold : serial.folds) {
+        compounded *= 1.0 + fold.test.total_return_pct / 100.0;
+        trades += fold.test.trades;
+    }
+    check_near(serial.oos.total_return_pct, (compounded - 1.0) * 100.0, 1e-6,
+               "stitched out-of-sample return should compound the fold returns");
+    check_true(serial.oos.trades == trades, "stitched trades should sum the fold trades");
+}
+
+void test_sma_cache_matches_rolling_backtest() {
+    const stockbt::Series series = make_synthetic_series(500);
+    const stockbt::SmaCache cache(series, {3, 7, 7, 20, 45});
+    check_true(cache.windows().size() == 4, "SMA cache should dedupe windows");
+    check_true(cache.find(8) == nullptr, "SMA cache should not report missing windows");
+
+    const double* sma7 = cache.find(7);
+    check_true(sma7 != nullptr, "SMA cache should hold requested window");
+    if (sma7 != nullptr) {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < 7; ++i) {
+            sum += series[i].c;
+        }
+        check_near(sma7[6], sum / 7.0, 1e-12, "first cached SMA value should equal window mean");
+    }
+
+    stockbt::BacktestContext context;
+    context.sma_cache = &cache;
+    stockbt::BacktestSettings settings;
+    settings.take_profit_pct = 0.04;
+    for (const auto& windows : {std::pair<std::size_t, std::size_t>{3, 7}, {7, 20}, {20, 45}, {3, 45}}) {
+        stockbt::SmaParams params;
+        params.fast_window = windows.first;
+        params.slow_window = windows.second;
+        const auto rolling = stockbt::run_sma_backtest(series, params, settings);
+        const auto cached = stockbt::run_sma_backtest(series, params, settings, context);
+        check_true(same_metrics(rolling.metrics, cached.metrics), "cached SMA backtest metrics should match rolling");
+        check_true(rolling.equity == cached.equity, "cached SMA backtest equity should match rolling");
+    }
+}
+
+void test_metrics_only_matches_full_backtest() {
+    const stockbt::Series series = make_synthetic_series(400);
+    const auto end_long = stockbt::import_ohlcv_csv(src_path("data/sample_end_long.csv").string(), stockbt::DateFormat::Iso);
+    check_true(end_long.success, "sample_end_long should import for metrics-only test");
+
+    stockbt::SmaParams params;
+    params.fast_window = 2;
+    params.slow_window = 3;
+    stockbt::BacktestSettings settings;
+    check_true(same_metrics(stockbt::run_sma_backtest_metrics(end_long.candles, params, settings),
+                            stockbt::run_sma_backtest(end_long.candles, params, settings).metrics),
+               "metrics-only run should match full run when force-closing");
+
+    for (double stop : {0.0, 0.02}) {
+        for (double target : {0.0, 0.05}) {
+            settings.stop_loss_pct = stop;
+            settings.take_profit_pct = target;
+            for (std::size_t fast : {3, 9}) {
+                params.fast_window = fast;
+                params.slow_window = 21;
+                const auto full = stockbt::run_sma_backtest(series, params, settings);
+                const auto metrics = stockbt::run_sma_backtest_metrics(series, params, settings);
+                check_true(same_metrics(full.metrics, metrics), "metrics-only run should match full run");
+            }
+        }
+    }
+
+    params.fast_window = 5;
+    params.slow_window = 3;
+    check_true(same_metrics(stockbt::run_sma_backtest_metrics(series, params, settings), stockbt::Metrics{}),
+               "metrics-only run with invalid params should return empty metrics");
+}
+
+void test_candle_view_slices_match_copies() {
+    const stockbt::Series series = make_synthetic_series(300);
+    const stockbt::CandleView all(series);
+    check_true(all.size() == series.size() && all.data() == series.data(), "view should alias the series");
+
+    const stockbt::CandleView tail = all.subview(200);
+    check_true(tail.size() == 100 && tail.data() == series.data() + 200, "subview should not copy");
+    check_true(all.subview(250, 500).size() == 50, "subview count should clamp to the view");
+    check_true(all.subview(400).empty(), "subview offset past the end should be empty");
+
+    const stockbt::Series copy(series.begin() + 200, series.end());
+    stockbt::SmaParams params;
+    params.fast_window = 4;
+    params.slow_window = 12;
+    const auto from_view = stockbt::run_sma_backtest(tail, params, stockbt::BacktestSettings{});
+    const auto from_copy = stockbt::run_sma_backtest(copy, params, stockbt::BacktestSettings{});
+    check_true(same_metrics(from_view.metrics, from_copy.metrics) && from_view.equity == from_copy.equity,
+               "backtest over a view should match backtest over a copied slice");
+}
+
+void test_import_stage_functions() {
+    std::vector<std::string_view> fields;
+    std::vector<std::string> storage;
+    stockbt::split_csv_fields(" 2024-01-01 , 1.5,\"2,5\"", &fields, &storage);
+    check_true(fields.size() == 3 && fields[0] == "2024-01-01" && fields[1] == "1.5" && fields[2] == "2,5",
+               "split_csv_fields should trim and unquote fields");
+    double value = 0.0;
+    check_true(stockbt::parse_csv_number(" +1.25 ", &value) && value == 1.25, "parse_csv_number should accept '+'");
+    check_true(!stockbt::parse_csv_number("1.2x", &value), "parse_csv_number should reject trailing text");
+
+    stockbt::Series rows = {{3, 1, 1, 1, 1, 1}, {1, 2, 2, 2, 2, 2}, {3, 3, 3, 3, 3, 3}, {2, 4, 4, 4, 4, 4}};
+    bool unsorted = false;
+    check_true(stockbt::sort_and_dedupe_candles(&rows, &unsorted) == 1 && unsorted, "one duplicate should be removed");
+    check_true(rows.size() == 3 && rows[0].ts == 1 && rows[1].ts == 2 && rows[2].ts == 3 && rows[2].c == 3,
+               "sort_and_dedupe_candles should keep the last row per timestamp");
+    check_true(stockbt::sort_and_dedupe_candles(&rows, &unsorted) == 0 && !unsorted, "sorted rows should stay as-is");
+}
+
+void test_sort_dedupe_paths_match_stable_sort() {
+    auto reference = [](stockbt::Series rows) {
+        std::stable_sort(rows.begin(), rows.end(), [](const stockbt::Candle& a, const stockbt::Candle& b) {
+            return a.ts < b.ts;
+        });
+        stockbt::Series deduped;
+        for (const stockbt::Candle& c : rows) {
+            if (!deduped.empty() && deduped.back().ts == c.ts) {
+                deduped.back() = c;
+            } else {
+                deduped.push_back(c);
+            }
+        }
+        return deduped;
+    };
+    auto row = [](int64_t ts, std::size_t i) {
+        return stockbt::Candle{ts, 1.0, 1.0, 1.0, static_cast<double>(i), 1.0};
+    };
+
+    std::vector<stockbt::Series> shapes(5);
+    uint32_t seed = 7;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        shapes[0].push_back(row(static_cast<int64_t>(i / 2), i));                           // sorted, duplicates
+        shapes[1].push_back(row(static_cast<int64_t>((3000 - i) / 3), i));                  // newest first
+        shapes[2].push_back(row(static_cast<int64_t>(seed % 50 == 0 ? seed % 3000 : i), i)); // stragglers
+        shapes[3].push_back(row(static_cast<int64_t>(seed % 700), i));                      // shuffled
+        shapes[4].push_back(row(static_cast<int64_t>(i == 0 ? 5000 : i % 1500), i));         // early outlier
+    }
+    for (std::size_t k = 0; k < shapes.size(); ++k) {
+        stockbt::Series rows = shapes[k];
+        bool unsorted = false;
+        const std::size_t removed = stockbt::sort_and_dedupe_candles(&rows, &unsorted);
+        const stockbt::Series expected = reference(shapes[k]);
+        check_true(same_candles(rows, expected) && removed == shapes[k].size() - expected.size(),
+                   "sort_and_dedupe_candles should match stable_sort + dedupe for shape " + std::to_string(k));
+        check_true(unsorted == (k != 0), "unsorted flag should report out-of-order input");
+    }
+}
+
+void test_column_import_sorts_columns() {
+    const int64_t start = stockbt::parse_timestamp_utc("2020-01-01", stockbt::DateFormat::Iso).value_or(0);
+    uint32_t seed = 11;
+    std::vector<std::string> shapes(4);
+    for (std::size_t i = 0; i < 2000; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const int64_t hours[4] = {static_cast<int64_t>(i / 2),                             // sorted, duplicates
+                                  static_cast<int64_t>((2000 - i) / 3),                    // newest first
+                                  static_cast<int64_t>(seed % 40 == 0 ? seed % 2000 : i), // stragglers
+                                  static_cast<int64_t>(seed % 500)};                       // shuffled
+        for (std::size_t k = 0; k < shapes.size(); ++k) {
+            shapes[k] += csv_date_time(start + hours[k] * 3600) + "," + std::to_string(10 + i % 7) + ",20,5," +
+                         std::to_string(10 + i) + ",100\n";
+        }
+    }
+
+    for (std::size_t k = 0; k < shapes.size(); ++k) {
+        const auto path = write_tmp_file("column_shape" + std::to_string(k) + ".csv",
+                                         "Date,Open,High,Low,Close,Volume\n" + shapes[k] + "bad,1,1,1,1,1\n");
+        std::filesystem::remove(stockbt::dataset_cache_path(path.string()));
+        stockbt::ImportOptions rows_options;
+        rows_options.binary_cache = true;
+        const auto as_rows = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, rows_options);
+        stockbt::ImportOptions options;
+        options.layout = stockbt::SeriesLayout::Columns;
+        const auto serial = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+        options.threads = 3;
+        options.chunk_bytes = 4096;
+        const auto parallel = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+        options.binary_cache = true;
+        const auto cached = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+        bool same = as_rows.success && !as_rows.stats.from_cache;
+        for (const stockbt::ImportResult* columns : {&serial, &parallel, &cached}) {
+            same = same && columns->success && columns->candles.empty() &&
+                   same_candles(stockbt::to_series(columns->columns), as_rows.candles) &&
+                   same_issues(columns->warnings, as_rows.warnings) && columns->dropped_rows == 1;
+        }
+        check_true(same, "column import should sort and dedupe like the row import for shape " + std::to_string(k));
+    }
+}
+
+void test_mapped_import_matches_stream_import() {
+    const std::string tricky =
+        "Date,Open,High,Low,Close,Volume\r\n"
+        "2024-01-03, 9 ,10,8,9,100\r\n"
+        "\r\n"
+        "\"2024-01-01\",\"10\",11,9,+10,1e2\n"
+        "2024-01-02,10,11,9,0,100\n"
+        "2024-01-04,0x1p3,11,7,8.5, 5 \n"
+        "2024-01-05,8,9,7,abc,100\n"
+        "2024-01-06,8,9,7,7.25,-1\n"
+        "bad-date,8,9,7,7,1\n"
+        "2024-01-07,8,9\n"
+        "2024-01-02,10,11,9,11,100\n"
+        "2024-01-08,+-8,9,7,7,1\n"
+        "2024-01-09,1e-320,9,7,7,1\n"
+        "2024-01-10,.5,9e0,7.,7,0";
+    const auto path = write_tmp_file("tricky.csv", tricky);
+
+    stockbt::ImportOptions mapped;
+    mapped.memory_map = true;
+    stockbt::ImportOptions stream;
+    stream.memory_map = false;
+    const auto a = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, mapped);
+    const auto b = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, stream);
+    check_true(a.success && a.partial_success, "tricky CSV should import with dropped rows");
+    check_true(same_import(a, b), "memory-mapped import should match stream import");
+    check_true(a.candles.size() == 5, "tricky CSV should keep five rows");
+    if (a.candles.size() == 5) {
+        check_true(a.candles[0].c == 10.0 && a.candles[0].v == 100.0, "quoted, signed and exponent fields should parse");
+        check_true(a.candles[3].o == 8.0 && a.candles[3].v == 5.0, "hex float and padded fields should parse");
+        check_true(a.candles[4].o == 0.5 && a.candles[4].l == 7.0, "leading/trailing decimal point should parse");
+    }
+
+    for (const char* sample : {"data/sample.csv", "data/sample_mixed_invalid.csv", "data/sample_usdcad_format.csv"}) {
+        const auto x = stockbt::import_ohlcv_csv(src_path(sample).string(), stockbt::DateFormat::Iso, mapped);
+        const auto y = stockbt::import_ohlcv_csv(src_path(sample).string(), stockbt::DateFormat::Iso, stream);
+        check_true(same_import(x, y), std::string("mapped import should match stream import for ") + sample);
+    }
+
+    const auto empty = stockbt::import_ohlcv_csv(write_tmp_file("empty.csv", "").string(), stockbt::DateFormat::Iso);
+    check_true(!empty.success && !empty.errors.empty() && empty.errors[0].message == "CSV is empty",
+               "empty file should report CSV is empty");
+    const auto missing = stockbt::import_ohlcv_csv(src_path("data/does_not_exist.csv").string(), stockbt::DateFormat::Iso);
+    check_true(!missing.success && !missing.errors.empty() &&
+                   missing.errors[0].message.find("Unable to open CSV file") != std::string::npos,
+               "missing file should report open failure");
+}
+
+void test_parallel_import_matches_serial() {
+    std::ostringstream csv;
+    csv << "Date,Open,High,Low,Close,Volume\n";
+    for (int i = 0; i < 400; ++i) {
+        const int day = 1 + (i * 7) % 28;
+        const int month = 1 + (i / 28) % 12;
+        csv << "2023-" << (month < 10 ? "0" : "") << month << '-' << (day < 10 ? "0" : "") << day << ' '
+            << (i % 24 < 10 ? "0" : "") << i % 24 << ":00:00,";
+        if (i % 37 == 0) {
+            csv << "x,1,1,1,1\n";
+        } else if (i % 41 == 0) {
+            csv << "\n";
+        } else if (i % 53 == 0) {
+            csv << "1,1,1\n";
+        } else {
+            csv << 10 + i % 5 << ",12,9," << 10 + i % 3 << ",100\r\n";
+        }
+    }
+    csv << "2024-06-01,1,1,1,1,1";
+    const auto path = write_tmp_file("parallel_import.csv", csv.str());
+
+    const auto serial = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso);
+    check_true(serial.success && serial.partial_success, "parallel import fixture should import with drops");
+    for (std::size_t chunk_bytes : {std::size_t{1}, std::size_t{64}, std::size_t{1000}, std::size_t{1} << 20}) {
+        stockbt::ImportOptions options;
+        options.threads = 3;
+        options.chunk_bytes = chunk_bytes;
+        const auto parallel = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+        check_true(same_import(serial, parallel), "parallel chunked import should match serial import");
+    }
+}
+
 } // namespace
 
+void test_binary_dataset_cache_round_trip() {
+    const auto csv_path = write_tmp_file("cached.csv",
+                                         "Date,Open,High,Low,Close,Volume\n"
+                                         "2024-01-02,10,11,9,10.5,100\n"
+                                         "2024-01-01,9,10,8,9.25,50\n"
+                                         "bad-date,1,1,1,1,1\n"
+                                         "2024-01-03,10.5,12,10,11.75,0\n");
+    const std::string cache_path = stockbt::dataset_cache_path(csv_path.string());
+    check_true(std::filesystem::path(cache_path).filename() == "cached.sbt", "cache should sit next to the CSV");
+    std::filesystem::remove(cache_path);
+
+    const auto parsed = stockbt::import_ohlcv_csv(csv_path.string(), stockbt::DateFormat::Iso);
+    stockbt::ImportOptions options;
+    options.binary_cache = true;
+    const auto first = stockbt::import_ohlcv_csv(csv_path.string(), stockbt::DateFormat::Iso, options);
+    check_true(parsed.success && parsed.partial_success, "cache fixture should import with warnings");
+    check_true(same_import(first, parsed), "first cached import should parse the CSV");
+    check_true(std::filesystem::exists(cache_path), "cached import should write the .sbt file");
+
+    stockbt::DatasetCache cache;
+    std::string error;
+    check_true(cache.open(cache_path, &error), "written cache should open: " + error);
+    stockbt::SourceStamp stamp;
+    check_true(stockbt::read_source_stamp(csv_path.string(), &stamp), "source stamp should be readable");
+    check_true(cache.matches(stamp, stockbt::DateFormat::Iso), "cache should match its CSV");
+    check_true(!cache.matches(stamp, stockbt::DateFormat::Mdy), "cache should not match another date format");
+    check_true(cache.rows() == 3 && cache.metadata().rows == 3, "cache should hold three rows");
+    check_true(cache.ts()[0] == parsed.candles[0].ts && cache.c()[2] == 11.75 && cache.v()[1] == 100.0,
+               "cache columns should hold the parsed values");
+    check_true(cache.metadata().start_ts == parsed.candles.front().ts &&
+                   cache.metadata().end_ts == parsed.candles.back().ts,
+               "cache metadata should record the time range");
+    check_true(same_import(cache.to_import_result(), parsed), "cache should reproduce the import result");
+    check_true(same_candles(stockbt::to_series(cache.to_import_result(stockbt::SeriesLayout::Columns).columns),
+                            parsed.candles),
+               "cache should reproduce the import result as columns");
+    check_true(same_import(stockbt::import_ohlcv_csv(cache_path, stockbt::DateFormat::Iso), parsed),
+               ".sbt paths should load directly");
+
+    // A stale cache is ignored and rebuilt.
+    const auto changed = write_tmp_file("cached.csv",
+                                        "Date,Open,High,Low,Close,Volume\n"
+                                        "2024-02-01,1,2,0.5,1.5,10\n");
+    const auto second = stockbt::import_ohlcv_csv(changed.string(), stockbt::DateFormat::Iso, options);
+    check_true(second.success && second.candles.size() == 1 && second.candles[0].c == 1.5,
+               "changed CSV should bypass the stale cache");
+    check_true(cache.open(cache_path, &error) && cache.rows() == 1, "stale cache should be rewritten");
+
+    const auto garbage = write_tmp_file("garbage.sbt", "STOCKBT but not really a dataset file");
+    check_true(!cache.open(garbage.string(), &error), "malformed cache should be rejected");
+    const auto bad = stockbt::import_ohlcv_csv(garbage.string(), stockbt::DateFormat::Iso);
+    check_true(!bad.success && !bad.errors.empty(), "malformed .sbt import should report an error");
+}
+
+void test_column_storage_matches_rows() {
+    const stockbt::Series series = make_synthetic_series(600);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+    check_true(columns.size() == series.size() && same_candles(stockbt::to_series(columns), series),
+               "rows should round-trip through columns");
+
+    const stockbt::ColumnsView tail = stockbt::ColumnsView(columns).subview(100);
+    check_true(tail.size() == 500 && tail.c() == columns.c.data() + 100 && tail[0].ts == series[100].ts,
+               "column subview should alias the columns");
+
+    stockbt::SmaParams params;
+    params.fast_window = 6;
+    params.slow_window = 21;
+    stockbt::BacktestSettings settings;
+    settings.stop_loss_pct = 0.02;
+    settings.take_profit_pct = 0.03;
+    const auto rows = stockbt::run_sma_backtest(series, params, settings);
+    const auto cols = stockbt::run_sma_backtest(columns, params, settings);
+    check_true(same_metrics(rows.metrics, cols.metrics) && rows.equity == cols.equity &&
+                   rows.drawdown == cols.drawdown && rows.trades.size() == cols.trades.size() &&
+                   rows.warnings == cols.warnings,
+               "column backtest should match row backtest");
+
+    const stockbt::SmaCache cache(stockbt::ColumnsView(columns), {6, 21});
+    stockbt::BacktestContext context;
+    context.sma_cache = &cache;
+    check_true(same_metrics(stockbt::run_sma_backtest_metrics(columns, params, settings, context), rows.metrics),
+               "column metrics with SMA cache should match row backtest");
+
+    std::vector<stockbt::SeriesPoint> points;
+    for (const stockbt::Candle& candle : series) {
+        points.push_back({candle.ts, candle.c});
+    }
+    const auto from_points = stockbt::downsample_bucket_min_max(points, 40, 100);
+    const auto from_columns =
+        stockbt::downsample_bucket_min_max(columns.ts.data(), columns.c.data(), columns.size(), 40, 100);
+    bool same_buckets = from_points.size() == from_columns.size() && from_points.size() == 40;
+    for (std::size_t i = 0; same_buckets && i < from_points.size(); ++i) {
+        same_buckets = from_points[i].min_ts == from_columns[i].min_ts &&
+                       from_points[i].max_ts == from_columns[i].max_ts &&
+                       from_points[i].min_value == from_columns[i].min_value &&
+                       from_points[i].max_value == from_columns[i].max_value;
+    }
+    check_true(same_buckets, "column downsampling should match point downsampling");
+
+    const auto csv = src_path("data/sample_mixed_invalid.csv").string();
+    stockbt::ImportOptions options;
+    options.layout = stockbt::SeriesLayout::Columns;
+    const auto as_rows = stockbt::import_ohlcv_csv(csv, stockbt::DateFormat::Iso);
+    const auto as_columns = stockbt::import_ohlcv_csv(csv, stockbt::DateFormat::Iso, options);
+    check_true(as_columns.success && as_columns.candles.empty() &&
+                   same_candles(stockbt::to_series(as_columns.columns), as_rows.candles) &&
+                   same_issues(as_columns.warnings, as_rows.warnings),
+               "column import should hold the same candles and warnings");
+}
+
+void test_indicator_kernels_match_scalar() {
+    const stockbt::SeriesColumns columns = stockbt::to_columns(make_synthetic_series(1000));
+    const double* x = columns.c.data();
+    const std::size_t n = columns.size();
+    const std::vector<std::size_t> windows = {1, 2, 5, 13, 20, 0, 64, 999, 1000, 1200};
+    const stockbt::SimdLevel best = stockbt::detected_simd_level();
+    check_true(stockbt::indicator_kernel_level(1, best) == stockbt::SimdLevel::Scalar &&
+                   stockbt::indicator_kernel_level(windows.size(), best) == best &&
+                   stockbt::indicator_kernel_level(windows.size(), stockbt::SimdLevel::Scalar) ==
+                       stockbt::SimdLevel::Scalar,
+               "single-window indicator calls should report the scalar kernel");
+
+    std::vector<std::vector<double>> fast(windows.size(), std::vector<double>(n));
+    std::vector<std::vector<double>> scalar(windows.size(), std::vector<double>(n));
+    std::vector<double*> fast_out;
+    std::vector<double*> scalar_out;
+    for (std::size_t k = 0; k < windows.size(); ++k) {
+        fast_out.push_back(fast[k].data());
+        scalar_out.push_back(scalar[k].data());
+    }
+
+    using Batch = void (*)(const double*, std::size_t, const std::size_t*, std::size_t, double* const*,
+                           stockbt::SimdLevel);
+    const Batch batches[] = {stockbt::rolling_sma_batch, stockbt::ema_batch, stockbt::rolling_stddev_batch};
+    const char* names[] = {"sma", "ema", "stddev"};
+    for (std::size_t b = 0; b < 3; ++b) {
+        batches[b](x, n, windows.data(), windows.size(), fast_out.data(), best);
+        batches[b](x, n, windows.data(), windows.size(), scalar_out.data(), stockbt::SimdLevel::Scalar);
+        check_true(fast == scalar, std::string(names[b]) + " vector kernel should match the scalar reference exactly");
+    }
+
+    for (std::size_t k = 0; k < windows.size(); ++k) {
+        const std::size_t w = windows[k];
+        std::vector<double> sma(n);
+        std::vector<double> lo(n);
+        std::vector<double> hi(n);
+        std::vector<double> sd(n);
+        stockbt::rolling_sma(x, n, w, sma.data());
+        stockbt::rolling_min(x, n, w, lo.data());
+        stockbt::rolling_max(x, n, w, hi.data());
+        stockbt::rolling_stddev(x, n, w, sd.data());
+        bool sma_ok = true;
+        bool extremes_ok = true;
+        bool stddev_ok = true;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (w == 0 || i + 1 < w) {
+                sma_ok = sma_ok && sma[i] == 0.0 && sd[i] == 0.0;
+                extremes_ok = extremes_ok && lo[i] == 0.0 && hi[i] == 0.0;
+                continue;
+            }
+            double sum = 0.0;
+            double mn = x[i];
+            double mx = x[i];
+            for (std::size_t j = i + 1 - w; j <= i; ++j) {
+                sum += x[j];
+                mn = std::min(mn, x[j]);
+                mx = std::max(mx, x[j]);
+            }
+            const double mean = sum / static_cast<double>(w);
+            double sq = 0.0;
+            for (std::size_t j = i + 1 - w; j <= i; ++j) {
+                sq += (x[j] - mean) * (x[j] - mean);
+            }
+            sma_ok = sma_ok && std::fabs(sma[i] - mean) <= 1e-9 * std::fabs(mean);
+            extremes_ok = extremes_ok && lo[i] == mn && hi[i] == mx;
+            stddev_ok = stddev_ok && std::fabs(sd[i] - std::sqrt(sq / static_cast<double>(w))) <= 1e-6;
+        }
+        const std::string label = " (window " + std::to_string(w) + ")";
+        check_true(sma_ok, "rolling SMA should match the window mean" + label);
+        check_true(extremes_ok, "rolling min/max should match a brute-force scan" + label);
+        check_true(stddev_ok, "rolling stddev should match a two-pass computation" + label);
+    }
+
+    std::vector<double> e(n);
+    stockbt::ema(x, n, 10, e.data());
+    double expect = x[0];
+    bool ema_ok = e[0] == x[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        expect = expect + (2.0 / 11.0) * (x[i] - expect);
+        ema_ok = ema_ok && std::fabs(e[i] - expect) <= 1e-12 * std::fabs(expect);
+    }
+    check_true(ema_ok, "EMA should follow the alpha = 2 / (period + 1) recurrence");
+}
+
+// Enters on bar 0 and exits on bar 2, to exercise the execution core directly.
+struct ScriptedStrategy {
+    const char* invalid_reason() const { return nullptr; }
+    std::size_t warmup_bars() const { return 0; }
+    const char* short_data_warning() const { return ""; }
+    stockbt::Signal on_bar(std::size_t i) {
+        if (i == 0) {
+            return stockbt::Signal::Enter;
+        }
+        return (i == 2) ? stockbt::Signal::Exit : stockbt::Signal::None;
+    }
+};
+
+void test_strategy_engine() {
+    stockbt::Series bars;
+    const double closes[] = {10, 10, 10, 12, 13, 14, 11, 11};
+    for (std::size_t i = 0; i < 8; ++i) {
+        stockbt::Candle candle;
+        candle.ts = static_cast<int64_t>(i) * 86400;
+        candle.o = candle.c = closes[i];
+        candle.h = closes[i] + 0.5;
+        candle.l = closes[i] - 0.5;
+        bars.push_back(candle);
+    }
+
+    stockbt::BacktestSettings settings;
+    settings.commission_pct = 0.0;
+    ScriptedStrategy scripted;
+    stockbt::BacktestResult scripted_result;
+    stockbt::FullRecorder recorder(&scripted_result);
+    stockbt::run_strategy(stockbt::RowBars(bars), scripted, settings, recorder);
+    check_true(scripted_result.trades.size() == 1, "scripted strategy should trade once");
+    if (scripted_result.trades.size() == 1) {
+        const auto& trade = scripted_result.trades[0];
+        check_true(trade.entry_time == bars[1].ts && trade.exit_time == bars[3].ts,
+                   "engine should fill signals at the next bar open");
+        check_near(trade.pnl, (12.0 - 10.0) * trade.qty, 1e-9, "scripted trade pnl should use next-open fills");
+    }
+
+    stockbt::BreakoutParams params;
+    params.entry_window = 3;
+    params.exit_window = 2;
+    const auto breakout = stockbt::run_breakout_backtest(bars, params, settings);
+    check_true(breakout.trades.size() == 1, "breakout should trade once");
+    if (breakout.trades.size() == 1) {
+        const auto& trade = breakout.trades[0];
+        check_true(trade.entry_time == bars[4].ts && trade.entry_price == 13.0,
+                   "breakout should enter the bar after the close clears the prior high");
+        check_true(trade.exit_time == bars[7].ts && trade.exit_price == 11.0,
+                   "breakout should exit the bar after the close breaks the prior low");
+    }
+    const auto breakout_columns = stockbt::run_breakout_backtest(stockbt::to_columns(bars), params, settings);
+    check_true(breakout_columns.equity == breakout.equity && breakout_columns.trades.size() == breakout.trades.size(),
+               "column breakout should match row breakout");
+
+    params.exit_window = 0;
+    const auto invalid = stockbt::run_breakout_backtest(bars, params, settings);
+    check_true(invalid.trades.empty() && contains_warning(invalid.warnings, "invalid breakout parameters"),
+               "invalid breakout parameters should be reported");
+}
+
+void test_multi_symbol_backtest() {
+    const std::filesystem::path dir = src_path("tests/tmp/multi_symbol");
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const char* symbols[] = {"AAA", "BBB", "CCC"};
+    for (std::size_t k = 0; k < 3; ++k) {
+        std::ofstream csv(dir / (std::string(symbols[k]) + ".csv"));
+        csv << "Date,Open,High,Low,Close,Volume\n";
+        for (const stockbt::Candle& c : make_synthetic_series(200 + 50 * k)) {
+            csv << csv_date_time(c.ts) << ',' << c.o + k << ',' << c.h + k << ',' << c.l + k
+                << ',' << c.c + k << ',' << c.v << '\n';
+        }
+    }
+    std::ofstream(dir / "BAD.csv") << "not,a,price,file\n";
+    std::ofstream(dir / "notes.txt") << "ignored\n";
+
+    std::vector<stockbt::SymbolSource> sources;
+    std::string error;
+    check_true(stockbt::list_symbol_sources(dir.string(), &sources, &error), "symbol directory should be listed");
+    check_true(sources.size() == 4 && sources.front().symbol == "AAA" && sources[1].symbol == "BAD",
+               "directory sources should be the CSVs sorted by name");
+
+    stockbt::SmaParams params;
+    params.fast_window = 5;
+    params.slow_window = 20;
+    stockbt::BacktestSettings settings;
+    stockbt::MultiSymbolOptions options;
+    options.threads = 3;
+    stockbt::MultiSymbolSummary summary;
+    const auto results = stockbt::run_multi_symbol_backtest(sources, params, settings, options, &summary);
+    check_true(results.size() == 4 && summary.symbols == 4 && summary.failed == 1,
+               "multi-symbol run should report one result per source and count failures");
+    check_true(summary.peak_datasets >= 1 && summary.peak_datasets <= 3,
+               "multi-symbol run should hold at most one dataset per worker");
+    if (results.size() != 4) {
+        return;
+    }
+    check_true(!results[1].success && !results[1].error.empty(), "failed import should carry its error");
+
+    bool matches = true;
+    std::size_t rows = 0;
+    for (const stockbt::SymbolResult& result : results) {
+        if (!result.success) {
+            continue;
+        }
+        const auto imported = stockbt::import_ohlcv_csv(result.path, stockbt::DateFormat::Iso);
+        const auto expected = stockbt::run_sma_backtest(imported.candles, params, settings).metrics;
+        matches = matches && result.rows == imported.candles.size() && same_metrics(result.metrics, expected);
+        rows += result.rows;
+    }
+    check_true(matches, "per-symbol metrics should match a direct import and backtest");
+    check_true(summary.total_rows == rows && rows == 750, "summary should count imported rows");
+
+    std::ofstream(dir / "manifest.txt") << "# symbols\n\nCCC.csv\nfirst, AAA.csv\n";
+    check_true(stockbt::list_symbol_sources((dir / "manifest.txt").string(), &sources, &error) && sources.size() == 2,
+               "manifest should list its entries");
+    check_true(sources.size() == 2 && sources[0].symbol == "CCC" && sources[1].symbol == "first" &&
+                   std::filesystem::path(sources[1].path) == dir / "AAA.csv",
+               "manifest entries should take explicit symbols and resolve relative paths");
+    check_true(!stockbt::list_symbol_sources((dir / "missing.txt").string(), &sources, &error) && !error.empty(),
+               "missing manifest should be reported");
+}
+
+void test_incremental_backtest() {
+    const stockbt::Series series = make_synthetic_series(600);
+    stockbt::SmaParams params;
+    params.fast_window = 5;
+    params.slow_window = 20;
+    stockbt::BacktestSettings settings;
+    settings.position_size_pct = 0.8;
+    settings.stop_loss_pct = 0.02;
+    settings.take_profit_pct = 0.03;
+
+    stockbt::IncrementalSmaBacktest by_bar(params, settings);
+    stockbt::IncrementalSmaBacktest by_chunk(params, settings);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+    const stockbt::ColumnsView view(columns);
+    std::string error;
+    bool matches = true;
+    for (std::size_t i = 0; i < series.size(); ++i) {
+        matches = matches && by_bar.append(series[i], &error);
+        const auto expected = stockbt::run_sma_backtest_metrics(stockbt::CandleView(series.data(), i + 1), params, settings);
+        matches = matches && same_metrics(by_bar.metrics(), expected);
+        if (i % 97 == 96) {
+            matches = matches && by_chunk.extend(view.subview(0, i + 1), &error);
+            matches = matches && same_metrics(by_chunk.metrics(), expected);
+        }
+    }
+    check_true(matches, "incremental metrics should match a full rerun after every appended bar");
+    check_true(by_bar.metrics().trades > 0, "incremental test series should trade");
+
+    const std::filesystem::path state_path = src_path("tests/tmp/incremental_state.sbs");
+    stockbt::IncrementalSmaBacktest resumed(params, settings);
+    check_true(resumed.append(stockbt::CandleView(series.data(), 300), &error), "first half should append");
+    check_true(resumed.save(state_path.string(), &error), "incremental state should save");
+    stockbt::IncrementalSmaBacktest loaded;
+    check_true(loaded.load(state_path.string(), &error), "incremental state should load");
+    check_true(loaded.bars() == 300 && loaded.last_ts() == series[299].ts && same_metrics(loaded.metrics(), resumed.metrics()),
+               "loaded state should report the saved metrics");
+    check_true(loaded.append(view.subview(300, series.size() - 300), &error) && same_metrics(loaded.metrics(), by_bar.metrics()),
+               "loaded state should continue exactly like an uninterrupted run");
+
+    const std::size_t before = loaded.bars();
+    check_true(!loaded.append(series[10], &error) && !error.empty() && loaded.bars() == before,
+               "out-of-order bar should be rejected without being consumed");
+    check_true(!by_chunk.extend(view.subview(0, 10), &error), "extend should reject a series that does not continue");
+
+    const auto garbage = write_tmp_file("garbage_state.sbs", "not a state file");
+    check_true(!loaded.load(garbage.string(), &error) && !error.empty() && loaded.bars() == before,
+               "corrupt state file should be rejected and leave the backtest untouched");
+}
+
+void test_binary_result_exports() {
+    const stockbt::Series series = make_synthetic_series(3000);
+    stockbt::SmaParams params;
+    params.fast_window = 5;
+    params.slow_window = 20;
+    const auto result = stockbt::run_sma_backtest(series, params, stockbt::BacktestSettings{});
+    check_true(result.trades.size() > 2, "binary export test series should trade");
+
+    std::vector<stockbt::SweepRow> rows(3);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        rows[i].fast = 5 + i;
+        rows[i].slow = 20 + i;
+        rows[i].stop_loss_pct = 0.01 * static_cast<double>(i);
+        rows[i].take_profit_pct = 0.1;
+        rows[i].train = result.metrics;
+        rows[i].test.total_return_pct = -1.5 * static_cast<double>(i);
+        rows[i].test.trades = static_cast<int>(i);
+    }
+
+    std::string error;
+    std::uintmax_t sizes[2] = {0, 0};
+    for (int compress = 0; compress < 2; ++compress) {
+        stockbt::BinaryExportOptions options;
+        options.compress = compress != 0;
+        const std::string suffix = compress ? "_varint" : "_raw";
+        const std::filesystem::path equity_path = src_path("tests/tmp/equity" + suffix + ".sbr");
+        const std::filesystem::path trades_path = src_path("tests/tmp/trades" + suffix + ".sbr");
+        const std::filesystem::path sweep_path = src_path("tests/tmp/sweep" + suffix + ".sbr");
+
+        stockbt::EquityTable equity;
+        check_true(stockbt::export_equity_binary(equity_path.string(), series, result, options, &error) &&
+                       stockbt::load_equity_binary(equity_path.string(), &equity, &error),
+                   "binary equity export should round-trip");
+        bool equity_ok = equity.ts.size() == series.size() && equity.equity == result.equity &&
+                         equity.drawdown == result.drawdown;
+        for (std::size_t i = 0; equity_ok && i < series.size(); ++i) {
+            equity_ok = equity.ts[i] == series[i].ts;
+        }
+        check_true(equity_ok, "binary equity columns should match the backtest curves");
+        sizes[compress] = std::filesystem::file_size(equity_path);
+
+        std::vector<stockbt::Trade> trades;
+        check_true(stockbt::export_trades_binary(trades_path.string(), result, options, &error) &&
+                       stockbt::load_trades_binary(trades_path.string(), &trades, &error),
+                   "binary trades export should round-trip");
+        check_true(trades.size() == result.trades.size() &&
+                       std::equal(trades.begin(), trades.end(), result.trades.begin(),
+                                  [](const stockbt::Trade& a, const stockbt::Trade& b) {
+                                      return a.entry_time == b.entry_time && a.entry_price == b.entry_price &&
+                                             a.exit_time == b.exit_time && a.exit_price == b.exit_price &&
+                                             a.qty == b.qty && a.pnl == b.pnl && a.return_pct == b.return_pct;
+                                  }),
+                   "binary trades should match the backtest trades");
+
+        std::vector<stockbt::SweepRow> loaded;
+        check_true(stockbt::export_sweep_binary(sweep_path.string(), rows, options, &error) &&
+                       stockbt::load_sweep_binary(sweep_path.string(), &loaded, &error),
+                   "binary sweep export should round-trip");
+        check_true(loaded.size() == rows.size() &&
+                       std::equal(loaded.begin(), loaded.end(), rows.begin(),
+                                  [](const stockbt::SweepRow& a, const stockbt::SweepRow& b) {
+                                      return a.cell == b.cell && a.fast == b.fast && a.slow == b.slow &&
+                                             a.stop_loss_pct == b.stop_loss_pct &&
+                                             a.take_profit_pct == b.take_profit_pct && same_metrics(a.train, b.train) &&
+                                             same_metrics(a.test, b.test);
+                                  }),
+                   "binary sweep rows should match");
+
+        check_true(!stockbt::load_trades_binary(equity_path.string(), &trades, &error) && !error.empty(),
+                   "loading an export as the wrong table should fail");
+    }
+    check_true(sizes[1] < sizes[0], "varint equity export should be smaller than raw");
+
+    const std::string image = read_all(src_path("tests/tmp/equity_varint.sbr"));
+    const auto truncated = write_tmp_file("equity_truncated.sbr", image.substr(0, image.size() - 16));
+    stockbt::EquityTable equity;
+    check_true(!stockbt::load_equity_binary(truncated.string(), &equity, &error) && !error.empty(),
+               "truncated varint export should be rejected");
+}
+
+bool same_buckets(const std::vector<stockbt::BucketMinMax>& a, const std::vector<stockbt::BucketMinMax>& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](const stockbt::BucketMinMax& x, const stockbt::BucketMinMax& y) {
+               return x.min_ts == y.min_ts && x.min_value == y.min_value && x.max_ts == y.max_ts &&
+                      x.max_value == y.max_value;
+           });
+}
+
+void test_min_max_pyramid_matches_scan() {
+    std::vector<stockbt::SeriesPoint> points;
+    for (const stockbt::Candle& candle : make_synthetic_series(20000)) {
+        points.push_back({candle.ts, std::round(candle.c)}); // rounding creates ties
+    }
+    const stockbt::MinMaxPyramid pyramid(points);
+    check_true(pyramid.size() == points.size(), "pyramid should keep every point");
+
+    bool matches = true;
+    const std::size_t ranges[][2] = {{0, 20000}, {1, 19999}, {7, 9}, {512, 4096}, {13, 13 + 1200}, {19000, 20000},
+                                     {3, 3 + 64 * 8}};
+    for (const auto& range : ranges) {
+        const std::vector<stockbt::SeriesPoint> slice(points.begin() + range[0], points.begin() + range[1]);
+        for (std::size_t width : {1, 37, 400}) {
+            for (std::size_t cap : {10, 100, 50000}) {
+                matches = matches && same_buckets(pyramid.query(points[range[0]].ts, points[range[1] - 1].ts, width, cap),
+                                                  stockbt::downsample_bucket_min_max(slice, width, cap));
+            }
+        }
+    }
+    check_true(matches, "pyramid buckets should match a scan of the visible slice");
+    check_true(same_buckets(pyramid.query(points[100].ts - 1, points[5000].ts + 1, 50, 100),
+                            pyramid.query(points[100].ts, points[5000].ts, 50, 100)),
+               "pyramid query should include only timestamps inside [t0, t1]");
+    check_true(pyramid.query(points.back().ts + 1, points.back().ts + 10, 50).empty(),
+               "pyramid query past the series should be empty");
+    check_true(stockbt::MinMaxPyramid().query(0, 10, 50).empty(), "empty pyramid should return no buckets");
+
+    // Shorter value columns over one shared timestamp array, as the GUI charts use it.
+    const std::size_t prefix = 15000;
+    auto ts = std::make_shared<std::vector<int64_t>>();
+    std::vector<double> values;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        ts->push_back(points[i].ts);
+        if (i < prefix) {
+            values.push_back(points[i].value);
+        }
+    }
+    const stockbt::MinMaxPyramid shared(ts, values);
+    const std::vector<stockbt::SeriesPoint> head(points.begin(), points.begin() + prefix);
+    check_true(shared.size() == prefix && shared.timestamps() == ts, "pyramid should index the shared timestamps");
+    check_true(same_buckets(shared.query(points.front().ts, points.back().ts, 400, 100),
+                            stockbt::MinMaxPyramid(head).query(points.front().ts, points.back().ts, 400, 100)),
+               "pyramid over shared timestamps should ignore timestamps past its values");
+}
+
+void test_progress_and_cancellation() {
+    const stockbt::Series series = make_synthetic_series(3 * stockbt::ProgressToken::kInterval);
+    stockbt::SmaParams params;
+    params.fast_window = 10;
+    params.slow_window = 40;
+    const stockbt::BacktestSettings settings;
+
+    stockbt::ProgressToken token;
+    stockbt::BacktestContext context;
+    context.progress = &token;
+    const auto plain = stockbt::run_sma_backtest(series, params, settings);
+    const auto tracked = stockbt::run_sma_backtest(series, params, settings, context);
+    check_true(same_metrics(plain.metrics, tracked.metrics) && plain.equity == tracked.equity,
+               "a progress token should not change backtest results");
+    check_near(token.progress(), 1.0, 0.0, "finished backtest should report full progress");
+
+    stockbt::ProgressToken* cancelling = nullptr;
+    stockbt::ProgressToken cancel_midway([&cancelling](double) { cancelling->cancel(); });
+    cancelling = &cancel_midway;
+    context.progress = &cancel_midway;
+    const auto cancelled = stockbt::run_sma_backtest(series, params, settings, context);
+    check_true(!cancelled.warnings.empty() && cancelled.warnings.back() == "Backtest cancelled.",
+               "cancelled backtest should warn");
+    check_true(cancelled.equity != plain.equity, "cancelled backtest should stop early");
+    check_true(cancel_midway.progress() > 0.0 && cancel_midway.progress() < 1.0,
+               "cancelled backtest should keep partial progress");
+
+    const auto path = write_tmp_file("progress.csv",
+                                     "Date,Open,High,Low,Close,Volume\n2024-01-01,1,2,0.5,1.5,10\n"
+                                     "2024-01-02,1.5,2,1,1.8,20\n");
+    for (std::size_t threads : {std::size_t{1}, std::size_t{2}}) {
+        stockbt::ImportOptions options;
+        options.threads = threads;
+        options.chunk_bytes = 16;
+        stockbt::ProgressToken import_token;
+        options.progress = &import_token;
+        const auto imported = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+        check_true(imported.success && imported.candles.size() == 2, "import with a progress token should succeed");
+        check_near(import_token.progress(), 1.0, 0.0, "finished import should report full progress");
+
+        stockbt::ProgressToken cancelled_token;
+        cancelled_token.cancel();
+        options.progress = &cancelled_token;
+        const auto aborted = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+        check_true(!aborted.success && aborted.errors.size() == 1 && aborted.errors[0].message == "Import cancelled",
+                   "cancelled import should fail with a cancellation error");
+    }
+
+    const stockbt::CandleView train = stockbt::CandleView(series).subview(0, 600);
+    const stockbt::CandleView test = stockbt::CandleView(series).subview(600, 400);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 20;
+    grid.slow_min = 5;
+    grid.slow_max = 60;
+    grid.step = 6;
+    for (bool batch : {true, false}) {
+        stockbt::SweepOptions options;
+        options.threads = 2;
+        options.batch = batch;
+        const auto expected = stockbt::run_parameter_sweep(train, test, grid, settings, options);
+        stockbt::ProgressToken sweep_token;
+        options.progress = &sweep_token;
+        const auto rows = stockbt::run_parameter_sweep(train, test, grid, settings, options);
+        bool identical = rows.size() == expected.size();
+        for (std::size_t i = 0; identical && i < rows.size(); ++i) {
+            identical = same_metrics(rows[i].train, expected[i].train) && same_metrics(rows[i].test, expected[i].test);
+        }
+        check_true(identical, "a progress token should not change sweep results");
+        check_near(sweep_token.progress(), 1.0, 0.0, "finished sweep should report full progress");
+
+        stockbt::ProgressToken cancelled_token;
+        cancelled_token.cancel();
+        options.progress = &cancelled_token;
+        const auto skipped = stockbt::run_parameter_sweep(train, test, grid, settings, options);
+        check_true(skipped.size() == expected.size() && skipped[0].train.trades == 0 && skipped[0].fast == expected[0].fast,
+                   "cancelled sweep should keep its rows but skip their backtests");
+    }
+}
+
+void test_import_and_backtest_stats() {
+    const auto path = write_tmp_file("stats.csv",
+                                     "Date,Open,High,Low,Close,Volume\n"
+                                     "2024-01-03,1,2,0.5,1.5,10\n"
+                                     "2024-01-01,1,2,0.5,1.5,10\n"
+                                     "bad-date,1,2,0.5,1.5,10\n"
+                                     "2024-01-02,x,2,0.5,1.5,10\n"
+                                     "2024-01-04,1,2,0.5\n"
+                                     "\n"
+                                     "2024-01-05,-1,2,0.5,1.5,10\n"
+                                     "2024-01-01,1,2,0.5,1.6,10\n"
+                                     "2024-01-06,1,2,0.5,1.5,-10\n");
+    const auto imported = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso);
+    const stockbt::ImportStats& stats = imported.stats;
+    if (!stats.collected) {
+        // Built with STOCKBT_INSTRUMENTATION=OFF.
+        check_true(stockbt::format_import_stats(stats).empty(), "uncollected stats should not be formatted");
+        return;
+    }
+    check_true(stats.rows_parsed == 8 && !stats.from_cache, "stats should count non-blank data lines");
+    check_true(stats.dropped(stockbt::RowDropReason::MissingFields) == 1 &&
+                   stats.dropped(stockbt::RowDropReason::InvalidTimestamp) == 1 &&
+                   stats.dropped(stockbt::RowDropReason::InvalidNumber) == 1 &&
+                   stats.dropped(stockbt::RowDropReason::NonPositivePrice) == 1 &&
+                   stats.dropped(stockbt::RowDropReason::NegativeVolume) == 1,
+               "stats should count drops by reason");
+    check_true(stats.sorted && stats.duplicates_removed == 1, "stats should record sorting and duplicates");
+    check_true(stats.total_ms >= stats.parse_ms + stats.sort_ms, "stage times should fit in the total");
+    check_true(stockbt::format_import_stats(stats).find("invalid timestamp: 1") != std::string::npos,
+               "formatted stats should list drop reasons");
+
+    stockbt::ImportOptions options;
+    options.threads = 3;
+    options.chunk_bytes = 16;
+    const auto parallel = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    check_true(parallel.stats.rows_parsed == stats.rows_parsed &&
+                   parallel.stats.dropped_by_reason == stats.dropped_by_reason,
+               "parallel import should merge chunk stats");
+
+    const stockbt::Series series = make_synthetic_series(500);
+    const auto result = stockbt::run_sma_backtest(series, stockbt::SmaParams{}, stockbt::BacktestSettings{});
+    check_true(result.stats.collected && result.stats.bars == series.size() &&
+                   result.stats.trades == result.trades.size(),
+               "backtest stats should count bars and trades");
+    check_true(!stockbt::format_backtest_stats(result.stats).empty(), "backtest stats should be formatted");
+}
+
+void test_compact_row_issues() {
+    std::ostringstream csv;
+    csv << "Date,Open,High,Low,Close,Volume\n";
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 2 == 0) {
+            csv << "bad-date,1,1,1,1,1\n";
+        } else if (i % 10 == 1) {
+            csv << "2024-01-01,1,1,1\n";
+        } else {
+            csv << "2024-01-01 " << (i % 24 < 10 ? "0" : "") << i % 24 << ":00:00,1,2,0.5,1.5,10\n";
+        }
+    }
+    const auto path = write_tmp_file("dirty.csv", csv.str());
+
+    stockbt::ImportOptions options;
+    options.issue_samples = 10;
+    const auto imported = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    const stockbt::RowIssueSummary& issues = imported.row_issues;
+    check_true(imported.success && imported.partial_success, "dirty fixture should import with drops");
+    check_true(issues.count(stockbt::RowDropReason::InvalidTimestamp) == 500 &&
+                   issues.count(stockbt::RowDropReason::MissingFields) == 100 && issues.total() == 600 &&
+                   imported.dropped_rows == 600,
+               "row issue counts should be exact");
+    const auto& bad_dates = issues.sample_lines[static_cast<std::size_t>(stockbt::RowDropReason::InvalidTimestamp)];
+    check_true(bad_dates.size() == 10 && bad_dates.front() == 2 && bad_dates.back() == 20,
+               "row issues should keep the first sample lines");
+    const std::vector<stockbt::ImportIssue> described = stockbt::describe_row_issues(issues);
+    check_true(described.size() == 22, "row issues should describe the samples plus one line per reason");
+    check_true(described[0].line == 2 && described[1].line == 3 &&
+                   described[1].message == stockbt::row_drop_message(stockbt::RowDropReason::MissingFields),
+               "sampled issues should be in line order");
+    check_true(described.back().message == "Dropped row: invalid timestamp format (490 more rows)",
+               "row issues should summarize the rows not listed");
+    check_true(imported.warnings.size() >= described.size() &&
+                   same_issues(std::vector<stockbt::ImportIssue>(imported.warnings.end() - 22, imported.warnings.end()),
+                               described),
+               "warnings should be rebuilt from the row issue summary");
+
+    options.threads = 3;
+    options.chunk_bytes = 256;
+    const auto parallel = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    check_true(same_import(imported, parallel), "parallel import should merge row issue samples in line order");
+
+    options.threads = 1;
+    options.binary_cache = true;
+    std::filesystem::remove(stockbt::dataset_cache_path(path.string()));
+    stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    const auto cached = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    check_true(same_import(imported, cached), "dataset cache should keep the row issue summary");
+
+    options.issue_samples = 3;
+    const auto fewer = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    options.binary_cache = false;
+    const auto fresh = stockbt::import_ohlcv_csv(path.string(), stockbt::DateFormat::Iso, options);
+    check_true(same_import(fewer, fresh) &&
+                   fewer.row_issues.sample_lines[static_cast<std::size_t>(stockbt::RowDropReason::InvalidTimestamp)]
+                           .size() == 3,
+               "a cache hit should honour the caller's issue_samples");
+}
+
+void test_backtest_workspace_reuse() {
+    const stockbt::Series series = make_synthetic_series(600);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+    stockbt::BacktestSettings settings;
+    settings.stop_loss_pct = 0.02;
+    stockbt::BacktestWorkspace workspace;
+
+    const std::pair<std::size_t, std::size_t> windows[] = {{5, 20}, {10, 40}, {3, 700}, {20, 10}};
+    for (const auto& window : windows) {
+        const stockbt::SmaParams params{window.first, window.second};
+        const auto fresh = stockbt::run_sma_backtest(series, params, settings);
+        const auto& reused =
+            stockbt::run_sma_backtest(series, params, settings, stockbt::BacktestContext{}, &workspace);
+        check_true(&reused == &workspace.result, "workspace runs should write into the workspace result");
+        check_true(same_metrics(fresh.metrics, reused.metrics) && fresh.equity == reused.equity &&
+                       fresh.drawdown == reused.drawdown && fresh.trades.size() == reused.trades.size() &&
+                       fresh.warnings == reused.warnings,
+                   "recycled SMA workspace should match a fresh run");
+        const auto& column_run =
+            stockbt::run_sma_backtest(columns, params, settings, stockbt::BacktestContext{}, &workspace);
+        check_true(same_metrics(fresh.metrics, column_run.metrics) && fresh.equity == column_run.equity,
+                   "column workspace run should match a fresh run");
+    }
+
+    const double* equity_buffer = workspace.result.equity.data();
+    stockbt::run_sma_backtest(series, stockbt::SmaParams{5, 20}, settings, stockbt::BacktestContext{}, &workspace);
+    check_true(workspace.result.equity.data() == equity_buffer, "same-length runs should reuse the equity buffer");
+
+    const stockbt::BreakoutParams breakout{15, 8};
+    const auto fresh_breakout = stockbt::run_breakout_backtest(series, breakout, settings);
+    const auto& reused_breakout = stockbt::run_breakout_backtest(series, breakout, settings, &workspace);
+    check_true(same_metrics(fresh_breakout.metrics, reused_breakout.metrics) &&
+                   fresh_breakout.equity == reused_breakout.equity &&
+                   fresh_breakout.warnings == reused_breakout.warnings,
+               "recycled breakout workspace should match a fresh run");
+    check_true(same_metrics(fresh_breakout.metrics,
+                            stockbt::run_breakout_backtest(columns, breakout, settings, &workspace).metrics),
+               "column breakout workspace run should match a fresh run");
+}
+
+void test_sweep_pruning() {
+    const stockbt::Series series = make_synthetic_series(1200);
+    const stockbt::CandleView train = stockbt::CandleView(series).subview(0, 800);
+    const stockbt::CandleView test = stockbt::CandleView(series).subview(800);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 30;
+    grid.slow_min = 5;
+    grid.slow_max = 90;
+    grid.step = 4;
+    grid.stop_loss_pcts = {0.0, 0.02};
+    stockbt::BacktestSettings settings;
+    stockbt::SweepOptions plain;
+    plain.threads = 2;
+    const auto full = stockbt::run_parameter_sweep(train, test, grid, settings, plain);
+
+    double deepest = 0.0;
+    for (const auto& row : full) {
+        deepest = std::min(deepest, row.train.max_drawdown_pct);
+    }
+    check_true(deepest < 0.0, "pruning fixture should have drawdowns");
+
+    stockbt::SweepOptions by_drawdown = plain;
+    by_drawdown.pruning.max_drawdown_pct = -deepest / 2.0;
+    stockbt::SweepOptions by_drawdown_serial = by_drawdown;
+    by_drawdown_serial.batch = false;
+    by_drawdown_serial.threads = 1;
+    const auto dd_rows = stockbt::run_parameter_sweep(train, test, grid, settings, by_drawdown);
+    const auto dd_serial = stockbt::run_parameter_sweep(train, test, grid, settings, by_drawdown_serial);
+    std::size_t dd_pruned = 0;
+    bool consistent = dd_rows.size() == full.size() && dd_serial.size() == full.size();
+    for (std::size_t i = 0; consistent && i < full.size(); ++i) {
+        const auto& row = dd_rows[i];
+        consistent = row.pruned == dd_serial[i].pruned && same_metrics(row.train, dd_serial[i].train) &&
+                     same_metrics(row.test, dd_serial[i].test);
+        if (row.pruned == stockbt::SweepPruneReason::None) {
+            consistent = consistent && same_metrics(row.train, full[i].train) && same_metrics(row.test, full[i].test);
+        } else {
+            ++dd_pruned;
+            consistent = consistent && row.pruned == stockbt::SweepPruneReason::Drawdown &&
+                         row.pruned_at_bar < train.size() && row.test.trades == 0 &&
+                         full[i].train.max_drawdown_pct < -by_drawdown.pruning.max_drawdown_pct;
+        }
+    }
+    check_true(consistent, "drawdown pruning should only stop cells past the threshold and keep the others exact");
+    check_true(dd_pruned > 0 && dd_pruned < full.size(), "drawdown pruning should stop some cells");
+
+    stockbt::SweepOptions by_equity = plain;
+    by_equity.pruning.min_equity = settings.starting_cash * 1.5;
+    const auto equity_rows = stockbt::run_parameter_sweep(train, test, grid, settings, by_equity);
+    check_true(std::all_of(equity_rows.begin(), equity_rows.end(), [](const stockbt::SweepRow& row) {
+                   return row.pruned == stockbt::SweepPruneReason::Equity;
+               }),
+               "equity floor above the starting cash should prune every cell");
+
+    stockbt::SweepOptions halving = plain;
+    halving.pruning.keep_top = 5;
+    halving.pruning.rungs = 3;
+    auto halving_rows = stockbt::run_parameter_sweep(train, test, grid, settings, halving);
+    std::size_t kept = 0;
+    bool kept_exact = halving_rows.size() == full.size();
+    for (std::size_t i = 0; kept_exact && i < full.size(); ++i) {
+        if (halving_rows[i].pruned == stockbt::SweepPruneReason::None) {
+            ++kept;
+            kept_exact = same_metrics(halving_rows[i].train, full[i].train) &&
+                         same_metrics(halving_rows[i].test, full[i].test);
+        } else {
+            kept_exact = halving_rows[i].pruned == stockbt::SweepPruneReason::Halving;
+        }
+    }
+    check_true(kept_exact && kept >= 5 && kept <= (full.size() + 3) / 4,
+               "successive halving should keep the top cells exact and halve the rest per rung");
+    stockbt::sort_sweep_rows(&halving_rows);
+    check_true(halving_rows.front().pruned == stockbt::SweepPruneReason::None &&
+                   halving_rows.back().pruned == stockbt::SweepPruneReason::Halving,
+               "report order should list cells that were not pruned first");
+}
+
+void test_sweep_columns_input() {
+    const stockbt::Series series = make_synthetic_series(900);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 3;
+    grid.fast_max = 15;
+    grid.slow_min = 10;
+    grid.slow_max = 60;
+    grid.step = 6;
+    grid.stop_loss_pcts = {0.0, 0.02};
+    stockbt::BacktestSettings settings;
+    stockbt::SweepOptions batch;
+    batch.threads = 2;
+    stockbt::SweepOptions cells = batch;
+    cells.batch = false;
+    stockbt::SweepOptions by_drawdown = batch;
+    by_drawdown.pruning.max_drawdown_pct = 2.0;
+    stockbt::SweepOptions halving = cells;
+    halving.pruning.keep_top = 3;
+    stockbt::MetricsCache cache;
+    stockbt::SweepOptions cached = batch;
+    cached.cache = &cache;
+
+    bool identical = true;
+    for (const stockbt::SweepOptions& options : {batch, cells, by_drawdown, halving, cached}) {
+        const auto rows = stockbt::run_parameter_sweep(stockbt::CandleView(series).subview(0, 600),
+                                                       stockbt::CandleView(series).subview(600),
+                                                       grid,
+                                                       settings,
+                                                       options);
+        const auto column_rows = stockbt::run_parameter_sweep(stockbt::ColumnsView(columns).subview(0, 600),
+                                                              stockbt::ColumnsView(columns).subview(600),
+                                                              grid,
+                                                              settings,
+                                                              options);
+        identical = identical && !rows.empty() && rows.size() == column_rows.size();
+        for (std::size_t i = 0; identical && i < rows.size(); ++i) {
+            identical = rows[i].cell == column_rows[i].cell && rows[i].pruned == column_rows[i].pruned &&
+                        rows[i].pruned_at_bar == column_rows[i].pruned_at_bar &&
+                        same_metrics(rows[i].train, column_rows[i].train) &&
+                        same_metrics(rows[i].test, column_rows[i].test);
+        }
+    }
+    check_true(identical, "column sweep should match the row sweep on every path");
+    check_true(cache.hits() > 0, "column and row windows of the same bars should share cache entries");
+}
+
+void test_sweep_shards_merge_to_single_run() {
+    const stockbt::Series series = make_synthetic_series(700);
+    const stockbt::CandleView train = stockbt::CandleView(series).subview(0, 500);
+    const stockbt::CandleView test = stockbt::CandleView(series).subview(500);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 20;
+    grid.slow_min = 5;
+    grid.slow_max = 60;
+    grid.step = 3;
+    grid.stop_loss_pcts = {0.0, 0.02};
+    grid.take_profit_pcts = {0.0, 0.04};
+    const stockbt::BacktestSettings settings;
+    auto single = stockbt::run_parameter_sweep(train, test, grid, settings, stockbt::SweepOptions{});
+    const std::size_t total = single.size();
+    stockbt::sort_sweep_rows(&single);
+
+    std::vector<std::vector<stockbt::SweepRow>> shards;
+    for (std::size_t index = 0; index < 3; ++index) {
+        stockbt::SweepOptions options;
+        options.threads = 2;
+        options.shard = stockbt::SweepShard{index, 3};
+        auto rows = stockbt::run_parameter_sweep(train, test, grid, settings, options);
+        check_true(std::all_of(rows.begin(), rows.end(),
+                               [&](const stockbt::SweepRow& row) { return row.cell % 3 == index; }),
+                   "a shard should only run its own cells");
+        stockbt::sort_sweep_rows(&rows);
+
+        stockbt::SweepReportInfo info;
+        info.shard = options.shard;
+        info.total_cells = total;
+        info.risk_axes = true;
+        const auto path = src_path("tests/tmp/sweep_shard" + std::to_string(index) + ".sbr");
+        std::string error;
+        stockbt::SweepReportInfo loaded_info;
+        std::vector<stockbt::SweepRow> loaded;
+        check_true(stockbt::export_sweep_binary(path.string(), rows, info, stockbt::BinaryExportOptions{}, &error) &&
+                       stockbt::load_sweep_binary(path.string(), &loaded, &loaded_info, &error),
+                   "shard report should round-trip: " + error);
+        check_true(loaded.size() == rows.size() && loaded_info.shard.index == index && loaded_info.shard.count == 3 &&
+                       loaded_info.total_cells == total && loaded_info.risk_axes && !loaded_info.pruning,
+                   "shard report should keep its shard info");
+        shards.push_back(std::move(loaded));
+    }
+
+    std::vector<stockbt::SweepRow> merged;
+    std::string error;
+    check_true(stockbt::merge_sweep_shards(shards, total, &merged, &error), "shards should merge: " + error);
+    stockbt::sort_sweep_rows(&merged);
+    bool identical = merged.size() == single.size();
+    for (std::size_t i = 0; identical && i < single.size(); ++i) {
+        identical = merged[i].cell == single[i].cell && merged[i].fast == single[i].fast &&
+                    merged[i].stop_loss_pct == single[i].stop_loss_pct &&
+                    same_metrics(merged[i].train, single[i].train) && same_metrics(merged[i].test, single[i].test);
+    }
+    check_true(identical, "merged shards should reproduce the sorted single-node report");
+
+    shards.pop_back();
+    check_true(!stockbt::merge_sweep_shards(shards, total, &merged, &error) && !error.empty(),
+               "a missing shard should fail the merge");
+    shards.push_back(shards.front());
+    check_true(!stockbt::merge_sweep_shards(shards, total, &merged, &error), "a repeated shard should fail the merge");
+
+    stockbt::SweepOptions halving;
+    halving.shard = stockbt::SweepShard{0, 3};
+    halving.pruning.keep_top = 4;
+    check_true(!stockbt::check_sweep_options(halving, &error) &&
+                   stockbt::run_parameter_sweep(train, test, grid, settings, halving).empty(),
+               "successive halving should not run on a shard");
+    halving.shard = stockbt::SweepShard{};
+    auto halved = stockbt::run_parameter_sweep(train, test, grid, settings, halving);
+    std::vector<std::vector<stockbt::SweepRow>> halved_shards(2);
+    for (const stockbt::SweepRow& row : halved) {
+        halved_shards[row.cell % 2].push_back(row);
+    }
+    check_true(!stockbt::merge_sweep_shards(halved_shards, halved.size(), &merged, &error),
+               "shards with halving-pruned cells should fail the merge");
+}
+
+void test_sweep_result_cache() {
+    const stockbt::Series series = make_synthetic_series(700);
+    const stockbt::SeriesColumns columns = stockbt::to_columns(series);
+    check_true(stockbt::hash_series(stockbt::CandleView(series)) == stockbt::hash_series(stockbt::ColumnsView(columns)),
+               "row and column storage of the same bars should hash identically");
+    check_true(stockbt::hash_series(stockbt::CandleView(series).subview(1)) !=
+                   stockbt::hash_series(stockbt::CandleView(series)),
+               "different bars should hash differently");
+
+    const stockbt::CandleView train = stockbt::CandleView(series).subview(0, 500);
+    const stockbt::CandleView test = stockbt::CandleView(series).subview(500);
+    stockbt::SweepGrid grid;
+    grid.fast_min = 2;
+    grid.fast_max = 14;
+    grid.slow_min = 5;
+    grid.slow_max = 40;
+    grid.step = 3;
+    grid.stop_loss_pcts = {0.0, 0.02};
+    const stockbt::BacktestSettings settings;
+    stockbt::SweepGrid wider = grid;
+    wider.fast_max = 20;
+    wider.slow_max = 60;
+    const std::size_t first_cells = stockbt::enumerate_sweep_configs(grid, settings, 500, 200).size();
+    const std::size_t wider_cells = stockbt::enumerate_sweep_configs(wider, settings, 500, 200).size();
+
+    for (bool batch : {true, false}) {
+        stockbt::MetricsCache cache;
+        stockbt::SweepOptions options;
+        options.batch = batch;
+        options.cache = &cache;
+        stockbt::run_parameter_sweep(train, test, grid, settings, options);
+        check_true(cache.hits() == 0 && cache.size() == 2 * first_cells,
+                   "a cold sweep should cache train and test metrics of every cell");
+
+        const auto cached = stockbt::run_parameter_sweep(train, test, wider, settings, options);
+        options.cache = nullptr;
+        const auto fresh = stockbt::run_parameter_sweep(train, test, wider, settings, options);
+        bool identical = cached.size() == fresh.size();
+        for (std::size_t i = 0; identical && i < fresh.size(); ++i) {
+            identical = cached[i].cell == fresh[i].cell && same_metrics(cached[i].train, fresh[i].train) &&
+                        same_metrics(cached[i].test, fresh[i].test);
+        }
+        check_true(identical, "a sweep served partly from the cache should match an uncached sweep");
+        check_true(cache.hits() == 2 * first_cells && cache.size() == 2 * wider_cells,
+                   "an overlapping sweep should only run its new cells");
+    }
+
+    stockbt::MetricsCache cache;
+    stockbt::SweepOptions options;
+    options.cache = &cache;
+    const auto rows = stockbt::run_parameter_sweep(train, test, grid, settings, options);
+    const auto path = src_path("tests/tmp/result_cache.smc");
+    std::string error;
+    stockbt::MetricsCache loaded;
+    check_true(cache.save(path.string(), &error) && loaded.load(path.string(), &error) && loaded.size() == cache.size(),
+               "result cache should round-trip: " + error);
+    stockbt::BacktestSettings cell_settings = settings;
+    cell_settings.stop_loss_pct = rows.back().stop_loss_pct;
+    stockbt::SmaParams params;
+    params.fast_window = rows.back().fast;
+    params.slow_window = rows.back().slow;
+    const stockbt::Metrics* hit = loaded.find(stockbt::hash_series(test), params, cell_settings);
+    check_true(hit != nullptr && same_metrics(*hit, rows.back().test), "loaded entries should keep their metrics");
+    cell_settings.commission_pct *= 2.0;
+    check_true(loaded.find(stockbt::hash_series(test), params, cell_settings) == nullptr,
+               "different settings should miss");
+
+    // Bump the engine version, the metadata field after the cache layout version.
+    std::string image = read_all(path);
+    uint64_t meta_offset = 0;
+    std::memcpy(&meta_offset, image.data() + 32, sizeof(meta_offset));
+    uint32_t version = 0;
+    std::memcpy(&version, image.data() + meta_offset + 4, sizeof(version));
+    check_true(version == stockbt::kEngineVersion, "result cache should record the engine version");
+    ++version;
+    std::memcpy(&image[meta_offset + 4], &version, sizeof(version));
+    const auto stale = write_tmp_file("result_cache_stale.smc", image);
+    check_true(loaded.load(stale.string(), &error) && loaded.size() == 0 && loaded.discarded() == cache.size(),
+               "a cache from another engine version should load empty");
+    check_true(loaded.load(src_path("tests/tmp/missing_cache.smc").string(), &error) && loaded.size() == 0,
+               "a missing cache file should load empty");
+    const auto garbage = write_tmp_file("result_cache_garbage.smc", "not a cache");
+    check_true(!loaded.load(garbage.string(), &error) && !error.empty(), "a corrupt cache file should fail to load");
+
+    const stockbt::SeriesColumns all_columns = stockbt::to_columns(make_synthetic_series(900));
+    const stockbt::ColumnsView data(all_columns);
+    stockbt::WalkForwardOptions wf;
+    wf.train_bars = 300;
+    wf.test_bars = 150;
+    const stockbt::WalkForwardResult plain = stockbt::run_walk_forward(data, grid, settings, wf);
+    stockbt::MetricsCache wf_cache;
+    wf.cache = &wf_cache;
+    const stockbt::WalkForwardResult cold = stockbt::run_walk_forward(data, grid, settings, wf);
+    const std::size_t misses = wf_cache.misses();
+    const stockbt::WalkForwardResult warm = stockbt::run_walk_forward(data, grid, settings, wf);
+    check_true(same_metrics(plain.oos, cold.oos) && same_metrics(plain.oos, warm.oos) &&
+                   plain.oos_equity == warm.oos_equity,
+               "walk-forward with the result cache should match an uncached run");
+    check_true(misses > 0 && wf_cache.hits() == misses && wf_cache.misses() == misses,
+               "a repeated walk-forward should take every train run from the cache");
+}
+
+void test_streaming_import_and_backtest() {
+    // The duplicate of row 3 straddles the first chunk boundary.
+    const stockbt::Series series = make_synthetic_series(400);
+    std::ostringstream csv;
+    csv << "Date,Open,High,Low,Close,Volume\n" << std::setprecision(17);
+    for (std::size_t i = 0; i < series.size(); ++i) {
+        const stockbt::Candle& c = series[i];
+        csv << csv_date_time(c.ts) << ',' << c.o << ',' << c.h << ',' << c.l << ',' << c.c
+            << ',' << c.v << '\n';
+        if (i == 3) {
+            csv << csv_date_time(c.ts) << ',' << c.o << ',' << c.h << ',' << c.l << ','
+                << c.c + 0.1 << ',' << c.v << '\n';
+        }
+        if (i == 100) {
+            csv << "bad-date,1,1,1,1,1\n";
+        }
+    }
+    const auto csv_path = write_tmp_file("stream.csv", csv.str());
+    const auto imported = stockbt::import_ohlcv_csv(csv_path.string(), stockbt::DateFormat::Iso);
+
+    stockbt::StreamImportOptions options;
+    options.chunk_rows = 4;
+    stockbt::Series streamed;
+    std::size_t largest_chunk = 0;
+    const auto stream = stockbt::stream_ohlcv(
+        csv_path.string(), stockbt::DateFormat::Iso, options, [&](stockbt::ColumnsView chunk, std::string*) {
+            const stockbt::Series rows = stockbt::to_series(chunk);
+            streamed.insert(streamed.end(), rows.begin(), rows.end());
+            largest_chunk = std::max(largest_chunk, chunk.size());
+            return true;
+        });
+    check_true(imported.success && stream.success && stream.partial_success, "stream fixture should import");
+    check_true(same_candles(streamed, imported.candles) && largest_chunk == 4,
+               "streamed chunks should concatenate to the imported candles");
+    check_true(stream.dataset.rows == imported.candles.size() && stream.dataset.start_ts == imported.candles.front().ts &&
+                   stream.dataset.end_ts == imported.candles.back().ts && stream.duplicates_removed == 1,
+               "stream should report the dataset range and duplicate count");
+    check_true(stream.dropped_rows == imported.dropped_rows && same_issues(stream.warnings, imported.warnings) &&
+                   stream.row_issues.sample_lines == imported.row_issues.sample_lines,
+               "stream should report the import warnings and row issues");
+
+    stockbt::SmaParams params;
+    params.fast_window = 5;
+    params.slow_window = 20;
+    stockbt::BacktestSettings settings;
+    settings.position_size_pct = 0.8;
+    settings.stop_loss_pct = 0.02;
+    settings.take_profit_pct = 0.03;
+    const stockbt::BacktestResult full = stockbt::run_sma_backtest(imported.candles, params, settings);
+    const auto full_equity = src_path("tests/tmp/stream_full_equity.csv");
+    const auto full_trades = src_path("tests/tmp/stream_full_trades.csv");
+    std::string error;
+    check_true(stockbt::export_equity_csv(full_equity.string(), imported.candles, full, &error) &&
+                   stockbt::export_trades_csv(full_trades.string(), full, &error),
+               "full backtest should export");
+
+    stockbt::StreamingBacktestOptions backtest_options;
+    backtest_options.input.chunk_rows = 64;
+    backtest_options.equity_csv = src_path("tests/tmp/stream_equity.csv").string();
+    backtest_options.trades_csv = src_path("tests/tmp/stream_trades.csv").string();
+    const auto run = stockbt::run_streaming_sma_backtest(
+        csv_path.string(), stockbt::DateFormat::Iso, params, settings, backtest_options);
+    check_true(run.success && full.metrics.trades > 0 && same_metrics(run.metrics, full.metrics),
+               "streaming backtest metrics should match a full backtest: " + run.error);
+    check_true(read_all(backtest_options.equity_csv) == read_all(full_equity) &&
+                   read_all(backtest_options.trades_csv) == read_all(full_trades),
+               "streaming exports should match the full exports byte for byte");
+
+    stockbt::ImportOptions cached;
+    cached.binary_cache = true;
+    stockbt::import_ohlcv_csv(csv_path.string(), stockbt::DateFormat::Iso, cached);
+    const auto from_cache = stockbt::run_streaming_sma_backtest(
+        stockbt::dataset_cache_path(csv_path.string()), stockbt::DateFormat::Iso, params, settings, backtest_options);
+    check_true(from_cache.success && same_metrics(from_cache.metrics, full.metrics) &&
+                   same_issues(from_cache.input.warnings, imported.warnings) &&
+                   read_all(backtest_options.equity_csv) == read_all(full_equity),
+               "streaming an .sbt dataset should match the CSV run");
+
+    const auto unsorted = write_tmp_file("stream_unsorted.csv",
+                                         "Date,Open,High,Low,Close,Volume\n"
+                                         "2024-01-02,10,11,9,10.5,100\n"
+                                         "2024-01-01,9,10,8,9.25,50\n");
+    const auto rejected = stockbt::stream_ohlcv(unsorted.string(), stockbt::DateFormat::Iso, options,
+                                                [](stockbt::ColumnsView, std::string*) { return true; });
+    check_true(!rejected.success && !rejected.errors.empty() && rejected.errors.front().line == 3,
+               "streaming should reject a row older than its predecessor");
+
+    const auto stopped = stockbt::stream_ohlcv(csv_path.string(), stockbt::DateFormat::Iso, options,
+                                               [](stockbt::ColumnsView, std::string* chunk_error) {
+                                                   *chunk_error = "consumer full";
+                                                   return false;
+                                               });
+    check_true(!stopped.success && !stopped.errors.empty() && stopped.errors.front().message == "consumer full",
+               "a failing chunk consumer should stop the stream with its error");
+}
+
 int main() {
     test_timestamp_format();
+    test_iso_t_separator_keeps_time();
+    test_fast_timestamp_layouts();
     test_import_filtering_sort_and_duplicates();
     test_usdcad_split_datetime_headers();
     test_force_close_end_long();
@@ -317,6 +2109,35 @@ int main() {
     test_stop_loss_exit();
     test_take_profit_exit();
     test_regression_goldens();
+    test_work_stealing_pool_covers_range();
+    test_parallel_sweep_matches_serial();
+    test_sweep_pruning();
+    test_sweep_columns_input();
+    test_sweep_shards_merge_to_single_run();
+    test_sweep_result_cache();
+    test_batch_backtest_matches_single_runs();
+    test_walk_forward();
+    test_sma_cache_matches_rolling_backtest();
+    test_metrics_only_matches_full_backtest();
+    test_candle_view_slices_match_copies();
+    test_import_stage_functions();
+    test_sort_dedupe_paths_match_stable_sort();
+    test_column_import_sorts_columns();
+    test_mapped_import_matches_stream_import();
+    test_parallel_import_matches_serial();
+    test_binary_dataset_cache_round_trip();
+    test_binary_result_exports();
+    test_column_storage_matches_rows();
+    test_indicator_kernels_match_scalar();
+    test_min_max_pyramid_matches_scan();
+    test_strategy_engine();
+    test_multi_symbol_backtest();
+    test_incremental_backtest();
+    test_streaming_import_and_backtest();
+    test_progress_and_cancellation();
+    test_import_and_backtest_stats();
+    test_compact_row_issues();
+    test_backtest_workspace_reuse();
 
     if (g_failures == 0) {
         std::cout << "All tests passed\n";
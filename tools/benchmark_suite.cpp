@@ -0,0 +1,403 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "backtest/backtester.hpp"
+#include "backtest/csv_importer.hpp"
+#include "backtest/downsampling.hpp"
+#include "backtest/exporter.hpp"
+#include "backtest/indicators.hpp"
+#include "backtest/time_utils.hpp"
+#include "cli_options.hpp"
+
+namespace {
+
+// Per-stage timings over synthetic datasets, printed as JSON on stdout so runs can be
+// compared across releases. Progress goes to stderr.
+//
+//   benchmark_suite [--rows 1000,100000,...] [--shapes iso,split,...] [--repeats N]
+//                   [--warmup N] [--threads N]
+
+const char* const kShapes[] = {"iso", "split", "unsorted", "duplicates"};
+
+struct SuiteOptions {
+    std::vector<std::size_t> rows{1000, 100000, 1000000};
+    std::vector<std::string> shapes{std::begin(kShapes), std::end(kShapes)};
+    std::size_t repeats{7};
+    std::size_t warmup{1};
+    std::size_t threads{1};
+};
+
+// iso:        Date column "YYYY-MM-DD HH:MM:SS", one bar per minute, ascending.
+// split:      <DTYYYYMMDD>,<TIME> columns, otherwise as iso.
+// unsorted:   iso rows newest first, so the importer has to sort everything.
+// duplicates: iso rows with every timestamp repeated three times in a row.
+struct Dataset {
+    std::string shape;
+    bool split{false};
+    std::string text;
+    stockbt::Series rows; // file order, as the importer's parse stage produces them
+};
+
+Dataset make_dataset(const std::string& shape, std::size_t rows) {
+    Dataset dataset;
+    dataset.shape = shape;
+    dataset.split = shape == "split";
+    dataset.text = dataset.split ? "<DTYYYYMMDD>,<TIME>,<OPEN>,<HIGH>,<LOW>,<CLOSE>,<VOL>\n"
+                                 : "Date,Open,High,Low,Close,Volume\n";
+    dataset.text.reserve(rows * 64);
+    dataset.rows.reserve(rows);
+
+    const int64_t start = stockbt::epoch_from_civil_utc(2000, 1, 1, 0, 0, 0);
+    double price = 100.0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        // Deterministic pseudo-market path with bounded drift, as in the golden data.
+        const double drift = ((static_cast<int>(i % 29) - 14) * 0.02);
+        const double open = price;
+        const double close = std::max(1.0, open + drift);
+        const double high = std::max(open, close) + 0.3;
+        const double low = std::min(open, close) - 0.3;
+        price = close;
+
+        std::size_t bar = i;
+        if (shape == "unsorted") {
+            bar = rows - 1 - i;
+        } else if (shape == "duplicates") {
+            bar = i / 3;
+        }
+        const int64_t ts = start + static_cast<int64_t>(bar) * 60;
+        const std::string iso = stockbt::format_timestamp_utc_iso8601(ts); // YYYY-MM-DDTHH:MM:SSZ
+
+        char line[160];
+        int length = 0;
+        if (dataset.split) {
+            length = std::snprintf(line, sizeof(line), "%.4s%.2s%.2s,%.2s%.2s%.2s,%.6f,%.6f,%.6f,%.6f,1000\n",
+                                   iso.c_str(), iso.c_str() + 5, iso.c_str() + 8, iso.c_str() + 11,
+                                   iso.c_str() + 14, iso.c_str() + 17, open, high, low, close);
+        } else {
+            length = std::snprintf(line, sizeof(line), "%.10s %.8s,%.6f,%.6f,%.6f,%.6f,1000\n", iso.c_str(),
+                                   iso.c_str() + 11, open, high, low, close);
+        }
+        dataset.text.append(line, static_cast<std::size_t>(length));
+        dataset.rows.push_back({ts, open, high, low, close, 1000.0});
+    }
+    return dataset;
+}
+
+// Data lines of text (header skipped), split like MappedLineReader.
+std::vector<std::string_view> data_lines(const std::string& text) {
+    std::vector<std::string_view> lines;
+    const char* pos = text.data();
+    const char* end = text.data() + text.size();
+    bool header = true;
+    while (pos < end) {
+        const void* newline = std::memchr(pos, '\n', static_cast<std::size_t>(end - pos));
+        const char* line_end = (newline != nullptr) ? static_cast<const char*>(newline) : end;
+        if (!header) {
+            lines.emplace_back(pos, static_cast<std::size_t>(line_end - pos));
+        }
+        header = false;
+        pos = (line_end == end) ? end : line_end + 1;
+    }
+    return lines;
+}
+
+struct StageStats {
+    double median_ms{0.0};
+    double p95_ms{0.0};
+    double min_ms{0.0};
+    double max_ms{0.0};
+    double checksum{0.0}; // returned by the last run, so results cannot be optimized away
+};
+
+// setup runs before every sample and is not timed.
+StageStats measure(const SuiteOptions& options,
+                   const std::function<void()>& setup,
+                   const std::function<double()>& run) {
+    StageStats stats;
+    std::vector<double> samples;
+    for (std::size_t i = 0; i < options.warmup + options.repeats; ++i) {
+        setup();
+        const auto begin = std::chrono::steady_clock::now();
+        stats.checksum = run();
+        const auto end = std::chrono::steady_clock::now();
+        if (i >= options.warmup) {
+            samples.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    if (samples.empty()) {
+        return stats;
+    }
+    // Nearest-rank percentiles.
+    auto percentile = [&](double p) {
+        const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(samples.size())));
+        return samples[std::min(samples.size(), std::max<std::size_t>(rank, 1)) - 1];
+    };
+    stats.median_ms = percentile(0.5);
+    stats.p95_ms = percentile(0.95);
+    stats.min_ms = samples.front();
+    stats.max_ms = samples.back();
+    return stats;
+}
+
+class JsonReport {
+public:
+    explicit JsonReport(const SuiteOptions& options) {
+        std::printf("{\n  \"suite\": \"stockbt\",\n  \"repeats\": %zu,\n  \"warmup\": %zu,\n  \"threads\": %zu,\n"
+                    "  \"results\": [",
+                    options.repeats, options.warmup, options.threads);
+    }
+
+    // kernel names the indicator kernel level a stage ran on.
+    void add(const Dataset& dataset, const char* stage, const StageStats& stats, const char* kernel = nullptr) {
+        const std::size_t rows = dataset.rows.size();
+        const double seconds = stats.median_ms / 1000.0;
+        const double rows_per_sec = (seconds > 0.0) ? static_cast<double>(rows) / seconds : 0.0;
+        std::printf("%s\n    {\"shape\": \"%s\", \"rows\": %zu, \"stage\": \"%s\", \"median_ms\": %.4f, "
+                    "\"p95_ms\": %.4f, \"min_ms\": %.4f, \"max_ms\": %.4f, \"rows_per_sec\": %.0f, "
+                    "\"checksum\": %.17g%s%s%s}",
+                    first_ ? "" : ",", dataset.shape.c_str(), rows, stage, stats.median_ms, stats.p95_ms,
+                    stats.min_ms, stats.max_ms, rows_per_sec, stats.checksum, kernel ? ", \"kernel\": \"" : "",
+                    kernel ? kernel : "", kernel ? "\"" : "");
+        std::fflush(stdout);
+        first_ = false;
+    }
+
+    void finish() { std::printf("\n  ]\n}\n"); }
+
+private:
+    bool first_{true};
+};
+
+void run_dataset(const SuiteOptions& options, const Dataset& dataset, JsonReport* report) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string tag = dataset.shape + "_" + std::to_string(dataset.rows.size());
+    const std::filesystem::path csv_path = dir / ("stockbt_bench_" + tag + ".csv");
+    const std::filesystem::path equity_path = dir / ("stockbt_bench_" + tag + "_equity.csv");
+    {
+        std::ofstream out(csv_path, std::ios::binary);
+        out.write(dataset.text.data(), static_cast<std::streamsize>(dataset.text.size()));
+    }
+    auto no_setup = []() {};
+
+    stockbt::ImportOptions import_options;
+    import_options.threads = options.threads;
+    report->add(dataset, "import", measure(options, no_setup, [&]() {
+        const auto result = stockbt::import_ohlcv_csv(csv_path.string(), stockbt::DateFormat::Iso, import_options);
+        return static_cast<double>(result.candles.size());
+    }));
+
+    const std::vector<std::string_view> lines = data_lines(dataset.text);
+    const std::size_t first_number = dataset.split ? 2 : 1;
+    report->add(dataset, "tokenize", measure(options, no_setup, [&]() {
+        std::vector<std::string_view> fields;
+        std::vector<std::string> storage;
+        double sum = 0.0;
+        for (std::string_view line : lines) {
+            stockbt::split_csv_fields(line, &fields, &storage);
+            for (std::size_t f = first_number; f < first_number + 5 && f < fields.size(); ++f) {
+                double value = 0.0;
+                stockbt::parse_csv_number(fields[f], &value);
+                sum += value;
+            }
+        }
+        return sum;
+    }));
+
+    std::vector<std::string_view> dates;
+    std::vector<std::string_view> times;
+    {
+        std::vector<std::string_view> fields;
+        std::vector<std::string> storage;
+        for (std::string_view line : lines) {
+            stockbt::split_csv_fields(line, &fields, &storage);
+            dates.push_back(fields[0]);
+            if (dataset.split) {
+                times.push_back(fields[1]);
+            }
+        }
+    }
+    report->add(dataset, "timestamp_parse", measure(options, no_setup, [&]() {
+        stockbt::TimestampParser parser(stockbt::DateFormat::Iso);
+        int64_t sum = 0;
+        for (std::size_t i = 0; i < dates.size(); ++i) {
+            const std::optional<int64_t> ts =
+                dataset.split ? parser.parse_date_time(dates[i], times[i]) : parser.parse(dates[i]);
+            sum += ts.value_or(0) % 1000;
+        }
+        return static_cast<double>(sum);
+    }));
+
+    stockbt::Series sorted;
+    report->add(dataset, "sort_dedupe", measure(options, [&]() { sorted = dataset.rows; }, [&]() {
+        bool unsorted = false;
+        return static_cast<double>(stockbt::sort_and_dedupe_candles(&sorted, &unsorted));
+    }));
+
+    // Indicator kernels on the closes: one window, then eight windows in one batch call.
+    using BatchIndicator = void (*)(const double*, std::size_t, const std::size_t*, std::size_t, double* const*,
+                                    stockbt::SimdLevel);
+    struct IndicatorStage {
+        const char* single;
+        const char* batch;
+        BatchIndicator run;
+    };
+    const IndicatorStage indicators[] = {{"sma", "sma_batch", stockbt::rolling_sma_batch},
+                                         {"ema", "ema_batch", stockbt::ema_batch},
+                                         {"stddev", "stddev_batch", stockbt::rolling_stddev_batch}};
+    const std::vector<std::size_t> windows{10, 20, 30, 50, 80, 100, 150, 200};
+    std::vector<double> closes;
+    closes.reserve(sorted.size());
+    for (const stockbt::Candle& candle : sorted) {
+        closes.push_back(candle.c);
+    }
+    std::vector<std::vector<double>> outputs(windows.size(), std::vector<double>(closes.size()));
+    std::vector<double*> outs;
+    for (std::vector<double>& output : outputs) {
+        outs.push_back(output.data());
+    }
+    auto last_value = [&]() { return closes.empty() ? 0.0 : outputs[0].back(); };
+    for (const IndicatorStage& indicator : indicators) {
+        for (const std::size_t count : {std::size_t{1}, windows.size()}) {
+            report->add(dataset,
+                        (count == 1) ? indicator.single : indicator.batch,
+                        measure(options, no_setup, [&]() {
+                            indicator.run(closes.data(), closes.size(), windows.data(), count, outs.data(),
+                                          stockbt::detected_simd_level());
+                            return last_value();
+                        }),
+                        stockbt::simd_level_name(stockbt::indicator_kernel_level(count)));
+        }
+    }
+
+    stockbt::SmaParams params;
+    params.fast_window = 20;
+    params.slow_window = 50;
+    stockbt::BacktestSettings settings;
+    settings.commission_pct = 0.001;
+    stockbt::BacktestResult backtest;
+    report->add(dataset, "backtest", measure(options, no_setup, [&]() {
+        backtest = stockbt::run_sma_backtest(sorted, params, settings);
+        return backtest.metrics.total_return_pct;
+    }));
+
+    stockbt::BacktestWorkspace workspace;
+    report->add(dataset, "backtest_workspace", measure(options, no_setup, [&]() {
+        return stockbt::run_sma_backtest(sorted, params, settings, stockbt::BacktestContext{}, &workspace)
+            .metrics.total_return_pct;
+    }));
+
+    report->add(dataset, "backtest_metrics", measure(options, no_setup, [&]() {
+        return stockbt::run_sma_backtest_metrics(sorted, params, settings).total_return_pct;
+    }));
+
+    report->add(dataset, "export_equity", measure(options, no_setup, [&]() {
+        std::string error;
+        if (!stockbt::export_equity_csv(equity_path.string(), sorted, backtest, &error)) {
+            std::cerr << error << '\n';
+        }
+        std::error_code ec;
+        return static_cast<double>(std::filesystem::file_size(equity_path, ec));
+    }));
+
+    std::vector<stockbt::SeriesPoint> points;
+    points.reserve(sorted.size());
+    for (const stockbt::Candle& candle : sorted) {
+        points.push_back({candle.ts, candle.c});
+    }
+    constexpr std::size_t kPixels = 1600;
+    report->add(dataset, "downsample", measure(options, no_setup, [&]() {
+        return static_cast<double>(stockbt::downsample_bucket_min_max(points, kPixels).size());
+    }));
+
+    const stockbt::MinMaxPyramid pyramid(points);
+    report->add(dataset, "pyramid_query", measure(options, no_setup, [&]() {
+        const auto buckets = points.empty() ? std::vector<stockbt::BucketMinMax>()
+                                            : pyramid.query(points.front().ts, points.back().ts, kPixels);
+        return static_cast<double>(buckets.size());
+    }));
+
+    std::error_code ec;
+    std::filesystem::remove(csv_path, ec);
+    std::filesystem::remove(equity_path, ec);
+}
+
+bool parse_count_list(const std::string& value, std::vector<std::size_t>* counts) {
+    counts->clear();
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+        std::size_t end = value.find(',', begin);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        std::size_t count = 0;
+        if (!stockbt::cli::parse_count(value.substr(begin, end - begin), &count)) {
+            return false;
+        }
+        counts->push_back(count);
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool parse_shape_list(const std::string& value, std::vector<std::string>* shapes) {
+    shapes->clear();
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+        std::size_t end = value.find(',', begin);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        const std::string shape = value.substr(begin, end - begin);
+        if (std::find(std::begin(kShapes), std::end(kShapes), shape) == std::end(kShapes)) {
+            return false;
+        }
+        shapes->push_back(shape);
+        begin = end + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SuiteOptions options;
+    std::optional<std::string> rows;
+    std::optional<std::string> shapes;
+    std::optional<std::string> repeats;
+    std::optional<std::string> warmup;
+    const bool parsed = stockbt::cli::extract_threads_option(&argc, argv, &options.threads) &&
+                        stockbt::cli::extract_value_option(&argc, argv, "--rows", &rows) &&
+                        stockbt::cli::extract_value_option(&argc, argv, "--shapes", &shapes) &&
+                        stockbt::cli::extract_value_option(&argc, argv, "--repeats", &repeats) &&
+                        stockbt::cli::extract_value_option(&argc, argv, "--warmup", &warmup);
+    if (!parsed || argc != 1 || (rows && !parse_count_list(*rows, &options.rows)) ||
+        (shapes && !parse_shape_list(*shapes, &options.shapes)) ||
+        (repeats && !stockbt::cli::parse_count(*repeats, &options.repeats)) ||
+        (warmup && !stockbt::cli::parse_count(*warmup, &options.warmup)) || options.repeats == 0) {
+        std::cerr << "Usage: benchmark_suite [--rows 1000,100000,1000000] [--shapes iso,split,unsorted,duplicates]\n"
+                  << "                       [--repeats 7] [--warmup 1] [--threads 1]\n";
+        return 1;
+    }
+
+    JsonReport report(options);
+    for (std::size_t rows_count : options.rows) {
+        for (const std::string& shape : options.shapes) {
+            std::cerr << "Running " << shape << " x " << rows_count << " rows...\n";
+            run_dataset(options, make_dataset(shape, rows_count), &report);
+        }
+    }
+    report.finish();
+    return 0;
+}
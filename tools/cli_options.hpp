@@ -0,0 +1,110 @@
+#pragma once
+
+// Argument helpers shared by the command-line tools.
+
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "backtest/types.hpp"
+
+namespace stockbt {
+namespace cli {
+
+inline DateFormat parse_date_format(const std::string& value) {
+    if (value == "mdy") {
+        return DateFormat::Mdy;
+    }
+    if (value == "dmy") {
+        return DateFormat::Dmy;
+    }
+    return DateFormat::Iso;
+}
+
+// "0.01,0.02,0.03" -> {0.01, 0.02, 0.03}; a single value yields one entry.
+inline std::vector<double> parse_number_list(const std::string& value) {
+    std::vector<double> values;
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+        std::size_t end = value.find(',', begin);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        values.push_back(std::atof(value.substr(begin, end - begin).c_str()));
+        begin = end + 1;
+    }
+    return values;
+}
+
+// Removes "--name VALUE" / "--name=VALUE" from argv so the remaining arguments stay
+// positional. The last occurrence wins; fails when a value is missing.
+inline bool extract_value_option(int* argc, char** argv, const std::string& name, std::optional<std::string>* value) {
+    const std::string prefix = name + "=";
+    int out = 1;
+    for (int i = 1; i < *argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == name) {
+            if (i + 1 >= *argc) {
+                return false;
+            }
+            *value = argv[++i];
+        } else if (arg.rfind(prefix, 0) == 0) {
+            *value = arg.substr(prefix.size());
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    *argc = out;
+    return true;
+}
+
+// Non-negative decimal integer; rejects empty values and trailing characters.
+inline bool parse_count(const std::string& value, std::size_t* count) {
+    char* end_ptr = nullptr;
+    const unsigned long long parsed = std::strtoull(value.c_str(), &end_ptr, 10);
+    if (value.empty() || *end_ptr != '\0') {
+        return false;
+    }
+    *count = static_cast<std::size_t>(parsed);
+    return true;
+}
+
+// Decimal number; rejects empty values and trailing characters.
+inline bool parse_number(const std::string& value, double* number) {
+    char* end_ptr = nullptr;
+    const double parsed = std::strtod(value.c_str(), &end_ptr);
+    if (value.empty() || *end_ptr != '\0') {
+        return false;
+    }
+    *number = parsed;
+    return true;
+}
+
+// Removes "--threads N" / "--threads=N" from argv so the remaining arguments stay positional.
+inline bool extract_threads_option(int* argc, char** argv, std::size_t* threads) {
+    std::optional<std::string> value;
+    if (!extract_value_option(argc, argv, "--threads", &value)) {
+        return false;
+    }
+    return !value.has_value() || parse_count(*value, threads);
+}
+
+// Removes every occurrence of a boolean flag from argv; returns whether it was present.
+inline bool extract_flag(int* argc, char** argv, const std::string& flag) {
+    bool found = false;
+    int out = 1;
+    for (int i = 1; i < *argc; ++i) {
+        if (flag == argv[i]) {
+            found = true;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    *argc = out;
+    return found;
+}
+
+} // namespace cli
+} // namespace stockbt
@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backtest/exporter.hpp"
+#include "backtest/sweep.hpp"
+#include "cli_options.hpp"
+#include "sweep_report.hpp"
+
+namespace {
+
+void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <out_report> <shard_report>... [--binary-report [--compress]]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool binary_report = stockbt::cli::extract_flag(&argc, argv, "--binary-report");
+    stockbt::BinaryExportOptions export_options;
+    export_options.compress = stockbt::cli::extract_flag(&argc, argv, "--compress");
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string out_report = argv[1];
+    std::vector<std::vector<stockbt::SweepRow>> shards;
+    std::vector<bool> seen;
+    stockbt::SweepReportInfo merged_info;
+    for (int arg = 2; arg < argc; ++arg) {
+        const std::string path = argv[arg];
+        std::vector<stockbt::SweepRow> rows;
+        stockbt::SweepReportInfo info;
+        std::string error;
+        if (!stockbt::load_sweep_binary(path, &rows, &info, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        if (shards.empty()) {
+            merged_info = info;
+            seen.assign(info.shard.count, false);
+        } else if (info.shard.count != merged_info.shard.count || info.total_cells != merged_info.total_cells ||
+                   info.risk_axes != merged_info.risk_axes || info.pruning != merged_info.pruning) {
+            std::cerr << "Shard report of a different sweep: " << path << "\n";
+            return 1;
+        }
+        if (seen[info.shard.index]) {
+            std::cerr << "Shard " << info.shard.index << "/" << info.shard.count << " given twice: " << path << "\n";
+            return 1;
+        }
+        seen[info.shard.index] = true;
+        shards.push_back(std::move(rows));
+    }
+    if (shards.size() != merged_info.shard.count) {
+        std::cerr << "Expected " << merged_info.shard.count << " shard reports, got " << shards.size() << "\n";
+        return 1;
+    }
+
+    std::vector<stockbt::SweepRow> rows;
+    std::string error;
+    if (!stockbt::merge_sweep_shards(shards, merged_info.total_cells, &rows, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    stockbt::sort_sweep_rows(&rows);
+
+    merged_info.shard = stockbt::SweepShard{};
+    if (!stockbt::cli::write_sweep_report(out_report, rows, merged_info, binary_report, export_options)) {
+        return 1;
+    }
+    std::cout << "Merged " << shards.size() << " shards, " << rows.size() << " cells\n";
+    std::cout << "Report written: " << out_report << "\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "backtest/multi_symbol.hpp"
+#include "cli_options.hpp"
+
+namespace {
+
+void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " <dir_or_manifest> <out_csv> [date_format=iso] [fast=20] [slow=50]"
+              << " [position_size_pct=1.0] [stop_loss_pct=0.0] [take_profit_pct=0.0]"
+              << " [--threads N] [--binary-cache]\n";
+}
+
+std::string csv_field(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string quoted = "\"";
+    for (char ch : text) {
+        if (ch == '"') {
+            quoted += '"';
+        }
+        quoted += ch;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t threads = 0;
+    if (!stockbt::cli::extract_threads_option(&argc, argv, &threads)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const bool binary_cache = stockbt::cli::extract_flag(&argc, argv, "--binary-cache");
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string input_path = argv[1];
+    const std::string out_csv = argv[2];
+    const std::string date_format_arg = (argc > 3) ? argv[3] : "iso";
+
+    stockbt::SmaParams params;
+    params.fast_window = (argc > 4) ? static_cast<std::size_t>(std::strtoull(argv[4], nullptr, 10)) : 20;
+    params.slow_window = (argc > 5) ? static_cast<std::size_t>(std::strtoull(argv[5], nullptr, 10)) : 50;
+    if (!params.is_valid()) {
+        std::cerr << "Invalid SMA parameters (require 0 < fast < slow)\n";
+        return 1;
+    }
+
+    stockbt::BacktestSettings settings;
+    settings.starting_cash = 10000.0;
+    settings.commission_pct = 0.001;
+    settings.position_size_pct = (argc > 6) ? std::atof(argv[6]) : 1.0;
+    settings.stop_loss_pct = (argc > 7) ? std::atof(argv[7]) : 0.0;
+    settings.take_profit_pct = (argc > 8) ? std::atof(argv[8]) : 0.0;
+
+    std::vector<stockbt::SymbolSource> sources;
+    std::string error;
+    if (!stockbt::list_symbol_sources(input_path, &sources, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    if (sources.empty()) {
+        std::cerr << "No CSV or .sbt files found in: " << input_path << "\n";
+        return 1;
+    }
+
+    std::ofstream out(out_csv);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open output report path: " << out_csv << "\n";
+        return 1;
+    }
+
+    stockbt::MultiSymbolOptions options;
+    options.threads = threads;
+    options.date_format = stockbt::cli::parse_date_format(date_format_arg);
+    options.binary_cache = binary_cache;
+
+    stockbt::MultiSymbolSummary summary;
+    const std::vector<stockbt::SymbolResult> results =
+        stockbt::run_multi_symbol_backtest(sources, params, settings, options, &summary);
+
+    out << "symbol,status,rows,return_pct,max_drawdown_pct,trades,win_rate_pct,import_ms,backtest_ms,rows_per_sec,"
+        << "error\n";
+    out << std::fixed << std::setprecision(6);
+    for (const stockbt::SymbolResult& result : results) {
+        out << csv_field(result.symbol) << ',' << (result.success ? "ok" : "failed") << ',' << result.rows << ','
+            << result.metrics.total_return_pct << ',' << result.metrics.max_drawdown_pct << ','
+            << result.metrics.trades << ',' << result.metrics.win_rate_pct << ',' << result.import_ms << ','
+            << result.backtest_ms << ',' << result.rows_per_second() << ',' << csv_field(result.error) << '\n';
+    }
+
+    const double seconds = summary.wall_ms / 1000.0;
+    std::cout << "Symbols: " << summary.symbols << " (" << summary.failed << " failed)\n";
+    std::cout << "Rows: " << summary.total_rows << " in " << summary.wall_ms << " ms ("
+              << ((seconds > 0.0) ? static_cast<double>(summary.total_rows) / seconds : 0.0) << " rows/s, "
+              << ((seconds > 0.0) ? static_cast<double>(summary.symbols) / seconds : 0.0) << " symbols/s)\n";
+    std::cout << "Peak resident: " << summary.peak_datasets << " datasets, " << summary.peak_rows << " rows\n";
+    std::cout << "Report written: " << out_csv << "\n";
+
+    return summary.failed == summary.symbols ? 1 : 0;
+}
@@ -1,44 +1,96 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
-#include <fstream>
-#include <iomanip>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <vector>
 
-#include "backtest/backtester.hpp"
 #include "backtest/csv_importer.hpp"
+#include "backtest/exporter.hpp"
+#include "backtest/stats.hpp"
+#include "backtest/sweep.hpp"
+#include "backtest/result_cache.hpp"
+#include "cli_options.hpp"
+#include "result_cache_option.hpp"
+#include "sweep_report.hpp"
 
 namespace {
 
-struct SweepRow {
-    std::size_t fast{0};
-    std::size_t slow{0};
-    stockbt::Metrics train;
-    stockbt::Metrics test;
-};
-
-stockbt::DateFormat parse_date_format(const std::string& value) {
-    if (value == "mdy") {
-        return stockbt::DateFormat::Mdy;
-    }
-    if (value == "dmy") {
-        return stockbt::DateFormat::Dmy;
-    }
-    return stockbt::DateFormat::Iso;
-}
-
 void print_usage(const char* argv0) {
     std::cerr << "Usage: " << argv0
               << " <csv_path> <out_csv> [date_format=iso] [train_ratio=0.7]"
               << " [fast_min=5] [fast_max=80] [slow_min=20] [slow_max=300] [step=5]"
-              << " [position_size_pct=1.0] [stop_loss_pct=0.0] [take_profit_pct=0.0]\n";
+              << " [position_size_pct=1.0] [stop_loss_pct=0.0[,...]] [take_profit_pct=0.0[,...]]"
+              << " [--threads N] [--binary-cache] [--binary-report [--compress]]"
+              << " [--prune-drawdown PCT] [--prune-equity VALUE] [--keep-top K [--halving-rungs R]]"
+              << " [--shard i/N] [--result-cache PATH]\n";
+}
+
+// Fills the pruning rules from their options; fails on a malformed value.
+bool extract_pruning_options(int* argc, char** argv, stockbt::SweepPruning* pruning) {
+    std::optional<std::string> drawdown;
+    std::optional<std::string> equity;
+    std::optional<std::string> keep_top;
+    std::optional<std::string> rungs;
+    if (!stockbt::cli::extract_value_option(argc, argv, "--prune-drawdown", &drawdown) ||
+        !stockbt::cli::extract_value_option(argc, argv, "--prune-equity", &equity) ||
+        !stockbt::cli::extract_value_option(argc, argv, "--keep-top", &keep_top) ||
+        !stockbt::cli::extract_value_option(argc, argv, "--halving-rungs", &rungs)) {
+        return false;
+    }
+    return (!drawdown.has_value() || stockbt::cli::parse_number(*drawdown, &pruning->max_drawdown_pct)) &&
+           (!equity.has_value() || stockbt::cli::parse_number(*equity, &pruning->min_equity)) &&
+           (!keep_top.has_value() || stockbt::cli::parse_count(*keep_top, &pruning->keep_top)) &&
+           (!rungs.has_value() || stockbt::cli::parse_count(*rungs, &pruning->rungs));
+}
+
+// "i/N" with i < N.
+bool parse_shard(const std::string& value, stockbt::SweepShard* shard) {
+    const std::size_t slash = value.find('/');
+    return slash != std::string::npos && stockbt::cli::parse_count(value.substr(0, slash), &shard->index) &&
+           stockbt::cli::parse_count(value.substr(slash + 1), &shard->count) && shard->index < shard->count;
 }
 
 } // namespace
 
 int main(int argc, char** argv) {
+    std::size_t threads = 0;
+    if (!stockbt::cli::extract_threads_option(&argc, argv, &threads)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    stockbt::SweepOptions options;
+    options.threads = threads;
+    if (!extract_pruning_options(&argc, argv, &options.pruning)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::optional<std::string> shard;
+    if (!stockbt::cli::extract_value_option(&argc, argv, "--shard", &shard) ||
+        (shard.has_value() && !parse_shard(*shard, &options.shard))) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::string options_error;
+    if (!stockbt::check_sweep_options(options, &options_error)) {
+        std::cerr << options_error << " (--keep-top with --shard)\n";
+        return 1;
+    }
+    std::optional<std::string> result_cache;
+    if (!stockbt::cli::extract_value_option(&argc, argv, "--result-cache", &result_cache)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (result_cache.has_value() && options.pruning.enabled()) {
+        std::cerr << "--result-cache stores complete cell metrics and cannot be combined with pruning\n";
+        return 1;
+    }
+    const bool binary_cache = stockbt::cli::extract_flag(&argc, argv, "--binary-cache");
+    // Shards always write the binary report that merge_sweep_shards reads.
+    const bool binary_report = stockbt::cli::extract_flag(&argc, argv, "--binary-report") || shard.has_value();
+    stockbt::BinaryExportOptions export_options;
+    export_options.compress = stockbt::cli::extract_flag(&argc, argv, "--compress");
     if (argc < 3) {
         print_usage(argv[0]);
         return 1;
@@ -54,8 +106,8 @@ int main(int argc, char** argv) {
     const std::size_t slow_max = (argc > 8) ? static_cast<std::size_t>(std::strtoull(argv[8], nullptr, 10)) : 300;
     const std::size_t step = (argc > 9) ? static_cast<std::size_t>(std::strtoull(argv[9], nullptr, 10)) : 5;
     const double position_size_pct = (argc > 10) ? std::atof(argv[10]) : 1.0;
-    const double stop_loss_pct = (argc > 11) ? std::atof(argv[11]) : 0.0;
-    const double take_profit_pct = (argc > 12) ? std::atof(argv[12]) : 0.0;
+    const std::vector<double> stop_loss_pcts = stockbt::cli::parse_number_list((argc > 11) ? argv[11] : "0.0");
+    const std::vector<double> take_profit_pcts = stockbt::cli::parse_number_list((argc > 12) ? argv[12] : "0.0");
 
     if (train_ratio <= 0.0 || train_ratio >= 1.0) {
         std::cerr << "train_ratio must be in (0,1)\n";
@@ -66,7 +118,12 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    const stockbt::ImportResult imported = stockbt::import_ohlcv_csv(csv_path, parse_date_format(date_format_arg));
+    stockbt::ImportOptions import_options;
+    import_options.threads = threads;
+    import_options.binary_cache = binary_cache;
+    import_options.layout = stockbt::SeriesLayout::Columns;
+    const stockbt::ImportResult imported =
+        stockbt::import_ohlcv_csv(csv_path, stockbt::cli::parse_date_format(date_format_arg), import_options);
     if (!imported.success) {
         std::cerr << "Import failed for: " << csv_path << "\n";
         for (const auto& e : imported.errors) {
@@ -75,72 +132,90 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    const std::size_t n = imported.candles.size();
+    const std::size_t n = imported.columns.size();
     const std::size_t split_idx = static_cast<std::size_t>(static_cast<double>(n) * train_ratio);
     if (split_idx < 2 || split_idx >= n - 1) {
         std::cerr << "Dataset too short for requested split ratio\n";
         return 1;
     }
 
-    const stockbt::Series train(imported.candles.begin(), imported.candles.begin() + static_cast<long>(split_idx));
-    const stockbt::Series test(imported.candles.begin() + static_cast<long>(split_idx), imported.candles.end());
+    const stockbt::ColumnsView all(imported.columns);
+    const stockbt::ColumnsView train = all.subview(0, split_idx);
+    const stockbt::ColumnsView test = all.subview(split_idx);
 
     stockbt::BacktestSettings settings;
     settings.starting_cash = 10000.0;
     settings.commission_pct = 0.001;
     settings.position_size_pct = position_size_pct;
-    settings.stop_loss_pct = stop_loss_pct;
-    settings.take_profit_pct = take_profit_pct;
-
-    std::vector<SweepRow> rows;
-    for (std::size_t fast = fast_min; fast <= fast_max; fast += step) {
-        for (std::size_t slow = slow_min; slow <= slow_max; slow += step) {
-            stockbt::SmaParams params;
-            params.fast_window = fast;
-            params.slow_window = slow;
-            if (!params.is_valid()) {
-                continue;
-            }
-            if (train.size() < params.slow_window || test.size() < params.slow_window) {
-                continue;
-            }
-
-            const stockbt::BacktestResult train_result = stockbt::run_sma_backtest(train, params, settings);
-            const stockbt::BacktestResult test_result = stockbt::run_sma_backtest(test, params, settings);
-            rows.push_back({fast, slow, train_result.metrics, test_result.metrics});
-        }
+    settings.stop_loss_pct = stop_loss_pcts.front();
+    settings.take_profit_pct = take_profit_pcts.front();
+
+    stockbt::SweepGrid grid;
+    grid.fast_min = fast_min;
+    grid.fast_max = fast_max;
+    grid.slow_min = slow_min;
+    grid.slow_max = slow_max;
+    grid.step = step;
+    // Single values stay in settings so the report keeps its original layout.
+    const bool risk_axes = stop_loss_pcts.size() > 1 || take_profit_pcts.size() > 1;
+    if (risk_axes) {
+        grid.stop_loss_pcts = stop_loss_pcts;
+        grid.take_profit_pcts = take_profit_pcts;
     }
 
-    if (rows.empty()) {
+    stockbt::SweepReportInfo info;
+    info.shard = options.shard;
+    info.total_cells = stockbt::enumerate_sweep_configs(grid, settings, train.size(), test.size()).size();
+    info.risk_axes = risk_axes;
+    info.pruning = options.pruning.enabled();
+    if (info.total_cells == 0) {
         std::cerr << "No valid parameter combinations produced results\n";
         return 1;
     }
 
-    std::sort(rows.begin(), rows.end(), [](const SweepRow& a, const SweepRow& b) {
-        if (a.train.total_return_pct != b.train.total_return_pct) {
-            return a.train.total_return_pct > b.train.total_return_pct;
+    stockbt::MetricsCache cache;
+    if (result_cache.has_value()) {
+        if (!stockbt::cli::load_result_cache(*result_cache, &cache)) {
+            return 1;
         }
-        return a.train.max_drawdown_pct > b.train.max_drawdown_pct;
-    });
-
-    std::ofstream out(out_csv);
-    if (!out.is_open()) {
-        std::cerr << "Failed to open output report path: " << out_csv << "\n";
+        options.cache = &cache;
+    }
+    std::vector<stockbt::SweepRow> rows = stockbt::run_parameter_sweep(train, test, grid, settings, options);
+    stockbt::sort_sweep_rows(&rows);
+    if (!stockbt::cli::write_sweep_report(out_csv, rows, info, binary_report, export_options)) {
         return 1;
     }
-
-    out << "fast,slow,train_return_pct,train_max_drawdown_pct,train_trades,test_return_pct,test_max_drawdown_pct,test_trades\n";
-    out << std::fixed << std::setprecision(6);
-    for (const SweepRow& row : rows) {
-        out << row.fast << ',' << row.slow << ',' << row.train.total_return_pct << ',' << row.train.max_drawdown_pct << ','
-            << row.train.trades << ',' << row.test.total_return_pct << ',' << row.test.max_drawdown_pct << ','
-            << row.test.trades << '\n';
+    if (result_cache.has_value() && !stockbt::cli::save_result_cache(*result_cache, cache)) {
+        return 1;
     }
 
-    const SweepRow& best = rows.front();
     std::cout << "Rows imported: " << n << "\n";
+    if (options.shard.count > 1) {
+        std::cout << "Shard " << options.shard.index << "/" << options.shard.count << ": " << rows.size() << " of "
+                  << info.total_cells << " cells\n";
+    }
+    if (options.pruning.enabled()) {
+        const std::size_t pruned = static_cast<std::size_t>(
+            std::count_if(rows.begin(), rows.end(), [](const stockbt::SweepRow& row) {
+                return row.pruned != stockbt::SweepPruneReason::None;
+            }));
+        std::cout << "Pruned cells: " << pruned << " of " << rows.size() << "\n";
+    }
+    const std::string import_stats = stockbt::format_import_stats(imported.stats);
+    if (!import_stats.empty()) {
+        std::cout << import_stats << "\n";
+    }
     std::cout << "Train rows: " << train.size() << ", Test rows: " << test.size() << "\n";
-    std::cout << "Best (by train return): fast=" << best.fast << " slow=" << best.slow << "\n";
+    if (rows.empty()) {
+        std::cout << "Report written: " << out_csv << "\n";
+        return 0;
+    }
+    const stockbt::SweepRow& best = rows.front();
+    std::cout << "Best (by train return): fast=" << best.fast << " slow=" << best.slow;
+    if (risk_axes) {
+        std::cout << " stop_loss=" << best.stop_loss_pct << " take_profit=" << best.take_profit_pct;
+    }
+    std::cout << "\n";
     std::cout << "Train return=" << best.train.total_return_pct << "% maxDD=" << best.train.max_drawdown_pct
               << "% trades=" << best.train.trades << "\n";
     std::cout << "Test return=" << best.test.total_return_pct << "% maxDD=" << best.test.max_drawdown_pct
@@ -0,0 +1,39 @@
+#pragma once
+
+// --result-cache handling shared by parameter_sweep and walk_forward.
+
+#include <iostream>
+#include <string>
+
+#include "backtest/result_cache.hpp"
+
+namespace stockbt {
+namespace cli {
+
+// A missing file starts an empty cache.
+inline bool load_result_cache(const std::string& path, MetricsCache* cache) {
+    std::string error;
+    if (!cache->load(path, &error)) {
+        std::cerr << "Failed to load result cache: " << error << "\n";
+        return false;
+    }
+    if (cache->discarded() > 0) {
+        std::cout << "Result cache from another engine version discarded (" << cache->discarded()
+                  << " entries)\n";
+    }
+    return true;
+}
+
+inline bool save_result_cache(const std::string& path, const MetricsCache& cache) {
+    std::string error;
+    if (!cache.save(path, &error)) {
+        std::cerr << "Failed to save result cache: " << error << "\n";
+        return false;
+    }
+    std::cout << "Result cache: " << cache.hits() << " hits, " << cache.misses() << " misses, " << cache.size()
+              << " entries in " << path << "\n";
+    return true;
+}
+
+} // namespace cli
+} // namespace stockbt
@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "backtest/exporter.hpp"
+#include "backtest/streaming.hpp"
+#include "cli_options.hpp"
+
+namespace {
+
+void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " <csv_or_sbt_path> <out_dir> [date_format=iso] [fast=20] [slow=50]"
+              << " [position_size_pct=1.0] [stop_loss_pct=0.0] [take_profit_pct=0.0] [--chunk-rows N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    stockbt::StreamingBacktestOptions options;
+    std::optional<std::string> chunk_rows;
+    if (!stockbt::cli::extract_value_option(&argc, argv, "--chunk-rows", &chunk_rows) ||
+        (chunk_rows.has_value() &&
+         (!stockbt::cli::parse_count(*chunk_rows, &options.input.chunk_rows) || options.input.chunk_rows == 0))) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    const std::filesystem::path out_dir = argv[2];
+    const std::string date_format_arg = (argc > 3) ? argv[3] : "iso";
+    stockbt::SmaParams params;
+    params.fast_window = (argc > 4) ? static_cast<std::size_t>(std::strtoull(argv[4], nullptr, 10)) : 20;
+    params.slow_window = (argc > 5) ? static_cast<std::size_t>(std::strtoull(argv[5], nullptr, 10)) : 50;
+    stockbt::BacktestSettings settings;
+    settings.starting_cash = 10000.0;
+    settings.commission_pct = 0.001;
+    settings.position_size_pct = (argc > 6) ? std::atof(argv[6]) : 1.0;
+    settings.stop_loss_pct = (argc > 7) ? std::atof(argv[7]) : 0.0;
+    settings.take_profit_pct = (argc > 8) ? std::atof(argv[8]) : 0.0;
+
+    std::error_code ec;
+    std::filesystem::create_directories(out_dir, ec);
+    options.equity_csv = (out_dir / "equity.csv").string();
+    options.trades_csv = (out_dir / "trades.csv").string();
+
+    const stockbt::StreamingBacktestResult result = stockbt::run_streaming_sma_backtest(
+        path, stockbt::cli::parse_date_format(date_format_arg), params, settings, options);
+    for (const auto& w : result.input.warnings) {
+        std::cerr << "line " << w.line << ": " << w.message << "\n";
+    }
+    if (!result.success) {
+        std::cerr << "Streaming backtest failed for: " << path << "\n";
+        for (const auto& e : result.input.errors) {
+            std::cerr << "line " << e.line << ": " << e.message << "\n";
+        }
+        if (result.input.errors.empty()) {
+            std::cerr << result.error << "\n";
+        }
+        return 1;
+    }
+
+    std::string error;
+    if (!stockbt::export_metrics_json(
+            (out_dir / "metrics.json").string(), result.input.dataset, params, settings, result.metrics, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    std::cout << "Rows streamed: " << result.input.dataset.rows << " (dropped " << result.input.dropped_rows
+              << ")\n";
+    std::cout << "Return=" << result.metrics.total_return_pct << "% maxDD=" << result.metrics.max_drawdown_pct
+              << "% trades=" << result.metrics.trades << "\n";
+    std::cout << "Results written: " << out_dir.string() << "\n";
+    return 0;
+}
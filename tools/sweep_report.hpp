@@ -0,0 +1,62 @@
+#pragma once
+
+// Sweep report output shared by parameter_sweep and merge_sweep_shards.
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "backtest/exporter.hpp"
+#include "backtest/sweep.hpp"
+
+namespace stockbt {
+namespace cli {
+
+inline bool write_sweep_csv(const std::string& out_csv, const std::vector<SweepRow>& rows, const SweepReportInfo& info) {
+    std::ofstream out(out_csv);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open output report path: " << out_csv << "\n";
+        return false;
+    }
+
+    out << (info.risk_axes ? "fast,slow,stop_loss_pct,take_profit_pct," : "fast,slow,")
+        << "train_return_pct,train_max_drawdown_pct,train_trades,test_return_pct,test_max_drawdown_pct,test_trades"
+        << (info.pruning ? ",pruned,pruned_at_bar\n" : "\n");
+    out << std::fixed << std::setprecision(6);
+    for (const SweepRow& row : rows) {
+        out << row.fast << ',' << row.slow << ',';
+        if (info.risk_axes) {
+            out << row.stop_loss_pct << ',' << row.take_profit_pct << ',';
+        }
+        out << row.train.total_return_pct << ',' << row.train.max_drawdown_pct << ','
+            << row.train.trades << ',' << row.test.total_return_pct << ',' << row.test.max_drawdown_pct << ','
+            << row.test.trades;
+        if (info.pruning) {
+            out << ',' << sweep_prune_reason_name(row.pruned) << ',' << row.pruned_at_bar;
+        }
+        out << '\n';
+    }
+    return true;
+}
+
+// CSV by default, the binary sweep report with binary.
+inline bool write_sweep_report(const std::string& path,
+                               const std::vector<SweepRow>& rows,
+                               const SweepReportInfo& info,
+                               bool binary,
+                               const BinaryExportOptions& options) {
+    if (!binary) {
+        return write_sweep_csv(path, rows, info);
+    }
+    std::string error;
+    if (!export_sweep_binary(path, rows, info, options, &error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace cli
+} // namespace stockbt
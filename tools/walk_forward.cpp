@@ -0,0 +1,173 @@
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "backtest/csv_importer.hpp"
+#include "backtest/result_cache.hpp"
+#include "backtest/stats.hpp"
+#include "backtest/time_utils.hpp"
+#include "backtest/walk_forward.hpp"
+#include "cli_options.hpp"
+#include "result_cache_option.hpp"
+
+namespace {
+
+void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " <csv_path> <out_csv> [date_format=iso] [mode=rolling|anchored]"
+              << " [train_bars=5000] [test_bars=1000] [step_bars=test_bars]"
+              << " [fast_min=5] [fast_max=80] [slow_min=20] [slow_max=300] [step=5]"
+              << " [position_size_pct=1.0] [stop_loss_pct=0.0[,...]] [take_profit_pct=0.0[,...]]"
+              << " [--threads N] [--binary-cache] [--result-cache PATH]\n";
+}
+
+std::size_t size_arg(int argc, char** argv, int index, std::size_t fallback) {
+    return (argc > index) ? static_cast<std::size_t>(std::strtoull(argv[index], nullptr, 10)) : fallback;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t threads = 0;
+    if (!stockbt::cli::extract_threads_option(&argc, argv, &threads)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::optional<std::string> result_cache;
+    if (!stockbt::cli::extract_value_option(&argc, argv, "--result-cache", &result_cache)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const bool binary_cache = stockbt::cli::extract_flag(&argc, argv, "--binary-cache");
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string csv_path = argv[1];
+    const std::string out_csv = argv[2];
+    const std::string date_format_arg = (argc > 3) ? argv[3] : "iso";
+    const std::string mode_arg = (argc > 4) ? argv[4] : "rolling";
+    const std::size_t train_bars = size_arg(argc, argv, 5, 5000);
+    const std::size_t test_bars = size_arg(argc, argv, 6, 1000);
+    const std::size_t step_bars = size_arg(argc, argv, 7, 0);
+    const std::size_t fast_min = size_arg(argc, argv, 8, 5);
+    const std::size_t fast_max = size_arg(argc, argv, 9, 80);
+    const std::size_t slow_min = size_arg(argc, argv, 10, 20);
+    const std::size_t slow_max = size_arg(argc, argv, 11, 300);
+    const std::size_t step = size_arg(argc, argv, 12, 5);
+    const double position_size_pct = (argc > 13) ? std::atof(argv[13]) : 1.0;
+    const std::vector<double> stop_loss_pcts = stockbt::cli::parse_number_list((argc > 14) ? argv[14] : "0.0");
+    const std::vector<double> take_profit_pcts = stockbt::cli::parse_number_list((argc > 15) ? argv[15] : "0.0");
+
+    if (mode_arg != "rolling" && mode_arg != "anchored") {
+        std::cerr << "mode must be rolling or anchored\n";
+        return 1;
+    }
+    if (train_bars == 0 || test_bars == 0) {
+        std::cerr << "train_bars and test_bars must be > 0\n";
+        return 1;
+    }
+    if (step == 0) {
+        std::cerr << "step must be > 0\n";
+        return 1;
+    }
+
+    stockbt::ImportOptions import_options;
+    import_options.threads = threads;
+    import_options.binary_cache = binary_cache;
+    import_options.layout = stockbt::SeriesLayout::Columns;
+    const stockbt::ImportResult imported =
+        stockbt::import_ohlcv_csv(csv_path, stockbt::cli::parse_date_format(date_format_arg), import_options);
+    if (!imported.success) {
+        std::cerr << "Import failed for: " << csv_path << "\n";
+        for (const auto& e : imported.errors) {
+            std::cerr << "line " << e.line << ": " << e.message << "\n";
+        }
+        return 1;
+    }
+
+    stockbt::BacktestSettings settings;
+    settings.starting_cash = 10000.0;
+    settings.commission_pct = 0.001;
+    settings.position_size_pct = position_size_pct;
+    settings.stop_loss_pct = stop_loss_pcts.front();
+    settings.take_profit_pct = take_profit_pcts.front();
+
+    stockbt::SweepGrid grid;
+    grid.fast_min = fast_min;
+    grid.fast_max = fast_max;
+    grid.slow_min = slow_min;
+    grid.slow_max = slow_max;
+    grid.step = step;
+    grid.stop_loss_pcts = stop_loss_pcts;
+    grid.take_profit_pcts = take_profit_pcts;
+
+    stockbt::WalkForwardOptions options;
+    options.mode = (mode_arg == "anchored") ? stockbt::WalkForwardMode::Anchored : stockbt::WalkForwardMode::Rolling;
+    options.train_bars = train_bars;
+    options.test_bars = test_bars;
+    options.step_bars = step_bars;
+    options.threads = threads;
+    stockbt::MetricsCache cache;
+    if (result_cache.has_value()) {
+        if (!stockbt::cli::load_result_cache(*result_cache, &cache)) {
+            return 1;
+        }
+        options.cache = &cache;
+    }
+
+    const stockbt::ColumnsView data(imported.columns);
+    const stockbt::WalkForwardResult result = stockbt::run_walk_forward(data, grid, settings, options);
+    if (result.folds.empty()) {
+        std::cerr << "Dataset too short for one train + test window\n";
+        return 1;
+    }
+    if (result_cache.has_value() && !stockbt::cli::save_result_cache(*result_cache, cache)) {
+        return 1;
+    }
+
+    std::ofstream out(out_csv);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open output report path: " << out_csv << "\n";
+        return 1;
+    }
+
+    out << "fold,train_start,train_end,test_start,test_end,fast,slow,stop_loss_pct,take_profit_pct,"
+        << "train_return_pct,train_max_drawdown_pct,train_trades,test_return_pct,test_max_drawdown_pct,test_trades\n";
+    out << std::fixed << std::setprecision(6);
+    for (std::size_t index = 0; index < result.folds.size(); ++index) {
+        const stockbt::WalkForwardFoldResult& fold = result.folds[index];
+        out << index << ',' << stockbt::format_timestamp_utc_iso8601(data.ts()[fold.fold.train_begin]) << ','
+            << stockbt::format_timestamp_utc_iso8601(data.ts()[fold.fold.train_end - 1]) << ','
+            << stockbt::format_timestamp_utc_iso8601(data.ts()[fold.fold.test_begin]) << ','
+            << stockbt::format_timestamp_utc_iso8601(data.ts()[fold.fold.test_end - 1]) << ',';
+        if (fold.has_best) {
+            out << fold.best.params.fast_window << ',' << fold.best.params.slow_window << ','
+                << fold.best.stop_loss_pct << ',' << fold.best.take_profit_pct << ',';
+        } else {
+            out << ",,,,";
+        }
+        out << fold.train.total_return_pct << ',' << fold.train.max_drawdown_pct << ',' << fold.train.trades << ','
+            << fold.test.total_return_pct << ',' << fold.test.max_drawdown_pct << ',' << fold.test.trades << '\n';
+    }
+
+    std::cout << "Rows imported: " << data.size() << "\n";
+    const std::string import_stats = stockbt::format_import_stats(imported.stats);
+    if (!import_stats.empty()) {
+        std::cout << import_stats << "\n";
+    }
+    std::cout << "Folds: " << result.folds.size() << " (" << mode_arg << ", train=" << train_bars
+              << ", test=" << test_bars << ")\n";
+    std::cout << "Stitched out-of-sample return=" << result.oos.total_return_pct
+              << "% maxDD=" << result.oos.max_drawdown_pct << "% trades=" << result.oos.trades
+              << " winRate=" << result.oos.win_rate_pct << "%\n";
+    std::cout << "Report written: " << out_csv << "\n";
+
+    return 0;
+}